@@ -0,0 +1,255 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELSPARSEDATAVIEW_H
+#define EUTELSPARSEDATAVIEW_H
+
+// personal includes ".h"
+#include "EUTELESCOPE.h"
+#include "EUTelExceptions.h"
+#include "EUTelGenericSparsePixel.h"
+#include "EUTelGeometricPixel.h"
+#include "EUTelMuPixel.h"
+#include "EUTelSimpleSparsePixel.h"
+
+// lcio includes <.h>
+#include <IMPL/TrackerDataImpl.h>
+
+// system includes <>
+#include <cstddef>
+#include <iterator>
+
+namespace eutelescope {
+
+  //! Layout of the charge values of a sparse pixel type
+  /*! Number of values stored per pixel and whether the fourth value is a
+   *  time. Has to be specialised for every pixel type, consistently with
+   *  EUTelTrackerDataInterfacerImpl::fillPixelVec().
+   */
+  template <class PixelType> struct EUTelSparsePixelLayout;
+
+  template <> struct EUTelSparsePixelLayout<EUTelSimpleSparsePixel> {
+    static constexpr size_t noOfElements = 3;
+    static constexpr bool hasTime = false;
+  };
+
+  template <> struct EUTelSparsePixelLayout<EUTelGenericSparsePixel> {
+    static constexpr size_t noOfElements = 4;
+    static constexpr bool hasTime = true;
+  };
+
+  template <> struct EUTelSparsePixelLayout<EUTelGeometricPixel> {
+    static constexpr size_t noOfElements = 8;
+    static constexpr bool hasTime = true;
+  };
+
+  template <> struct EUTelSparsePixelLayout<EUTelMuPixel> {
+    static constexpr size_t noOfElements = 7;
+    static constexpr bool hasTime = true;
+  };
+
+  //! Read-only access to a single pixel record in a charge value buffer
+  /*! The values are converted on access exactly like the pixel classes
+   *  do when they are created by EUTelTrackerDataInterfacerImpl.
+   */
+  template <class PixelType> class EUTelSparsePixelRecord {
+  public:
+    typedef EUTelSparsePixelLayout<PixelType> Layout;
+
+    explicit EUTelSparsePixelRecord(float const *record) : _record(record) {}
+
+    //! Get the x pixel coordinates
+    short getXCoord() const { return static_cast<short>(_record[0]); }
+
+    //! Get the y pixel coordinates
+    short getYCoord() const { return static_cast<short>(_record[1]); }
+
+    //! Get the pixel signal
+    float getSignal() const { return _record[2]; }
+
+    //! Get the pixel time, zero for pixel types without time
+    short getTime() const {
+      return Layout::hasTime ? static_cast<short>(_record[3]) : 0;
+    }
+
+    //! Get the raw values of this pixel (Layout::noOfElements of them)
+    float const *data() const { return _record; }
+
+  private:
+    //! Pointer to the first value of this pixel
+    float const *_record;
+  };
+
+  //! Zero-copy, read-only view of the pixels in a TrackerDataImpl
+  /*! Utility::getSparseData() copies the charge values into a vector of
+   *  pixel objects, which is a waste for passes only reading the pixels
+   *  once. This view interprets the float buffer of the TrackerDataImpl
+   *  in place instead: it neither copies nor allocates, iterating yields
+   *  EUTelSparsePixelRecord objects pointing into the buffer.
+   *
+   *  The view is only valid as long as the charge values of the
+   *  TrackerDataImpl are neither modified nor deleted.
+   *
+   *  If the pixel type is only known at runtime, use visitSparseData().
+   *
+   *  \b Usage:
+   *  \code{.cpp}
+   *  EUTelSparseDataView<EUTelGenericSparsePixel> pixels(zsData);
+   *  for(auto const & pixel: pixels) {
+   *    hitMap->fill(pixel.getXCoord(), pixel.getYCoord());
+   *  }
+   *  \endcode
+   */
+  template <class PixelType> class EUTelSparseDataView {
+  public:
+    typedef EUTelSparsePixelLayout<PixelType> Layout;
+    typedef EUTelSparsePixelRecord<PixelType> Record;
+
+    //! Random access iterator over the pixel records
+    /*! The records are created on access, thus dereferencing returns
+     *  them by value and operator->() a proxy holding the record.
+     */
+    class const_iterator {
+    public:
+      //! Holds the record returned by operator->()
+      class pointer {
+      public:
+        explicit pointer(Record record) : _record(record) {}
+        Record const *operator->() const { return &_record; }
+
+      private:
+        Record _record;
+      };
+
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef Record value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef Record reference;
+
+      explicit const_iterator(float const *record) : _record(record) {}
+
+      reference operator*() const { return Record(_record); }
+      pointer operator->() const { return pointer(**this); }
+      reference operator[](difference_type n) const { return *(*this + n); }
+
+      const_iterator &operator++() {
+        _record += Layout::noOfElements;
+        return *this;
+      }
+      const_iterator operator++(int) {
+        auto old = *this;
+        ++(*this);
+        return old;
+      }
+      const_iterator &operator--() {
+        _record -= Layout::noOfElements;
+        return *this;
+      }
+      const_iterator operator--(int) {
+        auto old = *this;
+        --(*this);
+        return old;
+      }
+      const_iterator &operator+=(difference_type n) {
+        _record += n * static_cast<difference_type>(Layout::noOfElements);
+        return *this;
+      }
+      const_iterator &operator-=(difference_type n) { return *this += -n; }
+      const_iterator operator+(difference_type n) const {
+        auto it = *this;
+        return it += n;
+      }
+      const_iterator operator-(difference_type n) const {
+        auto it = *this;
+        return it -= n;
+      }
+      difference_type operator-(const_iterator const &other) const {
+        return (_record - other._record) /
+               static_cast<difference_type>(Layout::noOfElements);
+      }
+
+      bool operator==(const_iterator const &other) const {
+        return _record == other._record;
+      }
+      bool operator!=(const_iterator const &other) const {
+        return !(*this == other);
+      }
+      bool operator<(const_iterator const &other) const {
+        return _record < other._record;
+      }
+      bool operator>(const_iterator const &other) const { return other < *this; }
+      bool operator<=(const_iterator const &other) const { return !(other < *this); }
+      bool operator>=(const_iterator const &other) const { return !(*this < other); }
+
+    private:
+      //! First value of the pixel the iterator points to
+      float const *_record;
+    };
+
+    //! Constructor, data must not be a nullptr
+    explicit EUTelSparseDataView(IMPL::TrackerDataImpl const *data)
+        : _begin(data->getChargeValues().data()),
+          _size(data->getChargeValues().size() / Layout::noOfElements) {}
+
+    //! Get the number of pixels
+    size_t size() const { return _size; }
+
+    //! Check if there are no pixels
+    bool empty() const { return _size == 0; }
+
+    const_iterator begin() const { return const_iterator(_begin); }
+
+    const_iterator end() const {
+      return const_iterator(_begin + _size * Layout::noOfElements);
+    }
+
+    //! Access the i-th pixel (not range checked)
+    Record operator[](size_t i) const {
+      return Record(_begin + i * Layout::noOfElements);
+    }
+
+  private:
+    //! First value of the charge value buffer
+    float const *_begin;
+
+    //! Number of complete pixel records in the buffer
+    size_t _size;
+  };
+
+  //! Call function with the EUTelSparseDataView matching a runtime pixel type
+  /*! The function has to accept all views, usually it is a generic lambda:
+   *  \code{.cpp}
+   *  visitSparseData(zsData, type, [&](auto const & pixels) {
+   *    for(auto const & pixel: pixels) ...
+   *  });
+   *  \endcode
+   *
+   *  @throw UnknownDataTypeException for unsupported pixel types
+   */
+  template <class Function>
+  void visitSparseData(IMPL::TrackerDataImpl const *data, SparsePixelType type,
+                       Function &&function) {
+    switch(type) {
+    case kEUTelSimpleSparsePixel:
+      function(EUTelSparseDataView<EUTelSimpleSparsePixel>(data));
+      break;
+    case kEUTelGenericSparsePixel:
+      function(EUTelSparseDataView<EUTelGenericSparsePixel>(data));
+      break;
+    case kEUTelGeometricPixel:
+      function(EUTelSparseDataView<EUTelGeometricPixel>(data));
+      break;
+    case kEUTelMuPixel:
+      function(EUTelSparseDataView<EUTelMuPixel>(data));
+      break;
+    default:
+      throw UnknownDataTypeException("Unknown sparsified pixel");
+    }
+  }
+}
+#endif
@@ -0,0 +1,123 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELTRACKERDATACOLUMNS_H
+#define EUTELTRACKERDATACOLUMNS_H
+
+// personal includes ".h"
+#include "EUTELESCOPE.h"
+
+// lcio includes <.h>
+#include <IMPL/TrackerDataImpl.h>
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Columnar (structure-of-arrays) view of sparsified pixel data
+  /*! EUTelTrackerDataInterfacerImpl creates one polymorphic pixel object
+   *  per hit pixel. For passes which only need the pixel indices, the
+   *  signal or the time this is a lot of overhead. This class decodes
+   *  the charge values of a TrackerDataImpl straight into separate x, y,
+   *  signal and time arrays, which can be handed to clustering, noisy
+   *  pixel finding or histogramming as plain contiguous ranges.
+   *
+   *  All sparse pixel types are supported, the values are converted in
+   *  the same way as done by the corresponding pixel class. Pixel types
+   *  without a time (EUTelSimpleSparsePixel) get a time of zero. Any
+   *  further information (e.g. the positions of EUTelGeometricPixel) is
+   *  not decoded, but appendPixel() can copy the full record of a pixel
+   *  into another TrackerDataImpl, e.g. a cluster.
+   *
+   *  The arrays are kept between calls to decode(), so one instance can
+   *  be reused for all sensors and events without reallocation.
+   *
+   *  \b Usage:
+   *  \code{.cpp}
+   *  EUTelTrackerDataColumns columns;
+   *  columns.decode(zsData, type);
+   *  auto const & x = columns.getXCoords();
+   *  auto const & y = columns.getYCoords();
+   *  for(size_t i = 0; i < columns.size(); ++i) hitMap->fill(x[i], y[i]);
+   *  \endcode
+   */
+  class EUTelTrackerDataColumns {
+
+  public:
+    //! Default constructor, no pixels
+    EUTelTrackerDataColumns();
+
+    //! Constructor decoding the given data
+    EUTelTrackerDataColumns(IMPL::TrackerDataImpl const *data,
+                            SparsePixelType type);
+
+    //! Decode the charge values of data, replacing the current content
+    /*! The TrackerDataImpl is remembered for appendPixel(), it must not
+     *  be modified or deleted as long as appendPixel() is used.
+     *
+     *  @throw UnknownDataTypeException for unsupported pixel types
+     */
+    void decode(IMPL::TrackerDataImpl const *data, SparsePixelType type);
+
+    //! Number of charge values per pixel for a given pixel type
+    /*! @throw UnknownDataTypeException for unsupported pixel types */
+    static size_t getNoOfElements(SparsePixelType type);
+
+    //! Get the pixel type of the decoded data
+    SparsePixelType getType() const { return _type; }
+
+    //! Get the number of pixels
+    size_t size() const { return _xCoord.size(); }
+
+    //! Check if there are no pixels
+    bool empty() const { return _xCoord.empty(); }
+
+    //! The x indices of all pixels
+    std::vector<short> const &getXCoords() const { return _xCoord; }
+
+    //! The y indices of all pixels
+    std::vector<short> const &getYCoords() const { return _yCoord; }
+
+    //! The signals of all pixels
+    std::vector<float> const &getSignals() const { return _signal; }
+
+    //! The times of all pixels
+    std::vector<short> const &getTimes() const { return _time; }
+
+    //! Append the complete record of a pixel to the charge values of target
+    /*! The record is copied as stored in the decoded TrackerDataImpl,
+     *  target therefore holds pixels of the same type afterwards.
+     */
+    void appendPixel(size_t iPixel, IMPL::TrackerDataImpl &target) const;
+
+  protected:
+    //! The decoded TrackerDataImpl
+    IMPL::TrackerDataImpl const *_data;
+
+    //! The pixel type of the decoded data
+    SparsePixelType _type;
+
+    //! Number of charge values per pixel
+    size_t _noOfElements;
+
+    //! Pixel x indices
+    std::vector<short> _xCoord;
+
+    //! Pixel y indices
+    std::vector<short> _yCoord;
+
+    //! Pixel signals
+    std::vector<float> _signal;
+
+    //! Pixel times
+    std::vector<short> _time;
+  };
+}
+#endif
@@ -0,0 +1,69 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// personal includes ".h"
+#include "EUTelTrackerDataColumns.h"
+#include "EUTelExceptions.h"
+#include "EUTelSparseDataView.h"
+
+using namespace eutelescope;
+
+EUTelTrackerDataColumns::EUTelTrackerDataColumns()
+    : _data(nullptr), _type(kUnknownPixelType), _noOfElements(0), _xCoord(),
+      _yCoord(), _signal(), _time() {}
+
+EUTelTrackerDataColumns::EUTelTrackerDataColumns(
+    IMPL::TrackerDataImpl const *data, SparsePixelType type)
+    : EUTelTrackerDataColumns() {
+  decode(data, type);
+}
+
+size_t EUTelTrackerDataColumns::getNoOfElements(SparsePixelType type) {
+  switch(type) {
+  case kEUTelSimpleSparsePixel:
+    return 3;
+  case kEUTelGenericSparsePixel:
+    return 4;
+  case kEUTelGeometricPixel:
+    return 8;
+  case kEUTelMuPixel:
+    return 7;
+  default:
+    throw UnknownDataTypeException("Unknown sparsified pixel");
+  }
+}
+
+void EUTelTrackerDataColumns::decode(IMPL::TrackerDataImpl const *data,
+                                     SparsePixelType type) {
+  _noOfElements = getNoOfElements(type);
+  _data = data;
+  _type = type;
+
+  _xCoord.clear();
+  _yCoord.clear();
+  _signal.clear();
+  _time.clear();
+
+  //the view applies the same conversions as the pixel classes
+  visitSparseData(data, type, [this](auto const &pixels) {
+    for(auto const &pixel: pixels) {
+      _xCoord.push_back(pixel.getXCoord());
+      _yCoord.push_back(pixel.getYCoord());
+      _signal.push_back(pixel.getSignal());
+      _time.push_back(pixel.getTime());
+    }
+  });
+}
+
+void EUTelTrackerDataColumns::appendPixel(size_t iPixel,
+                                          IMPL::TrackerDataImpl &target) const {
+  auto const record = _data->getChargeValues().begin() + iPixel * _noOfElements;
+  target.chargeValues().insert(target.chargeValues().end(), record,
+                               record + _noOfElements);
+}
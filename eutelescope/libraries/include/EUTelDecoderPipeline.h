@@ -0,0 +1,134 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELDECODERPIPELINE_H
+#define EUTELDECODERPIPELINE_H
+
+// eutelescope includes ".h"
+#include "EUTELESCOPE.h"
+#include "EUTelMappedFile.h"
+
+// lcio includes <.h>
+#include <IMPL/LCEventImpl.h>
+
+// system includes <>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Decodes raw events ahead of the processing thread, in order
+  /*! Data source processors usually decode an event, push it through the
+   *  processor chain and only then decode the next one. With this
+   *  pipeline, decoder threads prepare the LCIO events while the
+   *  processing thread runs the chain on the previous ones.
+   *
+   *  The input is cut into events by the split function, which is called
+   *  by one decoder thread at a time in input order and should only
+   *  locate the event. The expensive part, decoding the event into an
+   *  LCEventImpl, runs concurrently in the decode function. Both must not
+   *  use streamlog or any other state shared with the processing thread.
+   *
+   *  next() hands out the decoded events in input order. At most capacity
+   *  events are decoded ahead, events not taken when the pipeline is
+   *  destroyed are deleted. Exceptions thrown by split or decode are
+   *  rethrown by next() at the position of the failing event.
+   *
+   *  \b Usage:
+   *  \code{.cpp}
+   *  auto cursor = file.getCursor();
+   *  EUTelDecoderPipeline pipeline(
+   *      2, 64, [&](EUTelMappedFile::Cursor &event) { ... },
+   *      [&](EUTelMappedFile::Cursor event, size_t eventIndex) { ... });
+   *  while(auto event = pipeline.next()) {
+   *    ProcessorMgr::instance()->processEvent(event.get());
+   *  }
+   *  \endcode
+   */
+  class EUTelDecoderPipeline {
+
+  public:
+    //! Cut the next event off the input, false at the end of the input
+    typedef std::function<bool(EUTelMappedFile::Cursor &event)> Split;
+
+    //! Decode an event, the index counts the events from zero
+    typedef std::function<IMPL::LCEventImpl *(EUTelMappedFile::Cursor event,
+                                              size_t eventIndex)> Decode;
+
+    //! Constructor, starts the decoder threads
+    /*! @param noOfThreads The number of decoder threads, at least one
+     *  @param capacity The maximum number of events decoded ahead
+     */
+    EUTelDecoderPipeline(size_t noOfThreads, size_t capacity, Split split,
+                         Decode decode);
+
+    //! Destructor, stops and joins the threads
+    ~EUTelDecoderPipeline();
+
+    //! Get the next decoded event, nullptr at the end of the input
+    /*! @throw Rethrows the exceptions of split and decode */
+    std::unique_ptr<IMPL::LCEventImpl> next();
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(EUTelDecoderPipeline)
+
+    //! A decoded event waiting to be taken
+    struct Slot {
+      Slot() : event(), exception(), ready(false) {}
+      std::unique_ptr<IMPL::LCEventImpl> event;
+      std::exception_ptr exception;
+      bool ready;
+    };
+
+    //! Main loop of the decoder threads
+    void workerLoop();
+
+    //! The function cutting the input into events
+    Split _split;
+
+    //! The function decoding an event
+    Decode _decode;
+
+    //! Ring buffer of decoded events, event i is in slot i % size
+    std::vector<Slot> _slots;
+
+    //! Mutex protecting everything but the decoding itself
+    std::mutex _mutex;
+
+    //! Signals the processing thread that an event is ready
+    std::condition_variable _readyCondition;
+
+    //! Signals the decoder threads that a slot became free
+    std::condition_variable _freeCondition;
+
+    //! Index of the next event to split off the input
+    size_t _nextInput;
+
+    //! Index of the next event to hand out
+    size_t _nextOutput;
+
+    //! Set once split returned false or threw
+    bool _inputDone;
+
+    //! Exception thrown by split
+    std::exception_ptr _splitException;
+
+    //! Stop flag set by the destructor
+    bool _stop;
+
+    //! The decoder threads
+    std::vector<std::thread> _threads;
+  };
+}
+#endif
@@ -0,0 +1,201 @@
+#ifndef EUTELGEOMETRYSNAPSHOT_H
+#define EUTELGEOMETRYSNAPSHOT_H
+
+// C++
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// EUTELESCOPE
+#include "EUTelMaterialBudget.h"
+#include "EUTelUtility.h"
+
+// Eigen
+#include <Eigen/Core>
+
+namespace eutelescope {
+  namespace geo {
+
+    /** All quantities of a plane needed on hot paths, held in one contiguous,
+     *  cache line aligned record per plane. Processors working per hit or per
+     *  cluster should fetch the record once via getPlaneRecord() instead of
+     *  calling the individual getters, each of which needs a lookup.
+     */
+    struct alignas(64) PlaneRecord {
+      int sensorID;
+      /** Position of the sensor center in the global frame, in [mm] */
+      Eigen::Vector3d position;
+      /** Rotation angles around the global X, Y and Z axis, in [rad] */
+      Eigen::Vector3d rotation;
+      /** Sensor size in X, Y and Z, in [mm] */
+      Eigen::Vector3d size;
+      /** Typical pixel pitch, in [mm] */
+      double xPitch, yPitch;
+      /** Pixel matrix dimensions */
+      int xNoPixels, yNoPixels;
+      /** Resolution, in [mm] */
+      double xResolution, yResolution;
+      /** Radiation length of the sensor material, in [mm] */
+      double radLength;
+      /** Flip matrix coefficients as returned by planeFlip1..4 */
+      std::array<int, 4> flip;
+      /** Flag if the TGeo derived members below are set, i.e. the TGeo geometry is initialised */
+      bool hasTransform;
+      /** Local to global transformation of the TGeo description, 3x4 row major with the
+       *  translation as last column. Not changed by alignGlobalPos() and alignGlobalRot().
+       */
+      std::array<double, 12> transform;
+      /** Plane normal, x- and y-direction in the global frame */
+      Eigen::Vector3d normal, xVector, yVector;
+    };
+
+    /** @class EUTelGeometrySnapshot
+     * Read-only copy of the telescope geometry at one point in time.
+     *
+     * The geometry description is a mutable singleton: alignment changes it
+     * in place. Whenever it changes, it publishes a new snapshot with an
+     * increased version number, snapshots themselves are never modified. A
+     * processor takes the current snapshot once per event and hands it to
+     * its worker threads, which then run coordinate transformations and
+     * material queries concurrently and without any locking. A snapshot
+     * stays alive as long as someone holds it, even if the geometry has
+     * moved on in the meantime.
+     *
+     * The plane positions and rotations follow alignGlobalPos() and
+     * alignGlobalRot(). The transformations and the material budget tables
+     * come from the TGeo description, which is built once and is not moved
+     * by the alignment, all snapshots share the same tables. Material
+     * queries are therefore made in the local frame of a plane.
+     *
+     * \b Usage:
+     * \code{.cpp}
+     *  auto geometry = geo::gGeometry().getSnapshot();
+     *  pool.run(hits.size(), [&](size_t iHit, size_t) {
+     *    geometry->master2Local(sensorID, hits[iHit].global, hits[iHit].local);
+     *  });
+     * \endcode
+     */
+    class EUTelGeometrySnapshot {
+    public:
+      typedef std::vector<PlaneRecord, Utility::AlignedAllocator<PlaneRecord>> PlaneRecordVec;
+
+      /** Constructor
+       *  @param version the version number of the snapshot
+       *  @param sensorIDs the sensor IDs ordered along the global z-axis
+       *  @param records one record per plane
+       *  @param materialBudget the material lookup tables, may be null
+       */
+      EUTelGeometrySnapshot(unsigned long version, std::vector<int> const &sensorIDs,
+                            PlaneRecordVec const &records,
+                            std::shared_ptr<EUTelMaterialBudget const> materialBudget);
+
+      /** Version number, increases with every change of the geometry */
+      unsigned long getVersion() const { return _version; }
+
+      /** Vector of all sensor IDs, ordered along the global z-axis */
+      std::vector<int> const & sensorIDsVec() const { return _sensorIDVec; }
+
+      /** Returns the record of the given plane, throws for unknown sensor IDs */
+      PlaneRecord const & getPlaneRecord(int sensorID) const {
+        auto index = static_cast<size_t>(sensorID);
+        if( sensorID < 0 || index >= _slots.size() || _slots[index] < 0 ) {
+          unknownSensor(sensorID);
+        }
+        return _records[static_cast<size_t>(_slots[index])];
+      }
+
+      /** Returns the flat 3x4 affine local to global transformation of a plane
+       *  Throws if the plane is not part of the TGeo geometry.
+       */
+      std::array<double, 12> const & getPlaneTransform(int sensorID) const {
+        return getTransformedPlaneRecord(sensorID).transform;
+      }
+
+      /** Get the plane's normal vector in global coordinates */
+      Eigen::Vector3d const & getPlaneNormalVector(int sensorID) const {
+        return getTransformedPlaneRecord(sensorID).normal;
+      }
+
+      /** Get the plane's x-direction vector in global coordinates */
+      Eigen::Vector3d const & getPlaneXVector(int sensorID) const {
+        return getTransformedPlaneRecord(sensorID).xVector;
+      }
+
+      /** Get the plane's y-direction vector in global coordinates */
+      Eigen::Vector3d const & getPlaneYVector(int sensorID) const {
+        return getTransformedPlaneRecord(sensorID).yVector;
+      }
+
+      void local2Master(int sensorID, std::array<double, 3> const &localPos,
+                        std::array<double, 3> &globalPos) const;
+      void master2Local(int sensorID, std::array<double, 3> const &globalPos,
+                        std::array<double, 3> &localPos) const;
+      void local2MasterVec(int sensorID, std::array<double, 3> const &localVec,
+                           std::array<double, 3> &globalVec) const;
+      void master2LocalVec(int sensorID, std::array<double, 3> const &globalVec,
+                           std::array<double, 3> &localVec) const;
+
+      void local2Master(int, const double[], double[]) const;
+      void master2Local(int, const double[], double[]) const;
+      void local2MasterVec(int, const double[], double[]) const;
+      void master2LocalVec(int, const double[], double[]) const;
+
+      /** Transform a batch of points of one sensor from the local into the global frame
+       *  The points are stored consecutively as (x,y,z) triples, i.e. localPos and
+       *  globalPos hold 3*noOfPoints values. Both may point to the same array.
+       */
+      void local2MasterBatch(int sensorID, size_t noOfPoints, const double localPos[], double globalPos[]) const;
+
+      /** Transform a batch of points of one sensor from the global into the local frame
+       *  Same memory layout as local2MasterBatch
+       */
+      void master2LocalBatch(int sensorID, size_t noOfPoints, const double globalPos[], double localPos[]) const;
+
+      /** Structure-of-arrays variant of local2MasterBatch
+       *  The output arrays must not overlap the input arrays.
+       */
+      void local2MasterBatch(int sensorID, size_t noOfPoints,
+                             const double localX[], const double localY[], const double localZ[],
+                             double globalX[], double globalY[], double globalZ[]) const;
+
+      /** Structure-of-arrays variant of master2LocalBatch
+       *  The output arrays must not overlap the input arrays.
+       */
+      void master2LocalBatch(int sensorID, size_t noOfPoints,
+                             const double globalX[], const double globalY[], const double globalZ[],
+                             double localX[], double localY[], double localZ[]) const;
+
+      /** Flag if the material budget lookup tables are available */
+      bool hasMaterialBudget() const { return _materialBudget != nullptr; }
+
+      /** Returns the material budget lookup tables, throws if not available
+       *  The tables ignore the alignment, see the class description.
+       */
+      EUTelMaterialBudget const & getMaterialBudget() const;
+
+    private:
+      /** Returns the record of the plane, throws if it has no TGeo transformation */
+      PlaneRecord const & getTransformedPlaneRecord(int sensorID) const;
+
+      /** Throws the exception for sensor IDs not part of the geometry */
+      [[noreturn]] static void unknownSensor(int sensorID);
+
+      /** Version number of the snapshot */
+      unsigned long _version;
+
+      /** Vector of Sensor IDs, ordered along the global z-axis */
+      std::vector<int> _sensorIDVec;
+
+      /** One record per plane, indexed by the plane's slot as given by _slots */
+      PlaneRecordVec _records;
+
+      /** Slot in _records for each sensor ID (used as index), -1 for unknown sensors */
+      std::vector<int> _slots;
+
+      /** Material budget lookup tables, shared between snapshots */
+      std::shared_ptr<EUTelMaterialBudget const> _materialBudget;
+    };
+  } // namespace geo
+} // namespace eutelescope
+#endif /* EUTELGEOMETRYSNAPSHOT_H */
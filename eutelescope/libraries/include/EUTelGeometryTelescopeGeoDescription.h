@@ -6,6 +6,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 // MARLIN
 #include "marlin/Global.h"
@@ -21,6 +22,8 @@
 // EUTELESCOPE
 #include "EUTelGenericPixGeoMgr.h"
 #include "EUTelGeoSupportClasses.h"
+#include "EUTelGeometrySnapshot.h"
+#include "EUTelMaterialBudget.h"
 #include "EUTelUtility.h"
 
 // Eigen
@@ -105,17 +108,26 @@ namespace eutelescope {
       /** Map holding the transformation matrix for each plane (identified by its planeID) */
 	    std::map<int, TGeoMatrix*> _TGeoMatrixMap;
 
+      /** The current snapshot of everything derived from _activeMap, _TGeoMatrixMap
+       *  and the material budget. Replaced as a whole, with std::atomic_store, whenever
+       *  any of them changes, see publishSnapshot()
+       */
+      std::shared_ptr<EUTelGeometrySnapshot const> _snapshot;
+
+      /** The object held by _snapshot, for the legacy getters on the thread modifying
+       *  the geometry. Set by publishSnapshot(), which is the only writer of _snapshot,
+       *  so it stays valid until the next publication without any atomic access.
+       */
+      EUTelGeometrySnapshot const * _currentSnapshot;
+
+      /** Version number of the last published snapshot */
+      unsigned long _snapshotVersion;
+
       /** Conter to indicate if instance of this object exists */
       static unsigned _counter;
 
-      /** Map containing the normal vector of each plane */
-      std::map<int, Eigen::Vector3d> _planeNormalMap;
-      /** Map containing the x-direction vector of each plane */
-      std::map<int, Eigen::Vector3d> _planeXMap;
-      /** Map containing the y-direction vector of each plane */
-      std::map<int, Eigen::Vector3d> _planeYMap;
-      /** Map containing the radiation length of each plane */
-      std::map<int, double> _planeRadMap;
+      /** Material budget lookup tables, sampled from TGeo when the geometry is initialised */
+      std::shared_ptr<EUTelMaterialBudget const> _materialBudget;
 
       /** Map containing all materials defined in GEAR file */
       std::map<std::string, EUTelMaterial> _materialMap;
@@ -156,7 +168,7 @@ namespace eutelescope {
 
       /** Align a given plane (sensorID) to a provided global position (in [mm]) 
        *  As this modifies the geometrical position it is important to clear 
-       *  memoized values
+       *  memoized values. The TGeo transformations and material tables stay as they are.
        */
       inline void alignGlobalPos(int sensorID, Eigen::Vector3d const &pos) {
         streamlog_out(MESSAGE4) << "Aligning sensor: " << sensorID
@@ -178,7 +190,7 @@ namespace eutelescope {
 
       /** Align a given plane (sensorID) to provided global rotations 
        *  As this modifies the geometrical position it is important to
-       *  clear memoized values
+       *  clear memoized values. The TGeo transformations and material tables stay as they are.
        */
       inline void alignGlobalRot(int sensorID, Eigen::Matrix3d const &rot) {
         streamlog_out(MESSAGE4) << "Aligning sensor: " << sensorID
@@ -196,6 +208,7 @@ namespace eutelescope {
        */
       inline void setPlanePitch(int sensorID, double const & xPitch, double const & yPitch) {
         _activeMap.at(sensorID)->setPitch(xPitch, yPitch);
+        this->clearMemoizedValues();
       }
 
       /** Set the given plane's amoutn of pixels in x- and y-direction
@@ -203,34 +216,55 @@ namespace eutelescope {
        */
       inline void setPlaneNoPixels(int sensorID, int xNo, int yNo) {
         _activeMap.at(sensorID)->setNoPixels(xNo, yNo);
+        this->clearMemoizedValues();
+      }
+
+      /** Returns the current, read-only snapshot of the geometry
+       *  The only entry point safe to call from any thread. Processors running work on
+       *  several threads should take the snapshot once per event and pass it to the
+       *  workers instead of calling into the geometry, the snapshot stays unchanged
+       *  while it is held even if the geometry is realigned meanwhile. The getters
+       *  below are for the thread owning the geometry only.
+       */
+      std::shared_ptr<EUTelGeometrySnapshot const> getSnapshot() const {
+        return std::atomic_load(&_snapshot);
+      }
+
+      /** Returns the record of all derived quantities of the given plane
+       *  The reference stays valid until the geometry is modified, e.g. by an
+       *  alignment; hold a snapshot to keep it longer. Throws for sensor IDs not
+       *  part of the geometry.
+       */
+      PlaneRecord const & getPlaneRecord(int sensorID) {
+        return currentSnapshot()->getPlaneRecord(sensorID);
       }
 
       /** Get the first flip matrix coefficient for the given plane
        *  Can only be plus or minus one or zero
        */
       int planeFlip1(int sensorID) {
-        return _activeMap.at(sensorID)->getFlipMatrix().coeff(0, 0);
+        return currentSnapshot()->getPlaneRecord(sensorID).flip[0];
       };
 
       /** Get the second flip matrix coefficient for the given plane
        *  Can only be plus or minus one or zero
        */
       int planeFlip2(int sensorID) {
-        return _activeMap.at(sensorID)->getFlipMatrix().coeff(1, 0);
+        return currentSnapshot()->getPlaneRecord(sensorID).flip[1];
       };
 
       /** Get the third flip matrix coefficient for the given plane
        *  Can only be plus or minus one or zero
        */
       int planeFlip3(int sensorID) {
-        return _activeMap.at(sensorID)->getFlipMatrix().coeff(0, 1);
+        return currentSnapshot()->getPlaneRecord(sensorID).flip[2];
       };
 
       /** Get the fourth flip matrix coefficient for the given plane
        *  Can only be plus or minus one or zero
        */
       int planeFlip4(int sensorID) {
-        return _activeMap.at(sensorID)->getFlipMatrix().coeff(1, 1);
+        return currentSnapshot()->getPlaneRecord(sensorID).flip[3];
       };
 
       /** Returns the given plane's position in global coordinates, in [mm] */ 
@@ -241,97 +275,97 @@ namespace eutelescope {
 
       /** X position of sensor center in the global coordinate frame, in [mm] */
       double getPlaneXPosition(int sensorID) {
-        return _activeMap.at(sensorID)->getPosition().coeff(0);
+        return currentSnapshot()->getPlaneRecord(sensorID).position(0);
       };
 
       /** Y position of sensor center in the global coordinate frame, in [mm] */
       double getPlaneYPosition(int sensorID) {
-        return _activeMap.at(sensorID)->getPosition().coeff(1);
+        return currentSnapshot()->getPlaneRecord(sensorID).position(1);
       };
 
       /** Z position of sensor center in the global coordinate frame, in [mm] */
       double getPlaneZPosition(int sensorID) {
-        return _activeMap.at(sensorID)->getPosition().coeff(2);
+        return currentSnapshot()->getPlaneRecord(sensorID).position(2);
       };
 
       /** Rotation around X axis of the global coordinate frame, in [deg] */
       double getPlaneXRotationDegrees(int sensorID) {
-        return _activeMap.at(sensorID)->getGlobalRotationAngles().coeff(0)*DEG;
+        return currentSnapshot()->getPlaneRecord(sensorID).rotation(0)*DEG;
       };
 
       /** Rotation around Y axis of global coordinate frame, in [deg] */
       double getPlaneYRotationDegrees(int sensorID) {
-        return _activeMap.at(sensorID)->getGlobalRotationAngles().coeff(1)*DEG;
+        return currentSnapshot()->getPlaneRecord(sensorID).rotation(1)*DEG;
       };
 
       /** Rotation around Z axis of global coordinate frame, in [deg] */
       double getPlaneZRotationDegrees(int sensorID) {
-        return _activeMap.at(sensorID)->getGlobalRotationAngles().coeff(2)*DEG;
+        return currentSnapshot()->getPlaneRecord(sensorID).rotation(2)*DEG;
       };
 
       /** Rotation around X axis of the global coordinate frame, in [rad] */
       double getPlaneXRotationRadians(int sensorID) {
-        return _activeMap.at(sensorID)->getGlobalRotationAngles().coeff(0);
+        return currentSnapshot()->getPlaneRecord(sensorID).rotation(0);
       };
 
       /** Rotation around Y axis of global coordinate frame, in [rad] */
       double getPlaneYRotationRadians(int sensorID) {
-        return _activeMap.at(sensorID)->getGlobalRotationAngles().coeff(1);
+        return currentSnapshot()->getPlaneRecord(sensorID).rotation(1);
       };
 
       /** Rotation around Z axis of global coordinate frame, in [rad] */
       double getPlaneZRotationRadians(int sensorID) {
-        return _activeMap.at(sensorID)->getGlobalRotationAngles().coeff(2);
+        return currentSnapshot()->getPlaneRecord(sensorID).rotation(2);
       };
 
       /** Sensor X side size, in [mm] */
       double getPlaneXSize(int sensorID) {
-        return _activeMap.at(sensorID)->getSize().coeff(0);
+        return currentSnapshot()->getPlaneRecord(sensorID).size(0);
       };
 
       /** Sensor Y side size, in [mm] */
       double getPlaneYSize(int sensorID) {
-        return _activeMap.at(sensorID)->getSize().coeff(1);
+        return currentSnapshot()->getPlaneRecord(sensorID).size(1);
       };
 
       /** Sensor Z side size, in [mm] */
       double getPlaneZSize(int sensorID) {
-        return _activeMap.at(sensorID)->getSize().coeff(2);
+        return currentSnapshot()->getPlaneRecord(sensorID).size(2);
       };
 
       /** Sensor X side pixel pitch, in [mm] */
       double getPlaneXPitch(int sensorID) {
-        return _activeMap.at(sensorID)->getPitch().first;
+        return currentSnapshot()->getPlaneRecord(sensorID).xPitch;
       };
 
       /** Sensor Y side pixel pitch, in [mm] */
       double getPlaneYPitch(int sensorID) {
-        return _activeMap.at(sensorID)->getPitch().second;
+        return currentSnapshot()->getPlaneRecord(sensorID).yPitch;
       };
 
       /** Number of pixels in x-direction */
       int getPlaneNumberOfPixelsX(int sensorID) {
-        return _activeMap.at(sensorID)->getNoPixels().first;
+        return currentSnapshot()->getPlaneRecord(sensorID).xNoPixels;
       };
 
       /** Number of pixels in y-direction */
       int getPlaneNumberOfPixelsY(int sensorID) {
-        return _activeMap.at(sensorID)->getNoPixels().second;
+        return currentSnapshot()->getPlaneRecord(sensorID).yNoPixels;
       };
 
       /** Resolution of sensor in x-direction, in [mm] */ 
       double getPlaneXResolution(int sensorID) {
-        return _activeMap.at(sensorID)->getResolution().first;
+        return currentSnapshot()->getPlaneRecord(sensorID).xResolution;
       };
 
       /** Resolution of sensor in y-direction, in [mm] */ 
       double getPlaneYResolution(int sensorID) {
-        return _activeMap.at(sensorID)->getResolution().second;
+        return currentSnapshot()->getPlaneRecord(sensorID).yResolution;
       };
 
       /** Return the sensor's radiation length in [mm]*/
       double getPlaneRadiationLength(int sensorID) {
-        return _activeMap.at(sensorID)->getRadLength();
+        return currentSnapshot()->getPlaneRecord(sensorID).radLength;
       };
 
       /** Name of pixel geometry library */
@@ -379,9 +413,24 @@ namespace eutelescope {
         */
       double getRadiationLengthBetweenPoints(Eigen::Vector3d const &startPt, Eigen::Vector3d const &endPt);
 
+      /** X/X0 of a plane for a track through its centre, the direction given in the global frame
+        * Taken from the material budget lookup table
+        */
       double planeRadLengthGlobalIncidence(int planeID, Eigen::Vector3d incidenceDir);
+
+      /** X/X0 of a plane for a track through its centre, the direction given in the local frame
+        * Taken from the material budget lookup table
+        */
       double planeRadLengthLocalIncidence(int planeID, Eigen::Vector3d incidenceDir);
 
+      /** Returns the material budget lookup tables of all planes and the gaps between them
+        * The tables are filled in initializeTGeoDescription and are read-only afterwards, thus 
+        * they may be queried from several threads concurrently, unlike TGeo. Like the TGeo
+        * geometry they are not updated by alignGlobalPos() and alignGlobalRot(), query them
+        * in local coordinates. Throws if the TGeo geometry has not been initialised.
+        */
+      EUTelMaterialBudget const & getMaterialBudget() const;
+
       void local2Master(int sensorID, std::array<double, 3> const &localPos,
                         std::array<double, 3> &globalPos);
       void master2Local(int sensorID, std::array<double, 3> const &globalPos,
@@ -396,6 +445,42 @@ namespace eutelescope {
       void local2MasterVec(int, const double[], double[]);
       void master2LocalVec(int, const double[], double[]);
 
+      /** Transform a batch of points of one sensor from the local into the global frame
+       *  The points are stored consecutively as (x,y,z) triples, i.e. localPos and
+       *  globalPos hold 3*noOfPoints values. Both may point to the same array.
+       */
+      void local2MasterBatch(int sensorID, size_t noOfPoints, const double localPos[], double globalPos[]);
+
+      /** Transform a batch of points of one sensor from the global into the local frame
+       *  Same memory layout as local2MasterBatch
+       */
+      void master2LocalBatch(int sensorID, size_t noOfPoints, const double globalPos[], double localPos[]);
+
+      /** Transform a batch of points of one sensor from the local into the global frame
+       *  Structure-of-arrays variant: each coordinate is stored in its own array of
+       *  noOfPoints values. The arithmetic is vectorised and performed in the same order
+       *  as in local2Master, results agree bit by bit unless the compiler contracts the
+       *  multiply-add into FMA instructions (e.g. -march=native), in which case they 
+       *  differ by a few ulp of the coordinate values, i.e. below 1E-12 mm for any point
+       *  within the world volume. The output arrays must not overlap the input arrays.
+       */
+      void local2MasterBatch(int sensorID, size_t noOfPoints, 
+                             const double localX[], const double localY[], const double localZ[],
+                             double globalX[], double globalY[], double globalZ[]);
+
+      /** Transform a batch of points of one sensor from the global into the local frame
+       *  Structure-of-arrays variant, same conditions as for local2MasterBatch
+       */
+      void master2LocalBatch(int sensorID, size_t noOfPoints,
+                             const double globalX[], const double globalY[], const double globalZ[],
+                             double localX[], double localY[], double localZ[]);
+
+      /** Returns the flat 3x4 affine local to global transformation of a plane
+       *  Row major, the last column being the translation. Throws if the plane is 
+       *  not part of the TGeo geometry.
+       */
+      std::array<double, 12> const & getPlaneTransform(int sensorID);
+
       // This outputs the total percentage radiation length for the full
       // detector system.
 //      float calculateTotalRadiationLengthAndWeights(
@@ -443,12 +528,26 @@ namespace eutelescope {
 
       void translateSiPlane2TGeo(TGeoVolume *, int);
 
+      /** Build a new snapshot from _activeMap, _TGeoMatrixMap and the material budget
+       *  and make it the current one
+       */
+      void publishSnapshot();
+
       void clearMemoizedValues() {
-        _planeNormalMap.clear();
-        _planeXMap.clear();
-        _planeYMap.clear();
-        _planeRadMap.clear();
+        publishSnapshot();
       }
+
+      /** Returns the current snapshot for the legacy getters, throws if none has been
+       *  published yet. A plain read, no atomic load and no reference counting: only
+       *  meant for the thread modifying the geometry, other threads use getSnapshot().
+       */
+      EUTelGeometrySnapshot const * currentSnapshot() const {
+        if( !_currentSnapshot ) noSnapshot();
+        return _currentSnapshot;
+      }
+
+      /** Throws the exception for accesses before the first snapshot is published */
+      [[noreturn]] static void noSnapshot();
     };
 
     inline EUTelGeometryTelescopeGeoDescription &
@@ -0,0 +1,138 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELMAPPEDFILE_H
+#define EUTELMAPPEDFILE_H
+
+// eutelescope includes ".h"
+#include "EUTELESCOPE.h"
+
+// system includes <>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Read-only binary input file mapped into memory
+  /*! Converters reading raw data word by word through an std::ifstream
+   *  pay for a library call per word. This class maps the whole file
+   *  into memory instead, the kernel then pages it in ahead of the
+   *  sequential access. Files that cannot be mapped, e.g. pipes, are
+   *  read completely into memory. While the buffer of a stream of unknown
+   *  size grows, the memory needed can briefly reach twice its size.
+   *
+   *  The file is read with a Cursor, which interprets the bytes in
+   *  place. Cursors are cheap to copy and can be restricted to a single
+   *  event with take(), so decoding an event never copies its data.
+   *
+   *  \b Usage:
+   *  \code{.cpp}
+   *  EUTelMappedFile file(fileName);
+   *  auto cursor = file.getCursor();
+   *  while(cursor.canRead(eventSize)) {
+   *    auto event = cursor.take(eventSize);
+   *    auto header = event.read<uint32_t>();
+   *    ...
+   *  }
+   *  \endcode
+   */
+  class EUTelMappedFile {
+
+  public:
+    //! Sequential reader of a range of bytes of the file
+    class Cursor {
+    public:
+      //! Constructor from the byte range [begin, end)
+      Cursor(char const *begin, char const *end) : _pos(begin), _end(end) {}
+
+      //! Get the number of bytes left
+      size_t remaining() const { return static_cast<size_t>(_end - _pos); }
+
+      //! Check if at least noOfBytes are left
+      bool canRead(size_t noOfBytes) const { return noOfBytes <= remaining(); }
+
+      //! Check if all bytes have been read
+      bool atEnd() const { return _pos == _end; }
+
+      //! Get the current position
+      char const *position() const { return _pos; }
+
+      //! Read a value of type T, canRead(sizeof(T)) is not checked
+      template <typename T> T read() {
+        T value;
+        //the data has no alignment guarantees
+        std::memcpy(&value, _pos, sizeof(T));
+        _pos += sizeof(T);
+        return value;
+      }
+
+      //! Read noOfValues values of type T into values, not range checked
+      template <typename T> void read(T *values, size_t noOfValues) {
+        std::memcpy(values, _pos, noOfValues * sizeof(T));
+        _pos += noOfValues * sizeof(T);
+      }
+
+      //! Skip noOfBytes, not range checked
+      void skip(size_t noOfBytes) { _pos += noOfBytes; }
+
+      //! Split off a cursor over the next noOfBytes, not range checked
+      Cursor take(size_t noOfBytes) {
+        Cursor part(_pos, _pos + noOfBytes);
+        _pos += noOfBytes;
+        return part;
+      }
+
+    private:
+      //! The next byte to read
+      char const *_pos;
+
+      //! One past the last byte of the range
+      char const *_end;
+    };
+
+    //! Constructor, opens and maps the file
+    /*! @throw lcio::IOException if the file cannot be opened or read */
+    explicit EUTelMappedFile(std::string const &fileName);
+
+    //! Destructor, unmaps the file
+    ~EUTelMappedFile();
+
+    //! Get the start of the file contents
+    char const *data() const { return _data; }
+
+    //! Get the size of the file in bytes
+    size_t size() const { return _size; }
+
+    //! Check if the file is mapped or was read into a buffer
+    bool isMapped() const { return _mapped; }
+
+    //! Get a cursor over the whole file
+    Cursor getCursor() const { return Cursor(_data, _data + _size); }
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(EUTelMappedFile)
+
+    //! Read the file from the descriptor into _buffer, sizeHint is its size if known, otherwise 0
+    void readAll(int fd, std::string const &fileName, size_t sizeHint);
+
+    //! The file contents, either mapped or pointing into _buffer
+    char const *_data;
+
+    //! The size of the file contents
+    size_t _size;
+
+    //! Whether _data is a memory mapping
+    bool _mapped;
+
+    //! The contents of files that could not be mapped
+    std::vector<char> _buffer;
+  };
+}
+#endif
@@ -0,0 +1,133 @@
+#ifndef EUTELMATERIALBUDGET_H
+#define EUTELMATERIALBUDGET_H
+
+// C++
+#include <array>
+#include <cstddef>
+#include <vector>
+
+// Eigen
+#include <Eigen/Core>
+
+/** @class EUTelMaterialBudget
+ * Lookup tables of the material budget (X/X0) of the telescope.
+ *
+ * Determining the material along a track from the TGeo geometry means
+ * stepping through the volumes with gGeoManager, which is slow and, since
+ * gGeoManager is global state, cannot be done from several threads. This
+ * class samples the material once, when the geometry is loaded, and answers
+ * all later queries by interpolating in its tables.
+ *
+ * For each plane the material traversed within the plane is tabulated on a
+ * grid of impact positions (local x and y across the sensor) and incidence
+ * slopes (local dx/dz and dy/dz). The tables hold the X/X0 scaled to normal
+ * incidence, i.e. multiplied by the cosine of the incidence angle, which is
+ * constant for a homogeneous slab. A query divides by the exact cosine
+ * again, so the interpolation only has to cover true variations of the
+ * material.
+ *
+ * For each gap between a plane and the next one downstream (in z order) the
+ * material between leaving the plane and entering the next one is tabulated
+ * on the same grid, measured on the upstream plane. The tables hold the
+ * X/X0 per mm of path, a query multiplies by the exact path length to the
+ * next plane.
+ *
+ * The tables are sampled with the transformations of the TGeo description
+ * at construction. Aligning the plane descriptions afterwards does not
+ * change them, thus they are queried in the local frame of a plane. The
+ * global variants convert with the transformation used for sampling.
+ *
+ * Positions and slopes outside the grid are clamped to its border. Once
+ * constructed the object is never modified, all queries are const and can
+ * be run concurrently without locking.
+ */
+namespace eutelescope {
+  namespace geo {
+
+    class EUTelGeometryTelescopeGeoDescription;
+
+    class EUTelMaterialBudget {
+    public:
+      /** Granularity of the lookup tables */
+      struct Binning {
+        /** Number of grid nodes along each local axis of the sensor */
+        size_t noOfPositionNodes = 5;
+        /** Number of grid nodes along each local slope axis */
+        size_t noOfSlopeNodes = 9;
+        /** Largest |dx/dz| and |dy/dz| in the local frame covered by the grid */
+        double maxSlope = 1.0;
+      };
+
+      /** Sample the material of all planes and gaps of the given geometry
+       *  The TGeo description of the geometry must be initialised.
+       */
+      EUTelMaterialBudget(EUTelGeometryTelescopeGeoDescription &geo, Binning const &binning);
+
+      /** X/X0 traversed within the plane
+       *  @param sensorID the plane
+       *  @param localPos impact position in the local frame of the plane, in [mm]
+       *  @param localDir direction of the track in the local frame of the plane
+       */
+      double planeRadLength(int sensorID, Eigen::Vector3d const &localPos, Eigen::Vector3d const &localDir) const;
+
+      /** X/X0 traversed within the plane, position and direction in the global frame */
+      double planeRadLengthGlobal(int sensorID, Eigen::Vector3d const &globalPos, Eigen::Vector3d const &globalDir) const;
+
+      /** X/X0 between the plane and the next plane downstream, 0 for the last plane
+       *  @param sensorID the upstream plane
+       *  @param localDir direction of the track in the local frame of the plane, its sign does not matter
+       *  @param localDir direction of the track in the local frame of the plane
+       */
+      double gapRadLength(int sensorID, Eigen::Vector3d const &localPos, Eigen::Vector3d const &localDir) const;
+
+      /** X/X0 between the plane and the next plane downstream, position and direction in the global frame */
+      double gapRadLengthGlobal(int sensorID, Eigen::Vector3d const &globalPos, Eigen::Vector3d const &globalDir) const;
+
+      /** The granularity the tables were filled with */
+      Binning const & getBinning() const { return _binning; }
+
+    private:
+      /** Everything needed to answer the queries of one plane */
+      struct PlaneTable {
+        int sensorID;
+        /** Local to global transformation, same layout as in the geometry description */
+        std::array<double, 12> transform;
+        /** Half size of the sensor along the local x and y axis */
+        double halfSizeX, halfSizeY;
+        /** Half thickness of the sampled slab, including a small safety margin */
+        double halfThickness;
+        /** X/X0 scaled to normal incidence, see gridIndex() for the layout */
+        std::vector<double> plane;
+        /** X/X0 per mm of path to the next plane, empty for the last plane */
+        std::vector<double> gap;
+      };
+
+      /** Returns the table of the plane, throws for unknown sensors */
+      PlaneTable const & getTable(int sensorID) const;
+
+      /** Index of the grid node (ix, iy, itx, ity) in the tables */
+      size_t gridIndex(size_t ix, size_t iy, size_t itx, size_t ity) const {
+        return ((ix*_binning.noOfPositionNodes + iy)*_binning.noOfSlopeNodes + itx)*_binning.noOfSlopeNodes + ity;
+      }
+
+      /** Quadrilinear interpolation of a table at the given local position and slopes */
+      double interpolate(PlaneTable const &table, std::vector<double> const &values,
+                         double x, double y, double tx, double ty) const;
+
+      /** Path length from leaving the plane at localPos to entering the next plane
+       *  Returns a non-positive value if the track does not reach the next plane.
+       */
+      double gapLength(size_t index, Eigen::Vector3d const &localPos, Eigen::Vector3d const &localDir) const;
+
+      /** Granularity of the tables */
+      Binning _binning;
+
+      /** One table per plane, ordered along the global z-axis */
+      std::vector<PlaneTable> _tables;
+
+      /** Index in _tables for each sensor ID (used as index), -1 for unknown sensors */
+      std::vector<int> _tableSlots;
+    };
+  } // namespace geo
+} // namespace eutelescope
+#endif /* EUTELMATERIALBUDGET_H */
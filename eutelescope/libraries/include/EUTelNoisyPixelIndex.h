@@ -0,0 +1,145 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELNOISYPIXELINDEX_H
+#define EUTELNOISYPIXELINDEX_H
+
+// eutelescope includes ".h"
+#include "EUTELESCOPE.h"
+
+// lcio includes <.h>
+#include <EVENT/LCEvent.h>
+#include <IMPL/TrackerDataImpl.h>
+
+// system includes <>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Constant time lookup of noisy pixels
+  /*! The noisy pixel database written by EUTelNoisyPixelFinder is a list
+   *  of pixels per sensor. Processors masking or removing noisy pixels
+   *  have to check every hit pixel against it. This index stores one
+   *  packed bitset per sensor instead, covering the bounding box of the
+   *  noisy pixels of that sensor, so each check is a range check and a
+   *  single bit test, independent of the number of noisy pixels.
+   *
+   *  The index is immutable once built. getShared() builds it once per
+   *  run and collection name from the noisy pixel collection of an event
+   *  and hands the same instance to all processors asking for it.
+   *
+   *  \b Usage:
+   *  \code{.cpp}
+   *  auto index = EUTelNoisyPixelIndex::getShared(event, "noisyPixel");
+   *  auto mask = index->getSensorMask(sensorID);
+   *  if(mask && mask->containsNoisyPixel(clusterData, pixelType)) ...
+   *  \endcode
+   */
+  class EUTelNoisyPixelIndex {
+
+  public:
+    //! Noisy pixels of one sensor as a packed bitset
+    class SensorMask {
+    public:
+      //! Default constructor, no noisy pixels
+      SensorMask();
+
+      //! Constructor from the pixel coordinates (x,y), duplicates are fine
+      explicit SensorMask(std::vector<std::array<int, 2>> const &pixels);
+
+      //! Check if the pixel (x,y) is noisy
+      bool isNoisy(int x, int y) const {
+        //negative differences wrap around and fail the range check
+        auto dx = static_cast<std::uint64_t>(static_cast<std::int64_t>(x) - _offX);
+        auto dy = static_cast<std::uint64_t>(static_cast<std::int64_t>(y) - _offY);
+        if(dx >= _sizeX || dy >= _sizeY) return false;
+        auto bit = dx * _sizeY + dy;
+        return (_bits[bit >> 6] >> (bit & 63)) & 1;
+      }
+
+      //! Check if any pixel of the sparsified data is noisy
+      /*! @throw UnknownDataTypeException for unsupported pixel types */
+      bool containsNoisyPixel(IMPL::TrackerDataImpl const *data,
+                              SparsePixelType type) const;
+
+      //! Get the number of noisy pixels
+      size_t size() const { return _noOfPixels; }
+
+      //! Check if there are no noisy pixels
+      bool empty() const { return _noOfPixels == 0; }
+
+    protected:
+      //! Lowest x and y index of the noisy pixels
+      std::int64_t _offX, _offY;
+
+      //! Size of the bounding box of the noisy pixels
+      std::uint64_t _sizeX, _sizeY;
+
+      //! The bits of the bounding box, x-major
+      std::vector<std::uint64_t> _bits;
+
+      //! The number of different noisy pixels
+      size_t _noOfPixels;
+    };
+
+    //! Default constructor, no noisy pixels at all
+    EUTelNoisyPixelIndex();
+
+    //! Constructor from the noisy pixel coordinates, the key is the sensorID
+    explicit EUTelNoisyPixelIndex(
+        std::map<int, std::vector<std::array<int, 2>>> const &pixels);
+
+    //! Read the index from the noisy pixel collection of an event
+    /*! If the collection is not found, a warning is printed and the
+     *  index is empty. Noisy pixels stored as another pixel type than
+     *  EUTelGenericSparsePixel are reported and ignored, as done by
+     *  Utility::readNoisyPixelList().
+     */
+    static EUTelNoisyPixelIndex read(EVENT::LCEvent *event,
+                                     std::string const &collectionName);
+
+    //! Get the index shared between all processors for a collection
+    /*! The index is read from the event by the first call for a given
+     *  run and collection name, subsequent calls in the same run return
+     *  the same instance. If the collection is missing or holds no noisy
+     *  pixels, the empty index is returned but not kept, so the next
+     *  call reads the collection again.
+     */
+    static std::shared_ptr<EUTelNoisyPixelIndex const>
+    getShared(EVENT::LCEvent *event, std::string const &collectionName);
+
+    //! Get the mask of a sensor, nullptr if it has no noisy pixels
+    SensorMask const *getSensorMask(int sensorID) const {
+      if(sensorID < 0 || static_cast<size_t>(sensorID) >= _sensorMasks.size()) {
+        return nullptr;
+      }
+      auto const &mask = _sensorMasks[static_cast<size_t>(sensorID)];
+      return mask.empty() ? nullptr : &mask;
+    }
+
+    //! Check if the pixel (x,y) of a sensor is noisy
+    bool isNoisy(int sensorID, int x, int y) const {
+      auto mask = getSensorMask(sensorID);
+      return mask != nullptr && mask->isNoisy(x, y);
+    }
+
+    //! Get the IDs of all sensors with noisy pixels, in ascending order
+    std::vector<int> getSensorIDs() const;
+
+  protected:
+    //! The sensor masks, indexed by sensorID
+    std::vector<SensorMask> _sensorMasks;
+  };
+}
+#endif
@@ -0,0 +1,145 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELSPARSECLUSTERFINDER_H
+#define EUTELSPARSECLUSTERFINDER_H
+
+// system includes <>
+#include <cstddef>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Connected component finder for sparsified pixel data
+  /*! This class groups the pixels of a single sensor into clusters. Two
+   *  pixels belong to the same cluster if the squared distance of their
+   *  pixel indices is smaller or equal to a given cut, the clusters are
+   *  the connected components of this neighbour relation.
+   *
+   *  Instead of comparing every pixel against every remaining pixel, the
+   *  pixels are sorted into a column index (sorted by x, then y) once per
+   *  sensor. Neighbour candidates are then only searched in the occupied
+   *  columns within reach of the cut and, inside each column, in the y
+   *  window allowed by the remaining distance. This keeps the cost close
+   *  to linear in the number of pixels even for high occupancy sensors.
+   *
+   *  The clusters and the order of pixels within a cluster are identical
+   *  to the ones of the iterative neighbour search originally implemented
+   *  in EUTelSparseClustering: clusters are seeded by the first pixel not
+   *  yet assigned and grown breadth first, neighbours of each pixel being
+   *  added in their input order.
+   *
+   *  The internal buffers are kept between calls, so a single instance
+   *  can be reused for all sensors and events without reallocation.
+   *
+   *  \b Usage:
+   *  \code{.cpp}
+   *  EUTelSparseClusterFinder finder;
+   *  finder.clear();
+   *  for(auto& pixel: pixels) finder.addPixel(pixel.getXCoord(), pixel.getYCoord());
+   *  finder.findClusters(minDistanceSquared);
+   *  for(size_t iCluster = 0; iCluster < finder.getNumberOfClusters(); ++iCluster) {
+   *    for(auto it = finder.clusterBegin(iCluster); it != finder.clusterEnd(iCluster); ++it) {
+   *      pixels[*it] ...
+   *    }
+   *  }
+   *  \endcode
+   */
+  class EUTelSparseClusterFinder {
+
+  public:
+    //! Default constructor
+    EUTelSparseClusterFinder();
+
+    //! Remove all pixels and clusters, keeping the allocated memory
+    void clear();
+
+    //! Reserve memory for a given number of pixels
+    void reserve(size_t noOfPixels);
+
+    //! Add a pixel by its indices
+    /*! The pixel is identified in the output by the order of insertion,
+     *  i.e. the first added pixel has index 0.
+     */
+    void addPixel(int xCoord, int yCoord) {
+      _xCoord.push_back(xCoord);
+      _yCoord.push_back(yCoord);
+    }
+
+    //! Get the number of pixels added since the last clear()
+    size_t getNumberOfPixels() const { return _xCoord.size(); }
+
+    //! Group all added pixels into clusters
+    /*! @param minDistanceSquared Squared distance in pixel indices up to
+     *  which two pixels are considered neighbours (touching == 2). A
+     *  negative value results in single pixel clusters.
+     *
+     *  @return The number of clusters found
+     */
+    size_t findClusters(int minDistanceSquared);
+
+    //! Get the number of clusters found by the last findClusters()
+    size_t getNumberOfClusters() const {
+      return _clusterOffsets.empty() ? 0 : _clusterOffsets.size() - 1;
+    }
+
+    //! Get the number of pixels in a cluster
+    size_t getClusterSize(size_t iCluster) const {
+      return _clusterOffsets[iCluster + 1] - _clusterOffsets[iCluster];
+    }
+
+    //! Iterator to the first pixel index of a cluster
+    std::vector<size_t>::const_iterator clusterBegin(size_t iCluster) const {
+      return _clusterPixels.cbegin() + _clusterOffsets[iCluster];
+    }
+
+    //! Iterator past the last pixel index of a cluster
+    std::vector<size_t>::const_iterator clusterEnd(size_t iCluster) const {
+      return _clusterPixels.cbegin() + _clusterOffsets[iCluster + 1];
+    }
+
+  protected:
+    //! Sort the pixels into the column index
+    void buildColumnIndex();
+
+    //! Collect all not yet assigned neighbours of a pixel into _neighbours
+    void collectNeighbours(size_t iPixel, int minDistanceSquared,
+                           int maxDeltaX);
+
+    //! Pixel x indices in input order
+    std::vector<int> _xCoord;
+
+    //! Pixel y indices in input order
+    std::vector<int> _yCoord;
+
+    //! Pixel numbers sorted by x, y and input order
+    std::vector<size_t> _sortedPixels;
+
+    //! The distinct occupied columns (x index), ascending
+    std::vector<int> _columns;
+
+    //! Offsets of each occupied column into _sortedPixels
+    /*! Has one entry more than _columns, the last one being the total
+     *  number of pixels.
+     */
+    std::vector<size_t> _columnOffsets;
+
+    //! Flag for each pixel if it has already been assigned to a cluster
+    std::vector<char> _assigned;
+
+    //! Scratch buffer for the neighbours of the currently processed pixel
+    std::vector<size_t> _neighbours;
+
+    //! Pixel numbers of all clusters, cluster after cluster
+    std::vector<size_t> _clusterPixels;
+
+    //! Offsets of each cluster into _clusterPixels
+    std::vector<size_t> _clusterOffsets;
+  };
+}
+#endif
@@ -0,0 +1,121 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+#ifndef EUTELTHREADPOOL_H
+#define EUTELTHREADPOOL_H
+
+// eutelescope includes ".h"
+#include "EUTELESCOPE.h"
+
+// system includes <>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace eutelescope {
+
+  //! Persistent pool of worker threads
+  /*! The pool starts its threads once and keeps them waiting between
+   *  jobs, so processors can hand over work every event without paying
+   *  for thread creation.
+   *
+   *  A job consists of a number of independent tasks, identified by
+   *  their task index. The tasks are handed out dynamically to the
+   *  workers, the calling thread takes part as worker 0. Each call to
+   *  the task function also gets the index of the executing worker, which
+   *  can be used to address per worker buffers without locking.
+   *
+   *  run() returns only after all tasks are done. If a task throws, the
+   *  first exception is rethrown in the calling thread once the job is
+   *  finished. The pool itself is not reentrant: run() must not be called
+   *  concurrently or from within a task.
+   *
+   *  \b Usage:
+   *  \code{.cpp}
+   *  EUTelThreadPool pool(4);
+   *  std::vector<double> partial(pool.getNumberOfWorkers(), 0.);
+   *  pool.run(tracks.size(), [&](size_t iTrack, size_t iWorker) {
+   *    partial[iWorker] += fit(tracks[iTrack]);
+   *  });
+   *  \endcode
+   */
+  class EUTelThreadPool {
+
+  public:
+    //! The signature of a task: task index and worker index
+    typedef std::function<void(size_t, size_t)> Task;
+
+    //! Constructor
+    /*! @param noOfWorkers The number of workers including the calling
+     *  thread, i.e. noOfWorkers-1 threads are started. Zero or one
+     *  results in all tasks being executed in the calling thread.
+     */
+    explicit EUTelThreadPool(size_t noOfWorkers);
+
+    //! Destructor, stops and joins all threads
+    ~EUTelThreadPool();
+
+    //! Get the number of workers including the calling thread
+    size_t getNumberOfWorkers() const { return _threads.size() + 1; }
+
+    //! Execute task(iTask, iWorker) for all iTask in [0, noOfTasks)
+    /*! Blocks until all tasks are finished.
+     *
+     *  @throw Rethrows the first exception thrown by any task
+     */
+    void run(size_t noOfTasks, Task const &task);
+
+  private:
+    DISALLOW_COPY_AND_ASSIGN(EUTelThreadPool)
+
+    //! Main loop of the started threads
+    void workerLoop(size_t iWorker);
+
+    //! Fetch and execute tasks of the current job until none are left
+    void execute(size_t iWorker);
+
+    //! The started threads
+    std::vector<std::thread> _threads;
+
+    //! Mutex protecting the job state below
+    std::mutex _mutex;
+
+    //! Signals the threads that a new job is available or the pool stops
+    std::condition_variable _startCondition;
+
+    //! Signals the calling thread that all threads finished the job
+    std::condition_variable _doneCondition;
+
+    //! The task of the current job
+    Task const *_task;
+
+    //! The number of tasks of the current job
+    size_t _noOfTasks;
+
+    //! Index of the next task to be handed out
+    std::atomic<size_t> _nextTask;
+
+    //! Number of threads still working on the current job
+    size_t _activeThreads;
+
+    //! Job counter, used by the threads to detect a new job
+    unsigned long _generation;
+
+    //! Stop flag set by the destructor
+    bool _stop;
+
+    //! First exception thrown by a task of the current job
+    std::exception_ptr _exception;
+  };
+}
+#endif
@@ -64,6 +64,9 @@
 #include <utility>
 #include <deque>
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -73,6 +76,10 @@
 
 // Eigen include
 #include <Eigen/Core>
+
+// eutelescope includes ".h"
+#include "EUTelGeometrySnapshot.h"
+
 using namespace marlin;
 
 namespace eutelescope {
@@ -235,6 +242,162 @@ public:
 
     };
 
+    //! Coordinates of hits (or triplets) sorted along one axis
+    /*! Stores pairs of a coordinate and the index of the object it
+     *  belongs to. After sort(), all objects within a coordinate window
+     *  can be retrieved with a binary search instead of a full scan.
+     *  The memory is kept between events when reused via clear().
+     */
+    class coordIndex {
+    public:
+        coordIndex() : _entries() {}
+
+        void clear() { _entries.clear(); }
+
+        void push_back(double coord, size_t ix) { _entries.emplace_back(coord, ix); }
+
+        //! Sort by coordinate, entries with equal coordinates keep their index order
+        void sort() {
+            std::sort(_entries.begin(), _entries.end());
+        }
+
+        size_t size() const { return _entries.size(); }
+
+        bool empty() const { return _entries.empty(); }
+
+        //! Call fn(ix) for all entries with low <= coord <= high
+        template<typename F>
+        void query(double low, double high, F&& fn) const {
+            for(auto it = lowerBound(low); it != _entries.end() && it->first <= high; ++it) {
+                fn(it->second);
+            }
+        }
+
+        //! Number of entries with coord < value
+        size_t countBelow(double value) const {
+            return static_cast<size_t>(lowerBound(value) - _entries.begin());
+        }
+
+    private:
+        std::vector<std::pair<double,size_t>>::const_iterator lowerBound(double value) const {
+            return std::lower_bound(_entries.begin(), _entries.end(), value,
+                                    [](std::pair<double,size_t> const & entry, double coord) {
+                                        return entry.first < coord;
+                                    });
+        }
+
+        std::vector<std::pair<double,size_t>> _entries;
+    };
+
+    //! Positions of triplets or hits in a plane of fixed z
+    /*! Every entry holds an x/y position and a reference index (e.g. into
+     *  the vector of triplets or hits it was built from). The entries are
+     *  indexed in x and y, so all entries within a window around a point
+     *  are found with a binary search. Entries are numbered in insertion
+     *  order, sorting entry numbers restores the original order.
+     */
+    class positionIndex {
+    public:
+        positionIndex() : _x(), _y(), _ref(), _xIndex(), _yIndex() {}
+
+        void clear() {
+            _x.clear();
+            _y.clear();
+            _ref.clear();
+            _xIndex.clear();
+            _yIndex.clear();
+        }
+
+        void push_back(double x, double y, size_t ref) {
+            _xIndex.push_back(x, _x.size());
+            _yIndex.push_back(y, _y.size());
+            _x.push_back(x);
+            _y.push_back(y);
+            _ref.push_back(ref);
+        }
+
+        //! Has to be called after all entries are added and before querying
+        void sort() {
+            _xIndex.sort();
+            _yIndex.sort();
+        }
+
+        size_t size() const { return _x.size(); }
+
+        bool empty() const { return _x.empty(); }
+
+        double x(size_t entry) const { return _x[entry]; }
+
+        double y(size_t entry) const { return _y[entry]; }
+
+        size_t ref(size_t entry) const { return _ref[entry]; }
+
+        //! Call fn(entry) for all entries with xLow <= x <= xHigh
+        template<typename F>
+        void queryX(double xLow, double xHigh, F&& fn) const { _xIndex.query(xLow, xHigh, std::forward<F>(fn)); }
+
+        //! Call fn(entry) for all entries with yLow <= y <= yHigh
+        template<typename F>
+        void queryY(double yLow, double yHigh, F&& fn) const { _yIndex.query(yLow, yHigh, std::forward<F>(fn)); }
+
+        //! Number of entries with x < xValue
+        size_t countBelowX(double xValue) const { return _xIndex.countBelow(xValue); }
+
+        //! Number of entries with y < yValue
+        size_t countBelowY(double yValue) const { return _yIndex.countBelow(yValue); }
+
+    private:
+        std::vector<double> _x;
+        std::vector<double> _y;
+        std::vector<size_t> _ref;
+        coordIndex _xIndex;
+        coordIndex _yIndex;
+    };
+
+    //! Fixed binning counter, a cheap stand-in for an AIDA histogram
+    /*! Uses the same bin assignment as a ROOT histogram with the same
+     *  binning, including under- and overflow. flush() adds the counts
+     *  to a histogram as one weighted fill per bin and resets them.
+     */
+    class binnedCounter {
+    public:
+        binnedCounter() : _bins(0), _low(0), _high(0), _counts(2, 0) {}
+
+        binnedCounter(int bins, double low, double high)
+            : _bins(bins), _low(low), _high(high), _counts(static_cast<size_t>(bins)+2, 0) {}
+
+        //! Add count entries at value
+        void fill(double value, long count = 1) {
+            size_t bin = 0;
+            if(value >= _high) {
+                bin = static_cast<size_t>(_bins) + 1;
+            } else if(value >= _low) {
+                bin = 1 + static_cast<size_t>(_bins*(value - _low)/(_high - _low));
+            }
+            _counts[bin] += count;
+        }
+
+        //! Add count entries below the range
+        void fillUnderflow(long count) { _counts.front() += count; }
+
+        //! Add count entries above the range
+        void fillOverflow(long count) { _counts.back() += count; }
+
+        double low() const { return _low; }
+
+        double high() const { return _high; }
+
+        //! Add the counts to histo and reset them
+        void flush(AIDA::IHistogram1D * histo);
+
+    private:
+        int _bins;
+        double _low;
+        double _high;
+        //! Bin 0 is the underflow, bin _bins+1 the overflow
+        std::vector<long> _counts;
+    };
+
     class track {
     public:
         //! Default Track constructor. To be called with two triplets.
@@ -261,6 +424,20 @@ public:
         triplet downstream;
     };
 
+    //! Monitoring policies of FindTriplets, MatchTriplets and AttachDUT
+    /*! The cut histograms are filled for every candidate combination,
+     *  which for AIDA is a virtual call each.
+     *  - histogramMonitoring fills the AIDA histograms directly
+     *  - counterMonitoring fills binned counters with the same binning,
+     *    they are added to the histograms by flushHistos(). For the
+     *    matching residuals only the entries within the histogram range
+     *    are visited, the others are counted in the under- and overflow.
+     *  - noMonitoring does not fill anything
+     */
+    struct histogramMonitoring {};
+    struct counterMonitoring {};
+    struct noMonitoring {};
+
     //! Find hit triplets from three telescope planes
     /*! This runs over all hits in the planes of the telescope and
      * tries to match triplets by comparing with the middle planes.
@@ -271,25 +448,100 @@ public:
      * Two cut criteria can be set:
      * @param triplet_res_cut Cut on the hit residual in the middle plane with respect to the triplet defined by first and last plane [mm]
      * @param triplet_slope_cut Cut on the triplet track angle [rad]
+     * The template parameter Monitoring selects how the cut histograms
+     * are filled, see histogramMonitoring.
      *
      * @return a vector of found triplets among the given set of hits.
      */
-    template<typename T>
+    template<typename Monitoring = histogramMonitoring, typename T>
     void FindTriplets(std::vector<EUTelTripletGBLUtility::hit> const & hits, T const & triplet_sensor_ids, double trip_res_cut, double trip_slope_cut, std::vector<EUTelTripletGBLUtility::triplet> & found_trip, bool only_best_triplet = true, bool upstream = true);
 
+    //! Add the counts of counterMonitoring to the cut histograms
+    /*! Has to be called at the end, before the histograms are used. */
+    void flushHistos();
+
     //! Match the upstream and downstream triplets to tracks
+    /*! Both triplet sets are indexed at z_match, every upstream triplet is
+     *  only compared to the downstream triplets within the matching window.
+     *  The isolation of all triplets is determined once with the same index.
+     *  The tracks and their order are the same as for a comparison of all
+     *  pairs, the matching residual histograms receive all pairs as
+     *  selected by Monitoring, see histogramMonitoring.
+     */
+    template<typename Monitoring = histogramMonitoring>
     void MatchTriplets(std::vector<EUTelTripletGBLUtility::triplet> const & up, std::vector<EUTelTripletGBLUtility::triplet> const & down, double z_match, double trip_matching_cut, std::vector<EUTelTripletGBLUtility::track> &track);
 
-    bool AttachDUT(EUTelTripletGBLUtility::triplet & triplet, std::vector<EUTelTripletGBLUtility::hit> const & hits, unsigned int dutID,  std::vector<float> dist_cuts);
+    //! Attach the closest DUT hit using an index of the DUT hits
+    /*! Only the hits of the DUT within the distance cuts are compared,
+     *  the matching residual histograms receive all hits of the DUT as
+     *  selected by Monitoring, see histogramMonitoring.
+     *  @param dutIndex Index of the hits on dutID as filled by IndexDUTHits()
+     *  @param geometry Snapshot of the geometry taken once for the event
+     */
+    template<typename Monitoring = histogramMonitoring>
+    bool AttachDUT(EUTelTripletGBLUtility::triplet & triplet, std::vector<EUTelTripletGBLUtility::hit> const & hits, positionIndex const & dutIndex, geo::EUTelGeometrySnapshot const & geometry, unsigned int dutID, std::vector<float> const & dist_cuts);
+
+    //! Fill the index of all hits on the plane dutID, referencing their position in hits
+    void IndexDUTHits(std::vector<EUTelTripletGBLUtility::hit> const & hits, unsigned int dutID, positionIndex & dutIndex) const;
 
     //! Check isolation of triplet within vector of triplets
     bool IsTripletIsolated(EUTelTripletGBLUtility::triplet const & it, std::vector<EUTelTripletGBLUtility::triplet> const &trip, double z_match, double isolation = 0.3);
 
+    //! Check isolation of an entry within an index of triplet positions
+    /*! Same criterion as above, the positions have to be the triplets
+     *  extrapolated to the matching z.
+     */
+    bool IsTripletIsolated(size_t entry, positionIndex const & index, double isolation = 0.3) const;
+
 private:
 
+    //! Fill counter with sign*(coord - reference) for all entries of index
+    /*! The coordinate is y if useY is set, x otherwise, sign is +1 or -1.
+     *  Only the entries within the range of the counter are visited, the
+     *  others are added to its under- and overflow as one count each.
+     */
+    static void fillDistances(binnedCounter & counter, positionIndex const & index, bool useY, double reference, double sign);
+
     //! store the parent, needed for having histograms in the same file as the processor that calls the util class
     marlin::Processor * parent;
 
+    //! Hits of the first and last triplet plane, reused by FindTriplets
+    std::vector<EUTelTripletGBLUtility::hit const *> _tripletOuterHits0;
+    std::vector<EUTelTripletGBLUtility::hit const *> _tripletOuterHits2;
+
+    //! Hits of the middle triplet plane and their x/y sorted indices, reused by FindTriplets
+    std::vector<EUTelTripletGBLUtility::hit const *> _tripletMiddleHits;
+    coordIndex _tripletMiddleX;
+    coordIndex _tripletMiddleY;
+
+    //! Scratch buffer for the middle plane candidates of one hit pair
+    std::vector<size_t> _tripletCandidates;
+
+    //! Triplet positions at the matching z, reused by MatchTriplets
+    positionIndex _upstreamMatchIndex;
+    positionIndex _downstreamMatchIndex;
+
+    //! Isolation flags of the triplets, reused by MatchTriplets
+    std::vector<char> _upstreamIsolated;
+    std::vector<char> _downstreamIsolated;
+
+    //! Scratch buffer for the matching candidates of one triplet or DUT
+    std::vector<size_t> _matchCandidates;
+
+    //! Counters of the cut histograms for counterMonitoring
+    binnedCounter _upstreamSlopeXCounter;
+    binnedCounter _upstreamSlopeYCounter;
+    binnedCounter _downstreamSlopeXCounter;
+    binnedCounter _downstreamSlopeYCounter;
+    binnedCounter _upstreamResidualXCounter;
+    binnedCounter _upstreamResidualYCounter;
+    binnedCounter _downstreamResidualXCounter;
+    binnedCounter _downstreamResidualYCounter;
+    binnedCounter _tripletMatchingResidualXCounter;
+    binnedCounter _tripletMatchingResidualYCounter;
+    binnedCounter _DUTMatchingResidualXCounter;
+    binnedCounter _DUTMatchingResidualYCounter;
+
 
 
 protected:
@@ -2,7 +2,7 @@
 #define EUTelTripletGBLUtility_tcc
 namespace eutelescope {
 
-template<typename T>
+template<typename Monitoring, typename T>
 void EUTelTripletGBLUtility::FindTriplets(std::vector<EUTelTripletGBLUtility::hit> const & hits, T const & triplet_sensor_ids, double trip_res_cut, double slope_cut, std::vector<EUTelTripletGBLUtility::triplet> & found_triplets, bool only_best_triplet, bool upstream) {
 
   if(triplet_sensor_ids.size() != 3){
@@ -13,52 +13,84 @@ void EUTelTripletGBLUtility::FindTriplets(std::vector<EUTelTripletGBLUtility::hi
   auto plane1 = static_cast<unsigned>(triplet_sensor_ids[1]);
   auto plane2 = static_cast<unsigned>(triplet_sensor_ids[2]);
 
-  // get all hit is plane = plane0
+  auto slopeHistoX = (upstream == 1) ? upstreamTripletSlopeX : downstreamTripletSlopeX;
+  auto slopeHistoY = (upstream == 1) ? upstreamTripletSlopeY : downstreamTripletSlopeY;
+  auto residualHistoX = (upstream == 1) ? upstreamTripletResidualX : downstreamTripletResidualX;
+  auto residualHistoY = (upstream == 1) ? upstreamTripletResidualY : downstreamTripletResidualY;
+
+  // the monitoring policy is fixed at compile time, the unused branches are removed
+  bool const monitor = !std::is_same<Monitoring, noMonitoring>::value;
+  auto& slopeCounterX = upstream ? _upstreamSlopeXCounter : _downstreamSlopeXCounter;
+  auto& slopeCounterY = upstream ? _upstreamSlopeYCounter : _downstreamSlopeYCounter;
+  auto& residualCounterX = upstream ? _upstreamResidualXCounter : _downstreamResidualXCounter;
+  auto& residualCounterY = upstream ? _upstreamResidualYCounter : _downstreamResidualYCounter;
+  auto fill = [](AIDA::IHistogram1D * histo, binnedCounter & counter, double value, size_t count = 1) {
+    if(std::is_same<Monitoring, counterMonitoring>::value) counter.fill(value, static_cast<long>(count));
+    else histo->fill(value, static_cast<double>(count));
+  };
+
+  // split the hits by plane, keeping their order
+  _tripletOuterHits0.clear();
+  _tripletOuterHits2.clear();
+  _tripletMiddleHits.clear();
+  _tripletMiddleX.clear();
+  _tripletMiddleY.clear();
+  double zMin1 = std::numeric_limits<double>::max();
+  double zMax1 = std::numeric_limits<double>::lowest();
   for( auto& ihit: hits ){
-    if( ihit.plane != plane0 ) continue; // First plane
+    if( ihit.plane == plane0 ) _tripletOuterHits0.push_back(&ihit);
+    if( ihit.plane == plane2 ) _tripletOuterHits2.push_back(&ihit);
+    if( ihit.plane == plane1 ) {
+      _tripletMiddleX.push_back(ihit.x, _tripletMiddleHits.size());
+      _tripletMiddleY.push_back(ihit.y, _tripletMiddleHits.size());
+      _tripletMiddleHits.push_back(&ihit);
+      zMin1 = std::min(zMin1, ihit.z);
+      zMax1 = std::max(zMax1, ihit.z);
+    }
+  }
+  if( _tripletMiddleHits.empty() ) return;
+  _tripletMiddleX.sort();
+  _tripletMiddleY.sort();
 
-    // get all hit is plane = plane2
-    for( auto& jhit: hits ){
-      if( jhit.plane != plane2 ) continue; // Last plane
+  // the triplet line is defined by the hits with the lowest and highest plane ID,
+  // the window search relies on plane1 being the one in between
+  bool const useWindow = plane1 > std::min(plane0, plane2) && plane1 < std::max(plane0, plane2);
 
-      double sum_res_old = -1.;
-      // get all hit is plane = plane1
-      for( auto& khit: hits ){
-	if( khit.plane != plane1 ) continue; // Middle plane
+  // safety margin for rounding in the window boundaries [mm]
+  double const margin = 1E-6;
+
+  // Cuts and histogram filling of the original exhaustive search for one candidate
+  auto processCandidate = [&](hit const & ihit, hit const & khit, hit const & jhit, double & sum_res_old) {
 
 	// Create new preliminary triplet from the three hits:
 	EUTelTripletGBLUtility::triplet new_triplet(ihit,khit,jhit);
 
-    //Create triplet slope plots
-    if(upstream == 1){
-		upstreamTripletSlopeX->fill(new_triplet.getdx()*1E3/new_triplet.getdz()); //factor 1E3 to convert from rad to mrad. To be checked
-		upstreamTripletSlopeY->fill(new_triplet.getdy()*1E3/new_triplet.getdz());
-	} else {
-		downstreamTripletSlopeX->fill(new_triplet.getdx()*1E3/new_triplet.getdz());
-		downstreamTripletSlopeY->fill(new_triplet.getdy()*1E3/new_triplet.getdz());
+	//Create triplet slope plots
+	if(monitor) {
+	  fill(slopeHistoX, slopeCounterX, new_triplet.getdx()*1E3/new_triplet.getdz()); //factor 1E3 to convert from rad to mrad. To be checked
+	  fill(slopeHistoY, slopeCounterY, new_triplet.getdy()*1E3/new_triplet.getdz());
 	}
+
 	// Setting cuts on the triplet track angle:
-	if( fabs(new_triplet.getdx()) > slope_cut * new_triplet.getdz()) continue;
-	if( fabs(new_triplet.getdy()) > slope_cut * new_triplet.getdz()) continue;
-    
-    //Create triplet residual plots
-    if(upstream == 1){
-		upstreamTripletResidualX->fill(new_triplet.getdx(plane1));
-		upstreamTripletResidualY->fill(new_triplet.getdy(plane1));
-	} else {
-		downstreamTripletResidualX->fill(new_triplet.getdx(plane1));
-		downstreamTripletResidualY->fill(new_triplet.getdy(plane1));
+	if( fabs(new_triplet.getdx()) > slope_cut * new_triplet.getdz()) return;
+	if( fabs(new_triplet.getdy()) > slope_cut * new_triplet.getdz()) return;
+
+	//Create triplet residual plots
+	if(monitor) {
+	  fill(residualHistoX, residualCounterX, new_triplet.getdx(plane1));
+	  fill(residualHistoY, residualCounterY, new_triplet.getdy(plane1));
 	}
+
 	// Setting cuts on the triplet residual on the middle plane
-	if( fabs(new_triplet.getdx(plane1)) > trip_res_cut) continue;
-	if( fabs(new_triplet.getdy(plane1)) > trip_res_cut) continue;
+	if( fabs(new_triplet.getdx(plane1)) > trip_res_cut) return;
+	if( fabs(new_triplet.getdy(plane1)) > trip_res_cut) return;
 
-    // Edo: This (best triplets) is hardcoded as false in EUTelAlignGBL. Is this really useful?
-    if(only_best_triplet) {
+	// Edo: This (best triplets) is hardcoded as false in EUTelAlignGBL. Is this really useful?
+	if(only_best_triplet) {
 		// For low threshold (high noise) and/or high occupancy, use only the triplet with the smallest sum of residuals on plane1
 		double sum_res = sqrt(new_triplet.getdx(plane1)*new_triplet.getdx(plane1) + new_triplet.getdy(plane1)*new_triplet.getdy(plane1));
 		if(sum_res < sum_res_old){
-	
+
 		  // Remove the last one since it fits worse, not if its the first
 		  found_triplets.pop_back();
 		  // The triplet is accepted, push it back:
@@ -74,14 +106,240 @@ void EUTelTripletGBLUtility::FindTriplets(std::vector<EUTelTripletGBLUtility::hi
 		  streamlog_out(DEBUG2) << new_triplet;
 		  sum_res_old = sum_res;
 		}
-	} else {	
+	} else {
 		found_triplets.emplace_back(new_triplet);
 	}
-      }//loop over hits
+  };
+
+  // get all hit is plane = plane0
+  for( auto ihit: _tripletOuterHits0 ){
+
+    // get all hit is plane = plane2
+    for( auto jhit: _tripletOuterHits2 ){
+
+      double sum_res_old = -1.;
+
+      if( !useWindow ) {
+	for( auto khit: _tripletMiddleHits ) processCandidate(*ihit, *khit, *jhit, sum_res_old);
+	continue;
+      }
+
+      // the triplet line, computed exactly as in EUTelTripletGBLUtility::triplet
+      auto& first = (plane0 < plane2) ? *ihit : *jhit;
+      auto& last = (plane0 < plane2) ? *jhit : *ihit;
+      double dx = last.x - first.x;
+      double dy = last.y - first.y;
+      double dz = last.z - first.z;
+      double baseX = 0.5*( first.x + last.x );
+      double baseY = 0.5*( first.y + last.y );
+      double baseZ = 0.5*( first.z + last.z );
+      double slopeX = dx / dz;
+      double slopeY = dy / dz;
+
+      // interpolated position range on the middle plane
+      double predX0 = baseX + slopeX * (zMin1 - baseZ);
+      double predX1 = baseX + slopeX * (zMax1 - baseZ);
+      double predY0 = baseY + slopeY * (zMin1 - baseZ);
+      double predY1 = baseY + slopeY * (zMax1 - baseZ);
+      double predXLow = std::min(predX0, predX1) - margin;
+      double predXHigh = std::max(predX0, predX1) + margin;
+      double predYLow = std::min(predY0, predY1) - margin;
+      double predYHigh = std::max(predY0, predY1) + margin;
+
+      // degenerate geometry: fall back to checking all combinations
+      if( !std::isfinite(predXLow) || !std::isfinite(predXHigh) || !std::isfinite(predYLow) || !std::isfinite(predYHigh) ) {
+	for( auto khit: _tripletMiddleHits ) processCandidate(*ihit, *khit, *jhit, sum_res_old);
+	continue;
+      }
+
+      //Create triplet slope plots, weighted with the number of middle plane hits like the exhaustive search
+      if(monitor && !_tripletMiddleHits.empty()) {
+	fill(slopeHistoX, slopeCounterX, dx*1E3/dz, _tripletMiddleHits.size()); //factor 1E3 to convert from rad to mrad. To be checked
+	fill(slopeHistoY, slopeCounterY, dy*1E3/dz, _tripletMiddleHits.size());
+      }
+
+      // Setting cuts on the triplet track angle:
+      if( fabs(dx) > slope_cut * dz) continue;
+      if( fabs(dy) > slope_cut * dz) continue;
+
+      //Create triplet residual plots for all middle plane hits, including the overflow
+      if(monitor) {
+	for( auto khit: _tripletMiddleHits ) {
+	  fill(residualHistoX, residualCounterX, khit->x - baseX - slopeX * (khit->z - baseZ));
+	  fill(residualHistoY, residualCounterY, khit->y - baseY - slopeY * (khit->z - baseZ));
+	}
+      }
+
+      // middle plane hits within the residual cut window, in their original order
+      _tripletCandidates.clear();
+      _tripletMiddleX.query(predXLow - trip_res_cut, predXHigh + trip_res_cut, [&](size_t k) {
+	_tripletCandidates.push_back(k);
+      });
+      std::sort(_tripletCandidates.begin(), _tripletCandidates.end());
+
+      for( auto k: _tripletCandidates ){
+	auto& khit = *_tripletMiddleHits[k];
+	double resX = khit.x - baseX - slopeX * (khit.z - baseZ);
+	double resY = khit.y - baseY - slopeY * (khit.z - baseZ);
+
+	// Setting cuts on the triplet residual on the middle plane
+	if( fabs(resX) > trip_res_cut) continue;
+	if( fabs(resY) > trip_res_cut) continue;
+
+	EUTelTripletGBLUtility::triplet new_triplet(*ihit,khit,*jhit);
+	if(only_best_triplet) {
+		double sum_res = sqrt(resX*resX + resY*resY);
+		if(sum_res < sum_res_old){
+		  // Remove the last one since it fits worse, not if its the first
+		  found_triplets.pop_back();
+		  found_triplets.emplace_back(new_triplet);
+		  streamlog_out(DEBUG2) << new_triplet;
+		  sum_res_old = sum_res;
+		}
+		if(sum_res_old < 0.) {
+		  found_triplets.emplace_back(new_triplet);
+		  streamlog_out(DEBUG2) << new_triplet;
+		  sum_res_old = sum_res;
+		}
+	} else {
+		found_triplets.emplace_back(new_triplet);
+	}
+      }//loop over middle plane candidates
     }//loop over hits
   }// loop over hits
+}
+
+template<typename Monitoring>
+void EUTelTripletGBLUtility::MatchTriplets(std::vector<EUTelTripletGBLUtility::triplet> const & up, std::vector<EUTelTripletGBLUtility::triplet> const & down, double z_match, double trip_matching_cut, std::vector<EUTelTripletGBLUtility::track> &tracks) {
+
+  // Cut on the matching of two triplets [mm]
+
+  // safety margin for rounding in the window boundaries [mm]
+  double const margin = 1E-6;
+
+  // Track impact positions at Matching Point from Upstream and Downstream:
+  _upstreamMatchIndex.clear();
+  for(size_t ix = 0; ix < up.size(); ++ix) {
+    _upstreamMatchIndex.push_back(up[ix].getx_at(z_match), up[ix].gety_at(z_match), ix);
+  }
+  _upstreamMatchIndex.sort();
+
+  _downstreamMatchIndex.clear();
+  for(size_t ix = 0; ix < down.size(); ++ix) {
+    _downstreamMatchIndex.push_back(down[ix].getx_at(z_match), down[ix].gety_at(z_match), ix);
+  }
+  _downstreamMatchIndex.sort();
+
+  // check if trip/drip are isolated. use at least double the trip_machting_cut for isolation in order to avoid double matching
+  _upstreamIsolated.resize(up.size());
+  for(size_t ix = 0; ix < up.size(); ++ix) {
+    _upstreamIsolated[ix] = IsTripletIsolated(ix, _upstreamMatchIndex, trip_matching_cut*2.0001);
+  }
+  _downstreamIsolated.resize(down.size());
+  for(size_t ix = 0; ix < down.size(); ++ix) {
+    _downstreamIsolated[ix] = IsTripletIsolated(ix, _downstreamMatchIndex, trip_matching_cut*2.0001);
+  }
+
+  for(size_t iup = 0; iup < up.size(); ++iup) {
+
+    double xA = _upstreamMatchIndex.x(iup); // triplet impact point at matching position
+    double yA = _upstreamMatchIndex.y(iup);
+    streamlog_out(DEBUG4) << "  Is triplet isolated? " << static_cast<bool>(_upstreamIsolated[iup]) << std::endl;
+
+    //cut plots: driplet - triplet for all driplets
+    if(std::is_same<Monitoring, histogramMonitoring>::value) {
+      for(size_t idown = 0; idown < down.size(); ++idown) {
+	tripletMatchingResidualX->fill(_downstreamMatchIndex.x(idown) - xA);
+	tripletMatchingResidualY->fill(_downstreamMatchIndex.y(idown) - yA);
+      }
+    } else if(std::is_same<Monitoring, counterMonitoring>::value) {
+      fillDistances(_tripletMatchingResidualXCounter, _downstreamMatchIndex, false, xA, 1.0);
+      fillDistances(_tripletMatchingResidualYCounter, _downstreamMatchIndex, true, yA, 1.0);
+    }
+
+    // driplets within the matching window, in their original order
+    _matchCandidates.clear();
+    _downstreamMatchIndex.queryX(xA - trip_matching_cut - margin, xA + trip_matching_cut + margin, [&](size_t idown) {
+      _matchCandidates.push_back(idown);
+    });
+    std::sort(_matchCandidates.begin(), _matchCandidates.end());
 
-  //return triplets;
+    for(auto idown: _matchCandidates) {
+
+      // driplet - triplet
+      double dx = _downstreamMatchIndex.x(idown) - xA;
+      double dy = _downstreamMatchIndex.y(idown) - yA;
+
+      // match driplet and triplet:
+      streamlog_out(DEBUG4) << "  Distance for matching x: " << fabs(dx)<< std::endl;
+      streamlog_out(DEBUG4) << "  Distance for matching y: " << fabs(dy)<< std::endl;
+      if( fabs(dx) > trip_matching_cut) continue;
+      if( fabs(dy) > trip_matching_cut) continue;
+      streamlog_out(DEBUG4) << "  Survived matching " << std::endl;
+
+      // check isolation
+      if( !_upstreamIsolated[iup] || !_downstreamIsolated[idown] ) {
+	continue;
+      }
+      streamlog_out(DEBUG4) << "  Trip and Drip isolated " << std::endl;      
+
+      // Add the track to the vector if trip/drip are isolated, the triplets are matched, and all other cuts are passed
+      tracks.emplace_back(up[iup], down[idown]);
+
+    } // Downstream
+  } // Upstream
+
+  streamlog_out(DEBUG2) << "Found " << tracks.size() << " tracks from matched triplets." << std::endl;
+  //return tracks;
+}
+
+template<typename Monitoring>
+bool EUTelTripletGBLUtility::AttachDUT(EUTelTripletGBLUtility::triplet & triplet, std::vector<EUTelTripletGBLUtility::hit> const & hits, positionIndex const & dutIndex, geo::EUTelGeometrySnapshot const & geometry, unsigned int dutID, std::vector<float> const & dist_cuts){
+
+	// safety margin for rounding in the window boundaries [mm]
+	double const margin = 1E-6;
+
+	auto zPos = geometry.getPlaneRecord(static_cast<int>(dutID)).position(2);
+	int minHitIx = -1;
+	double minDist = std::numeric_limits<float>::max();
+
+	auto trX = triplet.getx_at(zPos);
+	auto trY = triplet.gety_at(zPos);
+
+	//cut plots for all hits on the DUT
+	if(std::is_same<Monitoring, histogramMonitoring>::value) {
+		for(size_t entry = 0; entry < dutIndex.size(); ++entry) {
+			DUTMatchingResidualX->fill(trX - dutIndex.x(entry));
+			DUTMatchingResidualY->fill(trY - dutIndex.y(entry));
+		}
+	} else if(std::is_same<Monitoring, counterMonitoring>::value) {
+		fillDistances(_DUTMatchingResidualXCounter, dutIndex, false, trX, -1.0);
+		fillDistances(_DUTMatchingResidualYCounter, dutIndex, true, trY, -1.0);
+	}
+
+	//hits within the distance cut window, in their original order
+	_matchCandidates.clear();
+	dutIndex.queryX(trX - dist_cuts.at(0) - margin, trX + dist_cuts.at(0) + margin, [&](size_t entry) {
+		_matchCandidates.push_back(entry);
+	});
+	std::sort(_matchCandidates.begin(), _matchCandidates.end());
+
+	for(auto entry: _matchCandidates) {
+		auto distX = fabs(trX-dutIndex.x(entry));
+		auto distY = fabs(trY-dutIndex.y(entry));
+		double dist = distX*distX + distY*distY;
+		if(distX <= dist_cuts.at(0) && distY <= dist_cuts.at(1) && dist < minDist ){
+			minHitIx = static_cast<int>(dutIndex.ref(entry));
+			DUTHitNumber->fill(dutID);
+			minDist = dist;
+		}
+	}
+
+	if(minHitIx != -1) {
+		triplet.push_back_DUT(hits[minHitIx].plane, hits[minHitIx]);
+		return true;
+	}
+	return false;
 }
 
 }//namespace
@@ -26,10 +26,13 @@
 #include "TVectorD.h"
 
 // system includes <>
+#include <algorithm>
+#include <cstdlib>
 #include <iomanip>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <new>
 #include <vector>
 
 // Eigen
@@ -346,6 +349,46 @@ namespace eutelescope {
       /** Number of objects taken at one time */
       int _kTaken;
     };
+
+    /** @class AlignedAllocator
+     * Allocator honouring the alignment of over-aligned types, e.g. types
+     * declared alignas(64) to occupy whole cache lines. std::allocator only
+     * does so as of C++17.
+     *
+     * \b Usage:
+     * \code{.cpp}
+     *  std::vector<Record, AlignedAllocator<Record>> records;
+     * \endcode
+     */
+    template <typename T> class AlignedAllocator {
+    public:
+      typedef T value_type;
+
+      AlignedAllocator() = default;
+
+      template <typename U> AlignedAllocator(AlignedAllocator<U> const &) {}
+
+      T *allocate(size_t n) {
+        void *memory = nullptr;
+        if (posix_memalign(&memory, std::max(alignof(T), sizeof(void *)),
+                           n * sizeof(T)) != 0) {
+          throw std::bad_alloc();
+        }
+        return static_cast<T *>(memory);
+      }
+
+      void deallocate(T *p, size_t) { std::free(p); }
+    };
+
+    template <typename T, typename U>
+    bool operator==(AlignedAllocator<T> const &, AlignedAllocator<U> const &) {
+      return true;
+    }
+
+    template <typename T, typename U>
+    bool operator!=(AlignedAllocator<T> const &, AlignedAllocator<U> const &) {
+      return false;
+    }
   }
 }
 
@@ -0,0 +1,111 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelDecoderPipeline.h"
+
+// system includes <>
+#include <algorithm>
+#include <utility>
+
+using namespace eutelescope;
+
+EUTelDecoderPipeline::EUTelDecoderPipeline(size_t noOfThreads, size_t capacity,
+                                           Split split, Decode decode)
+    : _split(std::move(split)), _decode(std::move(decode)),
+      _slots(std::max<size_t>(capacity, 1)), _mutex(), _readyCondition(),
+      _freeCondition(), _nextInput(0), _nextOutput(0), _inputDone(false),
+      _splitException(), _stop(false), _threads() {
+
+  for(size_t iThread = 0; iThread < std::max<size_t>(noOfThreads, 1); ++iThread) {
+    _threads.emplace_back(&EUTelDecoderPipeline::workerLoop, this);
+  }
+}
+
+EUTelDecoderPipeline::~EUTelDecoderPipeline() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _freeCondition.notify_all();
+  for(auto &thread: _threads) {
+    thread.join();
+  }
+}
+
+void EUTelDecoderPipeline::workerLoop() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  while(true) {
+    _freeCondition.wait(lock, [this] {
+      return _stop || _inputDone || _nextInput < _nextOutput + _slots.size();
+    });
+    if(_stop || _inputDone) return;
+
+    //splitting is sequential, so it happens under the lock
+    size_t eventIndex = _nextInput;
+    EUTelMappedFile::Cursor event(nullptr, nullptr);
+    bool haveEvent = false;
+    try {
+      haveEvent = _split(event);
+    } catch(...) {
+      _splitException = std::current_exception();
+    }
+    if(!haveEvent) {
+      _inputDone = true;
+      _readyCondition.notify_all();
+      _freeCondition.notify_all();
+      return;
+    }
+    ++_nextInput;
+
+    lock.unlock();
+    std::unique_ptr<IMPL::LCEventImpl> decoded;
+    std::exception_ptr exception;
+    try {
+      decoded.reset(_decode(event, eventIndex));
+    } catch(...) {
+      exception = std::current_exception();
+    }
+    lock.lock();
+
+    auto &slot = _slots[eventIndex % _slots.size()];
+    slot.event = std::move(decoded);
+    slot.exception = exception;
+    slot.ready = true;
+    if(eventIndex == _nextOutput) _readyCondition.notify_one();
+  }
+}
+
+std::unique_ptr<IMPL::LCEventImpl> EUTelDecoderPipeline::next() {
+  std::unique_lock<std::mutex> lock(_mutex);
+  auto &slot = _slots[_nextOutput % _slots.size()];
+  _readyCondition.wait(lock, [&] {
+    return slot.ready || (_inputDone && _nextOutput == _nextInput);
+  });
+
+  if(!slot.ready) {
+    if(_splitException) {
+      auto exception = _splitException;
+      _splitException = nullptr;
+      std::rethrow_exception(exception);
+    }
+    return nullptr;
+  }
+
+  auto event = std::move(slot.event);
+  auto exception = slot.exception;
+  slot.exception = nullptr;
+  slot.ready = false;
+  ++_nextOutput;
+  lock.unlock();
+  _freeCondition.notify_one();
+
+  if(exception) std::rethrow_exception(exception);
+  return event;
+}
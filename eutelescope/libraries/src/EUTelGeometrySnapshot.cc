@@ -0,0 +1,201 @@
+// Class declaration
+#include "EUTelGeometrySnapshot.h"
+
+// C++
+#include <string>
+#include <utility>
+
+// EUTELESCOPE
+#include "EUTelExceptions.h"
+
+using namespace eutelescope;
+using namespace geo;
+
+EUTelGeometrySnapshot::EUTelGeometrySnapshot(unsigned long version, std::vector<int> const &sensorIDs,
+                                             PlaneRecordVec const &records,
+                                             std::shared_ptr<EUTelMaterialBudget const> materialBudget):
+_version(version),
+_sensorIDVec(sensorIDs),
+_records(records),
+_slots(),
+_materialBudget(std::move(materialBudget))
+{
+	for(size_t iRecord = 0; iRecord < _records.size(); iRecord++) {
+		auto sensorID = _records[iRecord].sensorID;
+		if( sensorID < 0 ) continue;
+		auto index = static_cast<size_t>(sensorID);
+		if( index >= _slots.size() ) _slots.resize(index+1, -1);
+		_slots[index] = static_cast<int>(iRecord);
+	}
+}
+
+void EUTelGeometrySnapshot::unknownSensor(int sensorID) {
+	throw InvalidGeometryException("Sensor ID " + std::to_string(sensorID) + " is not part of the geometry");
+}
+
+PlaneRecord const & EUTelGeometrySnapshot::getTransformedPlaneRecord(int sensorID) const {
+	auto const & record = getPlaneRecord(sensorID);
+	if( !record.hasTransform ) {
+		throw InvalidGeometryException("No transformation matrix for sensor " + std::to_string(sensorID) + ", TGeo geometry not initialised?");
+	}
+	return record;
+}
+
+EUTelMaterialBudget const & EUTelGeometrySnapshot::getMaterialBudget() const {
+	if( !_materialBudget ) {
+		throw InvalidGeometryException("Material budget not available, TGeo geometry not initialised");
+	}
+	return *_materialBudget;
+}
+
+/**
+ * Coordinate transformation from local reference frame of sensor with a given sensorID
+ * to the global coordinate system
+ *
+ * @param sensorID Id of the sensor (specifies local coordinate system)
+ * @param localPos (x,y,z) in local coordinate system
+ * @param globalPos (x,y,z) in global coordinate system
+ */
+void EUTelGeometrySnapshot::local2Master( int sensorID, const double localPos[], double globalPos[] ) const {
+	local2MasterBatch(sensorID, 1, localPos, globalPos);
+}
+
+/**
+ * Coordinate transformation from global reference frame to local reference frame.
+ * Corresponding volume is determined automatically.
+ *
+ * @param sensorID Id of the sensor (specifies local coordinate system)
+ * @param globalPos (x,y,z) in global coordinate system
+ * @param localPos (x,y,z) in local coordinate system
+ */
+void EUTelGeometrySnapshot::master2Local(int sensorID, const double globalPos[], double localPos[] ) const {
+	master2LocalBatch(sensorID, 1, globalPos, localPos);
+}
+
+/**
+ * Vector coordinate transformation from global reference frame to local reference frame.
+ * Corresponding volume is determined automatically.
+ *
+ * @param globalVec (x,y,z) in global coordinate system
+ * @param localVec (x,y,z) in local coordinate system
+ */
+void EUTelGeometrySnapshot::local2MasterVec( int sensorID, const double localVec[], double globalVec[] ) const {
+	auto const & m = getPlaneTransform(sensorID);
+	double const l0 = localVec[0], l1 = localVec[1], l2 = localVec[2];
+	for(size_t i = 0; i < 3; i++) {
+		globalVec[i] = l0*m[4*i] + l1*m[4*i+1] + l2*m[4*i+2];
+	}
+}
+
+/**
+ * Vector coordinate transformation from global reference frame to local reference frame.
+ * Corresponding volume is determined automatically.
+ *
+ * @param globalVec (x,y,z) in global coordinate system
+ * @param localVec (x,y,z) in local coordinate system
+ */
+void EUTelGeometrySnapshot::master2LocalVec( int sensorID, const double globalVec[], double localVec[] ) const {
+	auto const & m = getPlaneTransform(sensorID);
+	double const g0 = globalVec[0], g1 = globalVec[1], g2 = globalVec[2];
+	for(size_t i = 0; i < 3; i++) {
+		localVec[i] = g0*m[i] + g1*m[4+i] + g2*m[8+i];
+	}
+}
+
+/**
+ * Coordinate transformation of a batch of points from the local reference frame of
+ * sensor with a given sensorID to the global coordinate system. The arithmetic is the
+ * same as in TGeoMatrix::LocalToMaster.
+ *
+ * @param sensorID Id of the sensor (specifies local coordinate system)
+ * @param noOfPoints number of points to transform
+ * @param localPos (x,y,z) triples in local coordinate system
+ * @param globalPos (x,y,z) triples in global coordinate system
+ */
+void EUTelGeometrySnapshot::local2MasterBatch( int sensorID, size_t noOfPoints, const double localPos[], double globalPos[] ) const {
+	auto const & m = getPlaneTransform(sensorID);
+	for(size_t iPoint = 0; iPoint < 3*noOfPoints; iPoint += 3) {
+		double const l0 = localPos[iPoint], l1 = localPos[iPoint+1], l2 = localPos[iPoint+2];
+		globalPos[iPoint]   = m[3]  + l0*m[0] + l1*m[1] + l2*m[2];
+		globalPos[iPoint+1] = m[7]  + l0*m[4] + l1*m[5] + l2*m[6];
+		globalPos[iPoint+2] = m[11] + l0*m[8] + l1*m[9] + l2*m[10];
+	}
+}
+
+/**
+ * Coordinate transformation of a batch of points from the global reference frame to
+ * the local one of sensor with a given sensorID. The arithmetic is the same as in
+ * TGeoMatrix::MasterToLocal.
+ *
+ * @param sensorID Id of the sensor (specifies local coordinate system)
+ * @param noOfPoints number of points to transform
+ * @param globalPos (x,y,z) triples in global coordinate system
+ * @param localPos (x,y,z) triples in local coordinate system
+ */
+void EUTelGeometrySnapshot::master2LocalBatch( int sensorID, size_t noOfPoints, const double globalPos[], double localPos[] ) const {
+	auto const & m = getPlaneTransform(sensorID);
+	for(size_t iPoint = 0; iPoint < 3*noOfPoints; iPoint += 3) {
+		double const d0 = globalPos[iPoint] - m[3];
+		double const d1 = globalPos[iPoint+1] - m[7];
+		double const d2 = globalPos[iPoint+2] - m[11];
+		localPos[iPoint]   = d0*m[0] + d1*m[4] + d2*m[8];
+		localPos[iPoint+1] = d0*m[1] + d1*m[5] + d2*m[9];
+		localPos[iPoint+2] = d0*m[2] + d1*m[6] + d2*m[10];
+	}
+}
+
+void EUTelGeometrySnapshot::local2Master( int sensorID, std::array<double,3> const & localPos, std::array<double,3>& globalPos) const {
+	this->local2Master(sensorID, localPos.data(), globalPos.data());
+}
+void EUTelGeometrySnapshot::master2Local(int sensorID, std::array<double,3> const & globalPos, std::array<double,3>& localPos) const {
+	this->master2Local(sensorID, globalPos.data(), localPos.data());
+}
+void EUTelGeometrySnapshot::local2MasterVec( int sensorID, std::array<double,3> const & localVec, std::array<double,3>& globalVec) const {
+	this->local2MasterVec(sensorID, localVec.data(), globalVec.data());
+}
+void EUTelGeometrySnapshot::master2LocalVec( int sensorID, std::array<double,3> const & globalVec, std::array<double,3>& localVec) const {
+	this->master2LocalVec(sensorID, globalVec.data(), localVec.data());
+}
+
+/**
+ * Structure-of-arrays variant of local2MasterBatch. Eigen's array expressions
+ * are evaluated in packets, i.e. with SIMD instructions where available.
+ *
+ * @param sensorID Id of the sensor (specifies local coordinate system)
+ * @param noOfPoints number of points to transform
+ * @param localX, localY, localZ coordinates in local coordinate system
+ * @param globalX, globalY, globalZ coordinates in global coordinate system
+ */
+void EUTelGeometrySnapshot::local2MasterBatch( int sensorID, size_t noOfPoints,
+                                               const double localX[], const double localY[], const double localZ[],
+                                               double globalX[], double globalY[], double globalZ[] ) const {
+	auto const & m = getPlaneTransform(sensorID);
+	auto const n = static_cast<Eigen::DenseIndex>(noOfPoints);
+	Eigen::Map<const Eigen::ArrayXd> lX(localX, n), lY(localY, n), lZ(localZ, n);
+	Eigen::Map<Eigen::ArrayXd> gX(globalX, n), gY(globalY, n), gZ(globalZ, n);
+
+	gX = m[3]  + lX*m[0] + lY*m[1] + lZ*m[2];
+	gY = m[7]  + lX*m[4] + lY*m[5] + lZ*m[6];
+	gZ = m[11] + lX*m[8] + lY*m[9] + lZ*m[10];
+}
+
+/**
+ * Structure-of-arrays variant of master2LocalBatch, see above.
+ *
+ * @param sensorID Id of the sensor (specifies local coordinate system)
+ * @param noOfPoints number of points to transform
+ * @param globalX, globalY, globalZ coordinates in global coordinate system
+ * @param localX, localY, localZ coordinates in local coordinate system
+ */
+void EUTelGeometrySnapshot::master2LocalBatch( int sensorID, size_t noOfPoints,
+                                               const double globalX[], const double globalY[], const double globalZ[],
+                                               double localX[], double localY[], double localZ[] ) const {
+	auto const & m = getPlaneTransform(sensorID);
+	auto const n = static_cast<Eigen::DenseIndex>(noOfPoints);
+	Eigen::Map<const Eigen::ArrayXd> gX(globalX, n), gY(globalY, n), gZ(globalZ, n);
+	Eigen::Map<Eigen::ArrayXd> lX(localX, n), lY(localY, n), lZ(localZ, n);
+
+	lX = (gX-m[3])*m[0] + (gY-m[7])*m[4] + (gZ-m[11])*m[8];
+	lY = (gX-m[3])*m[1] + (gY-m[7])*m[5] + (gZ-m[11])*m[9];
+	lZ = (gX-m[3])*m[2] + (gY-m[7])*m[6] + (gZ-m[11])*m[10];
+}
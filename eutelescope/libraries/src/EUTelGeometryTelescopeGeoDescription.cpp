@@ -10,6 +10,8 @@
 #include <cstring>
 #include <cmath>
 #include <sstream>
+#include <tuple>
+#include <utility>
 
 // MARLIN
 #include "marlin/Global.h"
@@ -57,73 +59,16 @@ EUTelGeometryTelescopeGeoDescription& EUTelGeometryTelescopeGeoDescription::getI
 }
 
 //Note  that to determine these axis we MUST use the geometry class after initialisation. By this I mean directly from the root file create.
-Eigen::Vector3d EUTelGeometryTelescopeGeoDescription::getPlaneNormalVector( int planeID )
-{
-	auto mapIt = _planeNormalMap.find(planeID);
-	if( mapIt != _planeNormalMap.end() ) {
-		return mapIt->second;
-	} else {
-		std::vector<int>::iterator it = std::find(_sensorIDVec.begin(), _sensorIDVec.end(), planeID);
-		if( it != _sensorIDVec.end() ) {
-			std::array<double,3> const zAxisLocal {{0,0,1}};
-			std::array<double,3> zAxisGlobal; 
-			local2MasterVec(planeID, zAxisLocal, zAxisGlobal); 
-			Eigen::Vector3d normVec(zAxisGlobal.data());
-			_planeNormalMap[planeID] = normVec;
-			return normVec;
-		} else {
-			std::stringstream ss;
-			ss << planeID;
-			std::string errMsg = "EUTelGeometryTelescopeGeoDescription::getPlaneNormalVector: Could not find planeID: " + ss.str();
-			throw InvalidGeometryException(errMsg);
-		}
-	}
+Eigen::Vector3d EUTelGeometryTelescopeGeoDescription::getPlaneNormalVector( int planeID ) {
+	return currentSnapshot()->getPlaneNormalVector(planeID);
 }
 
-/**TODO: Replace me: NOP*/
 Eigen::Vector3d EUTelGeometryTelescopeGeoDescription::getPlaneXVector( int planeID ) {
-	auto mapIt = _planeXMap.find(planeID);
-	if( mapIt != _planeXMap.end() ) {
-		return mapIt->second;
-	} else {
-		std::vector<int>::iterator it = std::find(_sensorIDVec.begin(), _sensorIDVec.end(), planeID);
-		if( it != _sensorIDVec.end() ) {
-			std::array<double,3> const xAxisLocal {{1,0,0}};
-			std::array<double,3> xAxisGlobal; 
-			local2MasterVec(planeID, xAxisLocal, xAxisGlobal); 
-			Eigen::Vector3d xVec(xAxisGlobal.data());
-			_planeXMap[planeID] = xVec;
-			return xVec;
-		} else {
-			std::stringstream ss;
-			ss << planeID;
-			std::string errMsg = "EUTelGeometryTelescopeGeoDescription::getPlaneXVector: Could not find planeID: " + ss.str();
-			throw InvalidGeometryException(errMsg);
-		}
-	}
+	return currentSnapshot()->getPlaneXVector(planeID);
 }
 
-/**TODO: Replace me: NOP*/
 Eigen::Vector3d EUTelGeometryTelescopeGeoDescription::getPlaneYVector( int planeID ) {
-	auto mapIt = _planeYMap.find(planeID);
-	if( mapIt != _planeYMap.end() ) {
-		return mapIt->second;
-	} else {
-		std::vector<int>::iterator it = std::find(_sensorIDVec.begin(), _sensorIDVec.end(), planeID);
-		if( it != _sensorIDVec.end() ) {
-			std::array<double,3> const yAxisLocal {{0,1,0}};
-			std::array<double,3> yAxisGlobal; 
-			local2MasterVec(planeID, yAxisLocal, yAxisGlobal); 
-			Eigen::Vector3d yVec(yAxisGlobal.data());
-			_planeYMap[planeID] = yVec;
-			return yVec;
-		} else {
-			std::stringstream ss;
-			ss << planeID;
-			std::string errMsg = "EUTelGeometryTelescopeGeoDescription::getPlaneYVector: Could not find planeID: " + ss.str(); 
-			throw InvalidGeometryException(errMsg);
-		}
-	}
+	return currentSnapshot()->getPlaneYVector(planeID);
 }
 
 void EUTelGeometryTelescopeGeoDescription::readSiPlanesLayout() {
@@ -215,9 +160,11 @@ void EUTelGeometryTelescopeGeoDescription::readSiPlanesLayout() {
 		_telescopeLayers.push_back(std::move(thisLayer));
 	}
 
+	//the getters need a snapshot, which needs the order, thus sort on the plane descriptions
 	std::sort(_sensorIDVec.begin(), _sensorIDVec.end(), [&](int a, int b)-> bool {
-		return getPlaneZPosition(a) < getPlaneZPosition(b);
+		return _activeMap.at(a)->getPosition()(2) < _activeMap.at(b)->getPosition()(2);
 	}); 
+	publishSnapshot();
 
 	for(auto& layer: _telescopeLayers){
 		streamlog_out(MESSAGE5) << "Si Layer: " << layer->getID() << '\n';
@@ -383,9 +330,11 @@ void EUTelGeometryTelescopeGeoDescription::readTrackerPlanesLayout() {
 	}
 
 
+	//the getters need a snapshot, which needs the order, thus sort on the plane descriptions
 	std::sort(_sensorIDVec.begin(), _sensorIDVec.end(), [&](int a, int b)-> bool {
-		return getPlaneZPosition(a) < getPlaneZPosition(b);
+		return _activeMap.at(a)->getPosition()(2) < _activeMap.at(b)->getPosition()(2);
 	}); 
+	publishSnapshot();
 
 	streamlog_out(MESSAGE5) << "Sensor IDs ordered by Z: \n";
 	for(auto& ID: _sensorIDVec) {
@@ -406,6 +355,10 @@ _trackerPlanesParameters(nullptr),
 _trackerPlanesLayerLayout(nullptr),
 _sensorIDVec(),
 _isGeoInitialized(false),
+_snapshot(nullptr),
+_currentSnapshot(nullptr),
+_snapshotVersion(0),
+_materialBudget(nullptr),
 _geoManager(nullptr)
 {
 	//Set ROOTs verbosity to only display error messages or higher (so info will not be streamed to stderr)
@@ -688,9 +641,81 @@ void EUTelGeometryTelescopeGeoDescription::initializeTGeoDescription( std::strin
     	_geoManager->cd( pathName.c_str() );
 		  _TGeoMatrixMap[sensorID] = _geoManager->GetCurrentNode()->GetMatrix();
 	  } 
+    //the material budget is sampled using the transformations, thus publish them first
+    publishSnapshot();
+
+    //sample the material once, afterwards material queries do not need to step through TGeo
+    _materialBudget = std::make_shared<EUTelMaterialBudget const>(*this, EUTelMaterialBudget::Binning());
+    publishSnapshot();
     return;
 }
 
+/**
+ * Collect everything the hot getters need from the plane descriptions in _activeMap
+ * and the TGeo transformation matrices into one flat table. Avoids the map lookups
+ * and the virtual TGeoMatrix calls for every single hit. The table is wrapped into a
+ * new immutable snapshot, which replaces the current one atomically: threads holding
+ * the previous snapshot keep using it undisturbed.
+ */
+void EUTelGeometryTelescopeGeoDescription::publishSnapshot() {
+	EUTelGeometrySnapshot::PlaneRecordVec records;
+
+	for(auto& mapEntry: _activeMap) {
+		auto sensorID = mapEntry.first;
+		auto active = mapEntry.second;
+		if( sensorID < 0 || active == nullptr ) continue;
+
+		PlaneRecord record;
+		record.sensorID = sensorID;
+		record.position = active->getPosition();
+		record.rotation = active->getGlobalRotationAngles();
+		record.size = active->getSize();
+		std::tie(record.xPitch, record.yPitch) = active->getPitch();
+		std::tie(record.xNoPixels, record.yNoPixels) = active->getNoPixels();
+		std::tie(record.xResolution, record.yResolution) = active->getResolution();
+		record.radLength = active->getRadLength();
+		auto const & flip = active->getFlipMatrix();
+		record.flip = {{ flip.coeff(0, 0), flip.coeff(1, 0), flip.coeff(0, 1), flip.coeff(1, 1) }};
+
+		auto matrixIt = _TGeoMatrixMap.find(sensorID);
+		record.hasTransform = matrixIt != _TGeoMatrixMap.end() && matrixIt->second != nullptr;
+		if( record.hasTransform ) {
+			auto const rot = matrixIt->second->GetRotationMatrix();
+			auto const tr = matrixIt->second->GetTranslation();
+			for(size_t i = 0; i < 3; i++) {
+				record.transform[4*i] = rot[3*i];
+				record.transform[4*i+1] = rot[3*i+1];
+				record.transform[4*i+2] = rot[3*i+2];
+				record.transform[4*i+3] = tr[i];
+			}
+			//the local axes in the global frame are the columns of the rotation
+			auto const & m = record.transform;
+			record.xVector = Eigen::Vector3d(m[0], m[4], m[8]);
+			record.yVector = Eigen::Vector3d(m[1], m[5], m[9]);
+			record.normal = Eigen::Vector3d(m[2], m[6], m[10]);
+		} else {
+			record.transform.fill(0);
+			record.xVector.setZero();
+			record.yVector.setZero();
+			record.normal.setZero();
+		}
+
+		records.push_back(record);
+	}
+
+	auto snapshot = std::make_shared<EUTelGeometrySnapshot const>(++_snapshotVersion, _sensorIDVec, records, _materialBudget);
+	_currentSnapshot = snapshot.get();
+	std::atomic_store(&_snapshot, std::move(snapshot));
+}
+
+void EUTelGeometryTelescopeGeoDescription::noSnapshot() {
+	throw InvalidGeometryException("Geometry accessed before it was read from GEAR");
+}
+
+std::array<double, 12> const & EUTelGeometryTelescopeGeoDescription::getPlaneTransform(int sensorID) {
+	return currentSnapshot()->getPlaneTransform(sensorID);
+}
+
 Eigen::Matrix3d EUTelGeometryTelescopeGeoDescription::rotationMatrixFromAngles(int sensorID) {
 	return Utility::rotationMatrixFromAngles( static_cast<long double>(getPlaneXRotationRadians(sensorID)), 
                                             static_cast<long double>(getPlaneYRotationRadians(sensorID)), 
@@ -712,62 +737,57 @@ Eigen::Matrix3i EUTelGeometryTelescopeGeoDescription::getFlipMatrix(int sensorID
 }
 
 /**
- * Coordinate transformation from local reference frame of sensor with a given sensorID
- * to the global coordinate system
- * 
- * @param sensorID Id of the sensor (specifies local coordinate system)
- * @param localPos (x,y,z) in local coordinate system
- * @param globalPos (x,y,z) in global coordinate system
+ * Coordinate transformations between the local reference frame of the sensor with a
+ * given sensorID and the global coordinate system, see EUTelGeometrySnapshot for the
+ * details. All of them use the current snapshot.
  */
 void EUTelGeometryTelescopeGeoDescription::local2Master( int sensorID, const double localPos[], double globalPos[] ) {
-	_TGeoMatrixMap[sensorID]->LocalToMaster(localPos, globalPos);
+	currentSnapshot()->local2Master(sensorID, localPos, globalPos);
 }
 
-/**
- * Coordinate transformation from global reference frame to local reference frame.
- * Corresponding volume is determined automatically.
- * 
- * @param sensorID Id of the sensor (specifies local coordinate system)
- * @param globalPos (x,y,z) in global coordinate system
- * @param localPos (x,y,z) in local coordinate system
- */
 void EUTelGeometryTelescopeGeoDescription::master2Local(int sensorID, const double globalPos[], double localPos[] ) {
-	_TGeoMatrixMap[sensorID]->MasterToLocal(globalPos, localPos);
+	currentSnapshot()->master2Local(sensorID, globalPos, localPos);
 }
 
-/**
- * Vector coordinate transformation from global reference frame to local reference frame.
- * Corresponding volume is determined automatically.
- * 
- * @param globalVec (x,y,z) in global coordinate system
- * @param localVec (x,y,z) in local coordinate system
- */
 void EUTelGeometryTelescopeGeoDescription::local2MasterVec( int sensorID, const double localVec[], double globalVec[] ) {
-	_TGeoMatrixMap[sensorID]->LocalToMasterVect(localVec, globalVec);
+	currentSnapshot()->local2MasterVec(sensorID, localVec, globalVec);
 }
 
-/**
- * Vector coordinate transformation from global reference frame to local reference frame.
- * Corresponding volume is determined automatically.
- * 
- * @param globalVec (x,y,z) in global coordinate system
- * @param localVec (x,y,z) in local coordinate system
- */
 void EUTelGeometryTelescopeGeoDescription::master2LocalVec( int sensorID, const double globalVec[], double localVec[] ) {
-	_TGeoMatrixMap[sensorID]->MasterToLocalVect(globalVec, localVec);
+	currentSnapshot()->master2LocalVec(sensorID, globalVec, localVec);
+}
+
+void EUTelGeometryTelescopeGeoDescription::local2MasterBatch( int sensorID, size_t noOfPoints, const double localPos[], double globalPos[] ) {
+	currentSnapshot()->local2MasterBatch(sensorID, noOfPoints, localPos, globalPos);
+}
+
+void EUTelGeometryTelescopeGeoDescription::master2LocalBatch( int sensorID, size_t noOfPoints, const double globalPos[], double localPos[] ) {
+	currentSnapshot()->master2LocalBatch(sensorID, noOfPoints, globalPos, localPos);
 }
 
 void EUTelGeometryTelescopeGeoDescription::local2Master( int sensorID, std::array<double,3> const & localPos, std::array<double,3>& globalPos) {
-	this->local2Master(sensorID, localPos.data(), globalPos.data());
+	currentSnapshot()->local2Master(sensorID, localPos, globalPos);
 }
 void EUTelGeometryTelescopeGeoDescription::master2Local(int sensorID, std::array<double,3> const & globalPos, std::array<double,3>& localPos) {
-	this->master2Local(sensorID, globalPos.data(), localPos.data());
+	currentSnapshot()->master2Local(sensorID, globalPos, localPos);
 }
 void EUTelGeometryTelescopeGeoDescription::local2MasterVec( int sensorID, std::array<double,3> const & localVec, std::array<double,3>& globalVec) {
-	this->local2MasterVec(sensorID, localVec.data(), globalVec.data());
+	currentSnapshot()->local2MasterVec(sensorID, localVec, globalVec);
 }
 void EUTelGeometryTelescopeGeoDescription::master2LocalVec( int sensorID, std::array<double,3> const & globalVec, std::array<double,3>& localVec) {
-	this->master2LocalVec(sensorID, globalVec.data(), localVec.data());
+	currentSnapshot()->master2LocalVec(sensorID, globalVec, localVec);
+}
+
+void EUTelGeometryTelescopeGeoDescription::local2MasterBatch( int sensorID, size_t noOfPoints, 
+                                                              const double localX[], const double localY[], const double localZ[],
+                                                              double globalX[], double globalY[], double globalZ[] ) {
+	currentSnapshot()->local2MasterBatch(sensorID, noOfPoints, localX, localY, localZ, globalX, globalY, globalZ);
+}
+
+void EUTelGeometryTelescopeGeoDescription::master2LocalBatch( int sensorID, size_t noOfPoints, 
+                                                              const double globalX[], const double globalY[], const double globalZ[],
+                                                              double localX[], double localY[], double localZ[] ) {
+	currentSnapshot()->master2LocalBatch(sensorID, noOfPoints, globalX, globalY, globalZ, localX, localY, localZ);
 }
 
 double EUTelGeometryTelescopeGeoDescription::getRadiationLengthBetweenPoints(Eigen::Vector3d const & startPt, Eigen::Vector3d const & endPt) {
@@ -827,49 +847,21 @@ double EUTelGeometryTelescopeGeoDescription::getRadiationLengthBetweenPoints(Eig
 }
 
 double EUTelGeometryTelescopeGeoDescription::planeRadLengthGlobalIncidence(int planeID, Eigen::Vector3d incidenceDir) {
-	
-	incidenceDir.normalize();
-	double normRad;
-	
-	Eigen::Vector3d planeNormal = getPlaneNormalVector(planeID);
-	
-	std::map<int, double>::iterator mapIt = _planeRadMap.find(planeID);
-	if( mapIt != _planeRadMap.end() ) {
-		normRad = mapIt->second;
-	} else {
-		Eigen::Vector3d planePosition(getPlaneXPosition(planeID), getPlaneYPosition(planeID), getPlaneZPosition(planeID));
-
-		//We have to propagate halfway to to front and halfway back + a minor safety margin
-		Eigen::Vector3d startPoint = planePosition - 0.51*getPlaneZSize(planeID)*planeNormal;
-		Eigen::Vector3d endPoint = planePosition + 0.51*getPlaneZSize(planeID)*planeNormal;
-
-		normRad = getRadiationLengthBetweenPoints(startPoint, endPoint);
-		_planeRadMap[planeID] = normRad;
-	}
-	double scale = std::abs(incidenceDir.dot(planeNormal));
-	return normRad/scale;
+	std::array<double,3> const globalDir {{incidenceDir(0), incidenceDir(1), incidenceDir(2)}};
+	std::array<double,3> localDir;
+	master2LocalVec(planeID, globalDir, localDir);
+	return planeRadLengthLocalIncidence(planeID, Eigen::Vector3d(localDir.data()));
 }
 
 double EUTelGeometryTelescopeGeoDescription::planeRadLengthLocalIncidence(int planeID, Eigen::Vector3d incidenceDir) {
-	incidenceDir.normalize();
-	double normRad;
-
-	std::map<int, double>::iterator mapIt = _planeRadMap.find(planeID);
-	if( mapIt != _planeRadMap.end() ) {
-		normRad = mapIt->second;
-	} else {
-		Eigen::Vector3d planePosition(getPlaneXPosition(planeID), getPlaneYPosition(planeID), getPlaneZPosition(planeID));
-		Eigen::Vector3d planeNormal = getPlaneNormalVector(planeID);
-	
-		//We have to propagate halfway to to front and halfway back + a minor safety margin
-		Eigen::Vector3d startPoint = planePosition - 0.51*getPlaneZSize(planeID)*planeNormal;
-		Eigen::Vector3d endPoint = planePosition + 0.51*getPlaneZSize(planeID)*planeNormal;
+	return getMaterialBudget().planeRadLength(planeID, Eigen::Vector3d::Zero(), incidenceDir);
+}
 
-		normRad = getRadiationLengthBetweenPoints(startPoint, endPoint);
-		_planeRadMap[planeID] = normRad;
+EUTelMaterialBudget const & EUTelGeometryTelescopeGeoDescription::getMaterialBudget() const {
+	if( !_materialBudget ) {
+		throw eutelescope::InvalidGeometryException("Material budget not available, TGeo geometry not initialised");
 	}
-	double scale = std::abs(incidenceDir(2));
-	return normRad/scale;
+	return *_materialBudget;
 }
 
 void EUTelGeometryTelescopeGeoDescription::updateSiPlanesLayout() {
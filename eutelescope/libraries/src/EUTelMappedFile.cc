@@ -0,0 +1,86 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelMappedFile.h"
+
+// lcio includes <.h>
+#include <Exceptions.h>
+
+// system includes <>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace eutelescope;
+
+EUTelMappedFile::EUTelMappedFile(std::string const &fileName)
+    : _data(nullptr), _size(0), _mapped(false), _buffer() {
+
+  int fd = ::open(fileName.c_str(), O_RDONLY);
+  if(fd < 0) {
+    throw lcio::IOException("Cannot open file " + fileName);
+  }
+
+  //size of a regular file, 0 if unknown
+  size_t fileSize = 0;
+  struct stat status;
+  if(::fstat(fd, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0) {
+    auto size = static_cast<size_t>(status.st_size);
+    fileSize = size;
+    void *mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(mapping != MAP_FAILED) {
+      //the file is read front to back, let the kernel read ahead aggressively
+      ::madvise(mapping, size, MADV_SEQUENTIAL);
+      _data = static_cast<char const *>(mapping);
+      _size = size;
+      _mapped = true;
+    }
+  }
+
+  if(!_mapped) {
+    try {
+      readAll(fd, fileName, fileSize);
+    } catch(...) {
+      ::close(fd);
+      throw;
+    }
+  }
+  //the mapping stays valid after closing the descriptor
+  ::close(fd);
+}
+
+EUTelMappedFile::~EUTelMappedFile() {
+  if(_mapped) {
+    ::munmap(const_cast<char *>(_data), _size);
+  }
+}
+
+void EUTelMappedFile::readAll(int fd, std::string const &fileName, size_t sizeHint) {
+  size_t const blockSize = 16 << 20;
+  size_t size = 0;
+  //with a known size the buffer is allocated once, otherwise it grows as the data arrives
+  _buffer.reserve(sizeHint + blockSize);
+  while(true) {
+    if(_buffer.size() < size + blockSize) _buffer.resize(size + blockSize);
+    auto noOfBytes = ::read(fd, _buffer.data() + size, blockSize);
+    if(noOfBytes < 0) {
+      if(errno == EINTR) continue;
+      throw lcio::IOException("Cannot read file " + fileName);
+    }
+    if(noOfBytes == 0) break;
+    size += static_cast<size_t>(noOfBytes);
+  }
+  //no shrink_to_fit, it would copy the whole buffer once more
+  _buffer.resize(size);
+  _data = _buffer.data();
+  _size = size;
+}
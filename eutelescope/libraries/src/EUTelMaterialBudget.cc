@@ -0,0 +1,223 @@
+// Class declaration
+#include "EUTelMaterialBudget.h"
+
+// C++
+#include <cmath>
+#include <string>
+
+// EUTELESCOPE
+#include "EUTelExceptions.h"
+#include "EUTelGeometryTelescopeGeoDescription.h"
+
+using namespace eutelescope;
+using namespace geo;
+
+namespace {
+	/** Position of the grid node iNode out of noOfNodes spanning [-half, half] */
+	double nodePosition(size_t iNode, size_t noOfNodes, double half) {
+		if( noOfNodes < 2 ) return 0;
+		double const fraction = static_cast<double>(iNode)/static_cast<double>(noOfNodes-1);
+		return -half + 2*half*fraction;
+	}
+
+	/** Lower grid node of value and its distance to it in units of the node spacing
+	 *  Values outside [-half, half] are clamped to the border
+	 */
+	void gridCoordinate(double value, double half, size_t noOfNodes, size_t &node, double &fraction) {
+		node = 0;
+		fraction = 0;
+		if( noOfNodes < 2 || !(half > 0) ) return;
+
+		double const last = static_cast<double>(noOfNodes-1);
+		double u = (value+half)/(2*half)*last;
+		//also catches NaN
+		if( !(u > 0) ) return;
+		if( u >= last ) {
+			node = noOfNodes-2;
+			fraction = 1;
+			return;
+		}
+		node = static_cast<size_t>(u);
+		fraction = u - static_cast<double>(node);
+	}
+
+	Eigen::Vector3d local2Master(std::array<double, 12> const & m, Eigen::Vector3d const & l) {
+		return Eigen::Vector3d( m[3]  + l(0)*m[0] + l(1)*m[1] + l(2)*m[2],
+		                        m[7]  + l(0)*m[4] + l(1)*m[5] + l(2)*m[6],
+		                        m[11] + l(0)*m[8] + l(1)*m[9] + l(2)*m[10] );
+	}
+
+	Eigen::Vector3d local2MasterVec(std::array<double, 12> const & m, Eigen::Vector3d const & l) {
+		return Eigen::Vector3d( l(0)*m[0] + l(1)*m[1] + l(2)*m[2],
+		                        l(0)*m[4] + l(1)*m[5] + l(2)*m[6],
+		                        l(0)*m[8] + l(1)*m[9] + l(2)*m[10] );
+	}
+
+	Eigen::Vector3d master2LocalVec(std::array<double, 12> const & m, Eigen::Vector3d const & g) {
+		return Eigen::Vector3d( g(0)*m[0] + g(1)*m[4] + g(2)*m[8],
+		                        g(0)*m[1] + g(1)*m[5] + g(2)*m[9],
+		                        g(0)*m[2] + g(1)*m[6] + g(2)*m[10] );
+	}
+
+	Eigen::Vector3d master2Local(std::array<double, 12> const & m, Eigen::Vector3d const & g) {
+		return master2LocalVec(m, g - Eigen::Vector3d(m[3], m[7], m[11]));
+	}
+}
+
+EUTelMaterialBudget::EUTelMaterialBudget(EUTelGeometryTelescopeGeoDescription &geo, Binning const &binning):
+_binning(binning),
+_tables(),
+_tableSlots()
+{
+	if( _binning.noOfPositionNodes < 1 || _binning.noOfSlopeNodes < 1 || !(_binning.maxSlope >= 0) ) {
+		throw InvalidParameterException("EUTelMaterialBudget: the binning needs at least one node per axis and a non-negative slope range");
+	}
+
+	for(auto sensorID: geo.sensorIDsVec()) {
+		PlaneTable table;
+		table.sensorID = sensorID;
+		table.transform = geo.getPlaneTransform(sensorID);
+		table.halfSizeX = geo.getPlaneXSize(sensorID)/2.;
+		table.halfSizeY = geo.getPlaneYSize(sensorID)/2.;
+		//We have to propagate halfway to to front and halfway back + a minor safety margin
+		table.halfThickness = 0.51*geo.getPlaneZSize(sensorID);
+
+		auto index = static_cast<size_t>(sensorID);
+		if( index >= _tableSlots.size() ) _tableSlots.resize(index+1, -1);
+		_tableSlots[index] = static_cast<int>(_tables.size());
+		_tables.push_back(table);
+	}
+
+	size_t const nPos = _binning.noOfPositionNodes;
+	size_t const nSlope = _binning.noOfSlopeNodes;
+	size_t const noOfNodes = nPos*nPos*nSlope*nSlope;
+
+	for(size_t iTable = 0; iTable < _tables.size(); iTable++) {
+		auto & table = _tables[iTable];
+		bool const hasGap = iTable+1 < _tables.size();
+		table.plane.resize(noOfNodes);
+		if( hasGap ) table.gap.resize(noOfNodes);
+
+		for(size_t ix = 0; ix < nPos; ix++) {
+			for(size_t iy = 0; iy < nPos; iy++) {
+				Eigen::Vector3d const pos( nodePosition(ix, nPos, table.halfSizeX), nodePosition(iy, nPos, table.halfSizeY), 0 );
+				for(size_t itx = 0; itx < nSlope; itx++) {
+					for(size_t ity = 0; ity < nSlope; ity++) {
+						Eigen::Vector3d dir( nodePosition(itx, nSlope, _binning.maxSlope), nodePosition(ity, nSlope, _binning.maxSlope), 1 );
+						dir.normalize();
+						double const cosTheta = dir(2);
+						double const halfPath = table.halfThickness/cosTheta;
+						auto const node = gridIndex(ix, iy, itx, ity);
+
+						Eigen::Vector3d const entry = pos - halfPath*dir;
+						Eigen::Vector3d const exit = pos + halfPath*dir;
+						table.plane[node] = geo.getRadiationLengthBetweenPoints(local2Master(table.transform, entry),
+						                                                        local2Master(table.transform, exit))*cosTheta;
+						if( !hasGap ) continue;
+
+						//the track leaves the plane downstream, whichever way the local z-axis points
+						Eigen::Vector3d const gapDir = local2MasterVec(table.transform, dir)(2) < 0 ? Eigen::Vector3d(-dir) : dir;
+						double const length = gapLength(iTable, pos, gapDir);
+						if( length > 0 ) {
+							Eigen::Vector3d const start = pos + halfPath*gapDir;
+							Eigen::Vector3d const end = start + length*gapDir;
+							table.gap[node] = geo.getRadiationLengthBetweenPoints(local2Master(table.transform, start),
+							                                                      local2Master(table.transform, end))/length;
+						} else {
+							table.gap[node] = 0;
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+EUTelMaterialBudget::PlaneTable const & EUTelMaterialBudget::getTable(int sensorID) const {
+	auto index = static_cast<size_t>(sensorID);
+	if( sensorID < 0 || index >= _tableSlots.size() || _tableSlots[index] < 0 ) {
+		throw InvalidGeometryException("EUTelMaterialBudget: no material table for sensor " + std::to_string(sensorID));
+	}
+	return _tables[static_cast<size_t>(_tableSlots[index])];
+}
+
+double EUTelMaterialBudget::interpolate(PlaneTable const &table, std::vector<double> const &values,
+                                        double x, double y, double tx, double ty) const {
+	std::array<size_t, 4> node;
+	std::array<double, 4> fraction;
+	gridCoordinate(x, table.halfSizeX, _binning.noOfPositionNodes, node[0], fraction[0]);
+	gridCoordinate(y, table.halfSizeY, _binning.noOfPositionNodes, node[1], fraction[1]);
+	gridCoordinate(tx, _binning.maxSlope, _binning.noOfSlopeNodes, node[2], fraction[2]);
+	gridCoordinate(ty, _binning.maxSlope, _binning.noOfSlopeNodes, node[3], fraction[3]);
+
+	//sum over the 16 corners of the cell, corners with zero weight may lie outside the grid
+	double result = 0;
+	for(size_t cx = 0; cx < 2; cx++) {
+		double const wx = cx ? fraction[0] : 1-fraction[0];
+		if( wx == 0 ) continue;
+		for(size_t cy = 0; cy < 2; cy++) {
+			double const wy = cy ? fraction[1] : 1-fraction[1];
+			if( wy == 0 ) continue;
+			for(size_t ctx = 0; ctx < 2; ctx++) {
+				double const wtx = ctx ? fraction[2] : 1-fraction[2];
+				if( wtx == 0 ) continue;
+				for(size_t cty = 0; cty < 2; cty++) {
+					double const wty = cty ? fraction[3] : 1-fraction[3];
+					if( wty == 0 ) continue;
+					result += wx*wy*wtx*wty*values[gridIndex(node[0]+cx, node[1]+cy, node[2]+ctx, node[3]+cty)];
+				}
+			}
+		}
+	}
+	return result;
+}
+
+double EUTelMaterialBudget::gapLength(size_t index, Eigen::Vector3d const &localPos, Eigen::Vector3d const &localDir) const {
+	auto const & table = _tables[index];
+	auto const & next = _tables[index+1];
+
+	Eigen::Vector3d const dir = localDir.normalized();
+	double const cosTheta = std::abs(dir(2));
+	if( !(cosTheta > 0) ) return 0;
+
+	Eigen::Vector3d const exit = local2Master(table.transform, localPos + table.halfThickness/cosTheta*dir);
+	Eigen::Vector3d const globalDir = local2MasterVec(table.transform, dir);
+
+	auto const & m = next.transform;
+	Eigen::Vector3d const nextNormal(m[2], m[6], m[10]);
+	Eigen::Vector3d const nextCentre(m[3], m[7], m[11]);
+	double const cosNext = nextNormal.dot(globalDir);
+	if( std::abs(cosNext) < 1E-9 ) return 0;
+
+	return nextNormal.dot(nextCentre - exit)/cosNext - next.halfThickness/std::abs(cosNext);
+}
+
+double EUTelMaterialBudget::planeRadLength(int sensorID, Eigen::Vector3d const &localPos, Eigen::Vector3d const &localDir) const {
+	auto const & table = getTable(sensorID);
+	Eigen::Vector3d const dir = localDir.normalized();
+	//lines are symmetric under reversal, thus the sign of dir(2) does not matter for the slopes
+	return interpolate(table, table.plane, localPos(0), localPos(1), dir(0)/dir(2), dir(1)/dir(2))/std::abs(dir(2));
+}
+
+double EUTelMaterialBudget::planeRadLengthGlobal(int sensorID, Eigen::Vector3d const &globalPos, Eigen::Vector3d const &globalDir) const {
+	auto const & m = getTable(sensorID).transform;
+	return planeRadLength(sensorID, master2Local(m, globalPos), master2LocalVec(m, globalDir));
+}
+
+double EUTelMaterialBudget::gapRadLength(int sensorID, Eigen::Vector3d const &localPos, Eigen::Vector3d const &localDir) const {
+	auto const & table = getTable(sensorID);
+	auto const index = static_cast<size_t>(_tableSlots[static_cast<size_t>(sensorID)]);
+	if( table.gap.empty() ) return 0;
+
+	//as for the tables: the track leaves the plane downstream, whichever way the direction points
+	Eigen::Vector3d const dir = local2MasterVec(table.transform, localDir)(2) < 0 ? Eigen::Vector3d(-localDir.normalized()) : localDir.normalized();
+	double const length = gapLength(index, localPos, dir);
+	if( !(length > 0) ) return 0;
+
+	return interpolate(table, table.gap, localPos(0), localPos(1), dir(0)/dir(2), dir(1)/dir(2))*length;
+}
+
+double EUTelMaterialBudget::gapRadLengthGlobal(int sensorID, Eigen::Vector3d const &globalPos, Eigen::Vector3d const &globalDir) const {
+	auto const & m = getTable(sensorID).transform;
+	return gapRadLength(sensorID, master2Local(m, globalPos), master2LocalVec(m, globalDir));
+}
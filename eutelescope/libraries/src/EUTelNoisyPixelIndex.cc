@@ -0,0 +1,180 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelNoisyPixelIndex.h"
+#include "EUTELESCOPE.h"
+#include "EUTelSparseDataView.h"
+
+// lcio includes <.h>
+#include <IMPL/LCCollectionVec.h>
+#include <IMPL/TrackerDataImpl.h>
+#include <UTIL/CellIDDecoder.h>
+
+// system includes <>
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <utility>
+
+using namespace eutelescope;
+
+EUTelNoisyPixelIndex::SensorMask::SensorMask()
+    : _offX(0), _offY(0), _sizeX(0), _sizeY(0), _bits(), _noOfPixels(0) {}
+
+EUTelNoisyPixelIndex::SensorMask::SensorMask(
+    std::vector<std::array<int, 2>> const &pixels)
+    : SensorMask() {
+  if(pixels.empty()) return;
+
+  //the bounding box of the noisy pixels
+  std::int64_t maxX = std::numeric_limits<std::int64_t>::lowest();
+  std::int64_t maxY = std::numeric_limits<std::int64_t>::lowest();
+  _offX = std::numeric_limits<std::int64_t>::max();
+  _offY = std::numeric_limits<std::int64_t>::max();
+  for(auto const &pixel : pixels) {
+    _offX = std::min<std::int64_t>(_offX, pixel[0]);
+    _offY = std::min<std::int64_t>(_offY, pixel[1]);
+    maxX = std::max<std::int64_t>(maxX, pixel[0]);
+    maxY = std::max<std::int64_t>(maxY, pixel[1]);
+  }
+  _sizeX = static_cast<std::uint64_t>(maxX - _offX + 1);
+  _sizeY = static_cast<std::uint64_t>(maxY - _offY + 1);
+  _bits.assign((_sizeX * _sizeY + 63) / 64, 0);
+
+  for(auto const &pixel : pixels) {
+    auto bit = static_cast<std::uint64_t>(pixel[0] - _offX) * _sizeY +
+               static_cast<std::uint64_t>(pixel[1] - _offY);
+    auto &word = _bits[bit >> 6];
+    auto const flag = std::uint64_t(1) << (bit & 63);
+    if(!(word & flag)) ++_noOfPixels;
+    word |= flag;
+  }
+}
+
+bool EUTelNoisyPixelIndex::SensorMask::containsNoisyPixel(
+    IMPL::TrackerDataImpl const *data, SparsePixelType type) const {
+  bool noisy = false;
+  visitSparseData(data, type, [&](auto const &pixels) {
+    for(auto const &pixel : pixels) {
+      if(isNoisy(pixel.getXCoord(), pixel.getYCoord())) {
+        noisy = true;
+        break;
+      }
+    }
+  });
+  return noisy;
+}
+
+EUTelNoisyPixelIndex::EUTelNoisyPixelIndex() : _sensorMasks() {}
+
+EUTelNoisyPixelIndex::EUTelNoisyPixelIndex(
+    std::map<int, std::vector<std::array<int, 2>>> const &pixels)
+    : EUTelNoisyPixelIndex() {
+  for(auto const &sensorPixels : pixels) {
+    if(sensorPixels.first < 0) {
+      streamlog_out(ERROR5) << "Noisy pixels on invalid sensor ID "
+                            << sensorPixels.first << " are ignored"
+                            << std::endl;
+      continue;
+    }
+    auto slot = static_cast<size_t>(sensorPixels.first);
+    if(slot >= _sensorMasks.size()) _sensorMasks.resize(slot + 1);
+    _sensorMasks[slot] = SensorMask(sensorPixels.second);
+  }
+}
+
+EUTelNoisyPixelIndex
+EUTelNoisyPixelIndex::read(EVENT::LCEvent *event,
+                           std::string const &collectionName) {
+
+  IMPL::LCCollectionVec *noisyPixelCollectionVec = nullptr;
+  try {
+    noisyPixelCollectionVec = static_cast<IMPL::LCCollectionVec *>(
+        event->getCollection(collectionName));
+  } catch(...) {
+    if(!collectionName.empty()) {
+      streamlog_out(WARNING1) << "noisyPixelCollectionName "
+                              << collectionName.c_str() << " not found"
+                              << std::endl;
+      streamlog_out(WARNING1)
+          << "READ CAREFULLY: This means that no noisy pixels will be "
+             "removed, despite the processor successfully running!"
+          << std::endl;
+    }
+    return EUTelNoisyPixelIndex();
+  }
+
+  UTIL::CellIDDecoder<IMPL::TrackerDataImpl> cellDecoder(noisyPixelCollectionVec);
+  std::map<int, std::vector<std::array<int, 2>>> pixels;
+
+  for(int i = 0; i < noisyPixelCollectionVec->getNumberOfElements(); i++) {
+    auto noisyPixelData = dynamic_cast<IMPL::TrackerDataImpl *>(
+        noisyPixelCollectionVec->getElementAt(i));
+    int sensorID = static_cast<int>(cellDecoder(noisyPixelData)["sensorID"]);
+    int pixelType = static_cast<int>(cellDecoder(noisyPixelData)["sparsePixelType"]);
+
+    auto &sensorPixels = pixels[sensorID];
+    if(pixelType == kEUTelGenericSparsePixel) {
+      EUTelSparseDataView<EUTelGenericSparsePixel> pixelView(noisyPixelData);
+      for(auto const &pixel : pixelView) {
+        sensorPixels.push_back({{pixel.getXCoord(), pixel.getYCoord()}});
+      }
+    } else {
+      streamlog_out(ERROR5)
+          << "The noisy pixel collection is corrupted, it does not contain "
+             "the right pixel type. Something is wrong!"
+          << std::endl;
+    }
+  }
+
+  EUTelNoisyPixelIndex index(pixels);
+  for(auto const &sensorPixels : pixels) {
+    auto mask = index.getSensorMask(sensorPixels.first);
+    streamlog_out(MESSAGE5) << "Read in " << (mask ? mask->size() : 0)
+                            << " noisy pixels on plane " << sensorPixels.first
+                            << std::endl;
+  }
+  return index;
+}
+
+std::shared_ptr<EUTelNoisyPixelIndex const>
+EUTelNoisyPixelIndex::getShared(EVENT::LCEvent *event,
+                                std::string const &collectionName) {
+  static std::mutex mutex;
+  static std::map<std::pair<int, std::string>,
+                  std::shared_ptr<EUTelNoisyPixelIndex const>> indices;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  int const run = event->getRunNumber();
+  auto key = std::make_pair(run, collectionName);
+  auto found = indices.find(key);
+  if(found != indices.end()) return found->second;
+
+  auto index = std::make_shared<EUTelNoisyPixelIndex const>(read(event, collectionName));
+
+  //a missing or empty collection is not kept, a later event may provide it
+  if(!index->getSensorIDs().empty()) {
+    //the indices of previous runs are not needed anymore
+    for(auto it = indices.begin(); it != indices.end();) {
+      if(it->first.first != run) it = indices.erase(it);
+      else ++it;
+    }
+    indices.emplace(key, index);
+  }
+  return index;
+}
+
+std::vector<int> EUTelNoisyPixelIndex::getSensorIDs() const {
+  std::vector<int> sensorIDs;
+  for(size_t slot = 0; slot < _sensorMasks.size(); ++slot) {
+    if(!_sensorMasks[slot].empty()) sensorIDs.push_back(static_cast<int>(slot));
+  }
+  return sensorIDs;
+}
@@ -0,0 +1,145 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelSparseClusterFinder.h"
+
+// system includes <>
+#include <algorithm>
+#include <cmath>
+
+using namespace eutelescope;
+
+namespace {
+  //! Largest integer whose square does not exceed value (value >= 0)
+  int integerSqrt(int value) {
+    int root = static_cast<int>(std::sqrt(static_cast<double>(value)));
+    while(root > 0 && root * root > value) --root;
+    while((root + 1) * (root + 1) <= value) ++root;
+    return root;
+  }
+}
+
+EUTelSparseClusterFinder::EUTelSparseClusterFinder()
+    : _xCoord(), _yCoord(), _sortedPixels(), _columns(), _columnOffsets(),
+      _assigned(), _neighbours(), _clusterPixels(), _clusterOffsets() {}
+
+void EUTelSparseClusterFinder::clear() {
+  _xCoord.clear();
+  _yCoord.clear();
+  _clusterPixels.clear();
+  _clusterOffsets.clear();
+}
+
+void EUTelSparseClusterFinder::reserve(size_t noOfPixels) {
+  _xCoord.reserve(noOfPixels);
+  _yCoord.reserve(noOfPixels);
+  _sortedPixels.reserve(noOfPixels);
+  _assigned.reserve(noOfPixels);
+  _clusterPixels.reserve(noOfPixels);
+}
+
+void EUTelSparseClusterFinder::buildColumnIndex() {
+  auto const noOfPixels = _xCoord.size();
+
+  _sortedPixels.resize(noOfPixels);
+  for(size_t iPixel = 0; iPixel < noOfPixels; ++iPixel) {
+    _sortedPixels[iPixel] = iPixel;
+  }
+  //ties are resolved by the input order, which is the order neighbours
+  //have to be added in
+  std::sort(_sortedPixels.begin(), _sortedPixels.end(),
+            [this](size_t a, size_t b) {
+              if(_xCoord[a] != _xCoord[b]) return _xCoord[a] < _xCoord[b];
+              if(_yCoord[a] != _yCoord[b]) return _yCoord[a] < _yCoord[b];
+              return a < b;
+            });
+
+  _columns.clear();
+  _columnOffsets.clear();
+  for(size_t iSorted = 0; iSorted < noOfPixels; ++iSorted) {
+    auto x = _xCoord[_sortedPixels[iSorted]];
+    if(_columns.empty() || _columns.back() != x) {
+      _columns.push_back(x);
+      _columnOffsets.push_back(iSorted);
+    }
+  }
+  _columnOffsets.push_back(noOfPixels);
+}
+
+void EUTelSparseClusterFinder::collectNeighbours(size_t iPixel,
+                                                 int minDistanceSquared,
+                                                 int maxDeltaX) {
+  _neighbours.clear();
+
+  auto const x = _xCoord[iPixel];
+  auto const y = _yCoord[iPixel];
+
+  //first occupied column within reach
+  auto column = std::lower_bound(_columns.begin(), _columns.end(), x - maxDeltaX);
+  for(; column != _columns.end() && *column <= x + maxDeltaX; ++column) {
+    auto const dX = *column - x;
+    auto const maxDeltaY = integerSqrt(minDistanceSquared - dX * dX);
+
+    auto const iColumn = static_cast<size_t>(column - _columns.begin());
+    auto const first = _sortedPixels.begin() + _columnOffsets[iColumn];
+    auto const last = _sortedPixels.begin() + _columnOffsets[iColumn + 1];
+
+    //pixels within the column are sorted by y
+    auto candidate = std::lower_bound(first, last, y - maxDeltaY,
+                                      [this](size_t pixel, int value) {
+                                        return _yCoord[pixel] < value;
+                                      });
+    for(; candidate != last && _yCoord[*candidate] <= y + maxDeltaY; ++candidate) {
+      if(!_assigned[*candidate]) {
+        _assigned[*candidate] = 1;
+        _neighbours.push_back(*candidate);
+      }
+    }
+  }
+
+  //keep the input order among the neighbours of one pixel
+  std::sort(_neighbours.begin(), _neighbours.end());
+}
+
+size_t EUTelSparseClusterFinder::findClusters(int minDistanceSquared) {
+  auto const noOfPixels = _xCoord.size();
+
+  _clusterPixels.clear();
+  _clusterOffsets.clear();
+  _clusterOffsets.push_back(0);
+
+  //with a negative cut not even identical indices are neighbours
+  if(minDistanceSquared < 0) {
+    for(size_t iPixel = 0; iPixel < noOfPixels; ++iPixel) {
+      _clusterPixels.push_back(iPixel);
+      _clusterOffsets.push_back(_clusterPixels.size());
+    }
+    return getNumberOfClusters();
+  }
+
+  buildColumnIndex();
+  _assigned.assign(noOfPixels, 0);
+  auto const maxDeltaX = integerSqrt(minDistanceSquared);
+
+  for(size_t iSeed = 0; iSeed < noOfPixels; ++iSeed) {
+    if(_assigned[iSeed]) continue;
+
+    _assigned[iSeed] = 1;
+    _clusterPixels.push_back(iSeed);
+
+    //the cluster pixel list itself serves as the breadth first queue
+    for(size_t iNext = _clusterOffsets.back(); iNext < _clusterPixels.size(); ++iNext) {
+      collectNeighbours(_clusterPixels[iNext], minDistanceSquared, maxDeltaX);
+      _clusterPixels.insert(_clusterPixels.end(), _neighbours.begin(), _neighbours.end());
+    }
+    _clusterOffsets.push_back(_clusterPixels.size());
+  }
+  return getNumberOfClusters();
+}
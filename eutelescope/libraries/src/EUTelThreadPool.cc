@@ -0,0 +1,100 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTelThreadPool.h"
+
+using namespace eutelescope;
+
+EUTelThreadPool::EUTelThreadPool(size_t noOfWorkers)
+    : _threads(), _mutex(), _startCondition(), _doneCondition(),
+      _task(nullptr), _noOfTasks(0), _nextTask(0), _activeThreads(0),
+      _generation(0), _stop(false), _exception() {
+
+  //worker 0 is the calling thread
+  for(size_t iWorker = 1; iWorker < noOfWorkers; ++iWorker) {
+    _threads.emplace_back(&EUTelThreadPool::workerLoop, this, iWorker);
+  }
+}
+
+EUTelThreadPool::~EUTelThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _startCondition.notify_all();
+  for(auto& thread: _threads) {
+    thread.join();
+  }
+}
+
+void EUTelThreadPool::execute(size_t iWorker) {
+  size_t iTask;
+  while((iTask = _nextTask.fetch_add(1)) < _noOfTasks) {
+    try {
+      (*_task)(iTask, iWorker);
+    } catch(...) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if(!_exception) _exception = std::current_exception();
+    }
+  }
+}
+
+void EUTelThreadPool::workerLoop(size_t iWorker) {
+  unsigned long seenGeneration = 0;
+  while(true) {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _startCondition.wait(lock, [&] { return _stop || _generation != seenGeneration; });
+      if(_stop) return;
+      seenGeneration = _generation;
+    }
+
+    execute(iWorker);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if(--_activeThreads == 0) _doneCondition.notify_all();
+  }
+}
+
+void EUTelThreadPool::run(size_t noOfTasks, Task const &task) {
+  if(noOfTasks == 0) return;
+
+  //nothing to share, avoid the synchronisation overhead
+  if(_threads.empty() || noOfTasks == 1) {
+    for(size_t iTask = 0; iTask < noOfTasks; ++iTask) {
+      task(iTask, 0);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _task = &task;
+    _noOfTasks = noOfTasks;
+    _nextTask = 0;
+    _activeThreads = _threads.size();
+    _exception = nullptr;
+    ++_generation;
+  }
+  _startCondition.notify_all();
+
+  execute(0);
+
+  std::exception_ptr exception;
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _doneCondition.wait(lock, [this] { return _activeThreads == 0; });
+    _task = nullptr;
+    _noOfTasks = 0;
+    exception = _exception;
+    _exception = nullptr;
+  }
+  if(exception) std::rethrow_exception(exception);
+}
@@ -44,7 +44,20 @@ using namespace eutelescope;
 using namespace marlin;
 
 
-EUTelTripletGBLUtility::EUTelTripletGBLUtility(){}
+EUTelTripletGBLUtility::EUTelTripletGBLUtility() : _tripletOuterHits0(), _tripletOuterHits2(), _tripletMiddleHits(), _tripletMiddleX(), _tripletMiddleY(), _tripletCandidates(), _upstreamMatchIndex(), _downstreamMatchIndex(), _upstreamIsolated(), _downstreamIsolated(), _matchCandidates(), _upstreamSlopeXCounter(), _upstreamSlopeYCounter(), _downstreamSlopeXCounter(), _downstreamSlopeYCounter(), _upstreamResidualXCounter(), _upstreamResidualYCounter(), _downstreamResidualXCounter(), _downstreamResidualYCounter(), _tripletMatchingResidualXCounter(), _tripletMatchingResidualYCounter(), _DUTMatchingResidualXCounter(), _DUTMatchingResidualYCounter() {}
+
+void EUTelTripletGBLUtility::binnedCounter::flush(AIDA::IHistogram1D * histo) {
+  double width = (_high - _low)/_bins;
+  for(size_t bin = 0; bin < _counts.size(); ++bin) {
+    if(_counts[bin] == 0) continue;
+    // under- and overflow are filled just outside the axis range
+    double value = _low - 0.5*width;
+    if(bin > static_cast<size_t>(_bins)) value = _high + 0.5*width;
+    else if(bin > 0) value = _low + (static_cast<double>(bin) - 0.5)*width;
+    histo->fill(value, static_cast<double>(_counts[bin]));
+    _counts[bin] = 0;
+  }
+}
 
 Eigen::Matrix<double, 5,5> EUTelTripletGBLUtility::JacobianPointToPoint( double ds ) {
   /* for GBL:
@@ -102,65 +115,85 @@ void EUTelTripletGBLUtility::bookHistos(){
   DUTHitNumber = AIDAProcessor::histogramFactory(parent)->createHistogram1D( "Cuts/DUTHitNumber", 21, -0.5, 20.5 ); //binning to be reviewed
   DUTHitNumber->setTitle( "Number of Hits matched to a track per DUT ID;DUT ID;Number of Hits matched to a track" );
 
+  //counters for counterMonitoring, same binning as the histograms
+  auto counterFor = [](AIDA::IHistogram1D * histo) {
+    return binnedCounter(histo->axis().bins(), histo->axis().lowerEdge(), histo->axis().upperEdge());
+  };
+  _upstreamSlopeXCounter = counterFor(upstreamTripletSlopeX);
+  _upstreamSlopeYCounter = counterFor(upstreamTripletSlopeY);
+  _downstreamSlopeXCounter = counterFor(downstreamTripletSlopeX);
+  _downstreamSlopeYCounter = counterFor(downstreamTripletSlopeY);
+  _upstreamResidualXCounter = counterFor(upstreamTripletResidualX);
+  _upstreamResidualYCounter = counterFor(upstreamTripletResidualY);
+  _downstreamResidualXCounter = counterFor(downstreamTripletResidualX);
+  _downstreamResidualYCounter = counterFor(downstreamTripletResidualY);
+  _tripletMatchingResidualXCounter = counterFor(tripletMatchingResidualX);
+  _tripletMatchingResidualYCounter = counterFor(tripletMatchingResidualY);
+  _DUTMatchingResidualXCounter = counterFor(DUTMatchingResidualX);
+  _DUTMatchingResidualYCounter = counterFor(DUTMatchingResidualY);
 }
 
-void EUTelTripletGBLUtility::MatchTriplets(std::vector<triplet> const & up, std::vector<EUTelTripletGBLUtility::triplet> const & down, double z_match, double trip_matching_cut, std::vector<EUTelTripletGBLUtility::track> &tracks) {
-
-  // Cut on the matching of two triplets [mm]
-
-  for( auto& trip: up ){
-
-    // Track impact position at Matching Point from Upstream:
-    double xA = trip.getx_at(z_match); // triplet impact point at matching position
-    double yA = trip.gety_at(z_match);
-
-    // check if trip is isolated. use at least double the trip_machting_cut for isolation in order to avoid double matching
-    bool IsolatedTrip = IsTripletIsolated(trip, up, z_match, trip_matching_cut*2.0001);
-    streamlog_out(DEBUG4) << "  Is triplet isolated? " << IsolatedTrip << std::endl;
-
-    for( auto& drip: down ){
-
-      // Track impact position at Matching Point from Downstream:
-      double xB = drip.getx_at(z_match); // triplet impact point at matching position
-      double yB = drip.gety_at(z_match);
-
-      // check if drip is isolated
-      bool IsolatedDrip = IsTripletIsolated(drip, down, z_match, trip_matching_cut*2.0001);
-      streamlog_out(DEBUG4) << "  Is driplet isolated? " << IsolatedDrip << std::endl;
-
-
-      // Build a track candidate from one upstream and one downstream triplet:
-      EUTelTripletGBLUtility::track newtrack(trip,drip);
-
-      // driplet - triplet
-      double dx = xB - xA; 
-      double dy = yB - yA;
+void EUTelTripletGBLUtility::flushHistos() {
+  _upstreamSlopeXCounter.flush(upstreamTripletSlopeX);
+  _upstreamSlopeYCounter.flush(upstreamTripletSlopeY);
+  _downstreamSlopeXCounter.flush(downstreamTripletSlopeX);
+  _downstreamSlopeYCounter.flush(downstreamTripletSlopeY);
+  _upstreamResidualXCounter.flush(upstreamTripletResidualX);
+  _upstreamResidualYCounter.flush(upstreamTripletResidualY);
+  _downstreamResidualXCounter.flush(downstreamTripletResidualX);
+  _downstreamResidualYCounter.flush(downstreamTripletResidualY);
+  _tripletMatchingResidualXCounter.flush(tripletMatchingResidualX);
+  _tripletMatchingResidualYCounter.flush(tripletMatchingResidualY);
+  _DUTMatchingResidualXCounter.flush(DUTMatchingResidualX);
+  _DUTMatchingResidualYCounter.flush(DUTMatchingResidualY);
+}
 
-      
-      //cut plots
-      tripletMatchingResidualX->fill(dx);
-      tripletMatchingResidualY->fill(dy);
-      // match driplet and triplet:
-      streamlog_out(DEBUG4) << "  Distance for matching x: " << fabs(dx)<< std::endl;
-      streamlog_out(DEBUG4) << "  Distance for matching y: " << fabs(dy)<< std::endl;
-      if( fabs(dx) > trip_matching_cut) continue;
-      if( fabs(dy) > trip_matching_cut) continue;
-      streamlog_out(DEBUG4) << "  Survived matching " << std::endl;
+void EUTelTripletGBLUtility::fillDistances(binnedCounter & counter, positionIndex const & index, bool useY, double reference, double sign) {
+
+  // safety margin for rounding in the window boundaries [mm]
+  double const margin = 1E-6;
+
+  // coordinates of the entries within the counter range
+  double coordLow = reference + std::min(sign*counter.low(), sign*counter.high()) - margin;
+  double coordHigh = reference + std::max(sign*counter.low(), sign*counter.high()) + margin;
+
+  size_t inside = 0;
+  auto fillEntry = [&](size_t entry) {
+    counter.fill(sign*((useY ? index.y(entry) : index.x(entry)) - reference));
+    ++inside;
+  };
+  if(useY) index.queryY(coordLow, coordHigh, fillEntry);
+  else index.queryX(coordLow, coordHigh, fillEntry);
+
+  // the others are further than the margin outside the range
+  auto below = static_cast<long>(useY ? index.countBelowY(coordLow) : index.countBelowX(coordLow));
+  auto above = static_cast<long>(index.size() - inside) - below;
+  if(sign > 0) {
+    counter.fillUnderflow(below);
+    counter.fillOverflow(above);
+  } else {
+    counter.fillUnderflow(above);
+    counter.fillOverflow(below);
+  }
+}
 
-      // check isolation
-      if( !IsolatedTrip || !IsolatedDrip ) {
-	continue;
-      }
-      streamlog_out(DEBUG4) << "  Trip and Drip isolated " << std::endl;      
+bool EUTelTripletGBLUtility::IsTripletIsolated(size_t entry, positionIndex const & index, double isolation_cut) const {
+  bool IsolatedTrip = true;
 
-      // Add the track to the vector if trip/drip are isolated, the triplets are matched, and all other cuts are passed
-      tracks.push_back(newtrack);
+  double xA = index.x(entry);
+  double yA = index.y(entry);
 
-    } // Downstream
-  } // Upstream
+  // only neighbours within the isolation cut in x can be closer than the cut
+  index.queryX(xA - isolation_cut - 1E-6, xA + isolation_cut + 1E-6, [&](size_t other) {
+    if( other == entry ) return;
+    double xAIsoCheck = index.x(other);
+    double yAIsoCheck = index.y(other);
+    double ddA = sqrt( fabs(xAIsoCheck - xA)*fabs(xAIsoCheck - xA) 
+	+ fabs(yAIsoCheck - yA)*fabs(yAIsoCheck - yA) );
+    if(ddA < isolation_cut) IsolatedTrip = false;
+  });
 
-  streamlog_out(DEBUG2) << "Found " << tracks.size() << " tracks from matched triplets." << std::endl;
-  //return tracks;
+  return IsolatedTrip;
 }
 
 bool EUTelTripletGBLUtility::IsTripletIsolated(EUTelTripletGBLUtility::triplet const & it, std::vector<EUTelTripletGBLUtility::triplet> const & trip, double z_match, double isolation_cut) { // isolation_cut is defaulted to 0.3 mm
@@ -186,38 +219,14 @@ bool EUTelTripletGBLUtility::IsTripletIsolated(EUTelTripletGBLUtility::triplet c
   return IsolatedTrip;
 }
 
-bool EUTelTripletGBLUtility::AttachDUT(EUTelTripletGBLUtility::triplet & triplet, std::vector<EUTelTripletGBLUtility::hit> const & hits, unsigned int dutID,  std::vector<float> dist_cuts){
-
-	auto zPos = geo::gGeometry().getPlaneZPosition(dutID);
-	int minHitIx = -1;
-	double minDist = std::numeric_limits<float>::max();
-
-	auto trX = triplet.getx_at(zPos);
-	auto trY = triplet.gety_at(zPos);
-	size_t ix = 0;	
-	for(auto& hit: hits) {
-		if(hit.plane == dutID) {
-			auto hitX = hit.x;
-			auto hitY = hit.y;
-			auto distX = fabs(trX-hitX);
-			auto distY = fabs(trY-hitY);
-            double dist = distX*distX + distY*distY;
-			DUTMatchingResidualX->fill(trX-hitX);
-			DUTMatchingResidualY->fill(trY-hitY);
-			if(distX <= dist_cuts.at(0) && distY <= dist_cuts.at(1) && dist < minDist ){
-				minHitIx = static_cast<int>(ix);
-				DUTHitNumber->fill(dutID);
-				minDist = dist;
-			}
+void EUTelTripletGBLUtility::IndexDUTHits(std::vector<EUTelTripletGBLUtility::hit> const & hits, unsigned int dutID, positionIndex & dutIndex) const {
+	dutIndex.clear();
+	for(size_t ix = 0; ix < hits.size(); ++ix) {
+		if(hits[ix].plane == dutID) {
+			dutIndex.push_back(hits[ix].x, hits[ix].y, ix);
 		}
-		++ix;
-	}
-
-	if(minHitIx != -1) {
-		triplet.push_back_DUT(hits[minHitIx].plane, hits[minHitIx]);
-		return true;
 	}
-return false;
+	dutIndex.sort();
 }
 
 EUTelTripletGBLUtility::track::track(triplet up, triplet down) : upstream(up), downstream(down) {}
@@ -327,7 +336,8 @@ std::pair<double,double> EUTelTripletGBLUtility::doIterativeGaussianFit(AIDA::IH
     streamlog_out (DEBUG5) << in_hist->title() << " has " << in_hist->allEntries() << " entries" << std::endl;
     
     TH1D current(in_hist->title().data(), in_hist->title().data(), nb_bins, in_hist->axis().lowerEdge(), in_hist->axis().upperEdge());
-    for(int ibin = 0 ; ibin < nb_bins ; ibin++) current.SetBinContent(ibin+1, in_hist->binEntries(ibin));
+    //bin heights, the histograms may have been filled with weights by flushHistos()
+    for(int ibin = 0 ; ibin < nb_bins ; ibin++) current.SetBinContent(ibin+1, in_hist->binHeight(ibin));
     current.Rebin(rebinFactor);
     
     double startForMaxFraction = 0.2;
@@ -28,6 +28,7 @@
 // system includes <>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace eutelescope {
@@ -92,6 +93,11 @@ namespace eutelescope {
      *  coordinate of the cluster center. Only clusters not belonging
      *  to the same sensors are used.
      *
+     *  The clusters or hits are decoded once per event and indexed by
+     *  their X position per sensor, so that only the pairs within the
+     *  residual band (hits) or the ClusterCorrelationWindow (clusters)
+     *  are compared.
+     *
      *  Histograms are booked in the first event.
      *
      *  @param evt the current LCEvent event as passed by the
@@ -155,6 +161,12 @@ namespace eutelescope {
     //! Cluster collection list (EVENT::StringVec)
     EVENT::StringVec _clusterCollectionVec;
 
+    //! Correlation window for clusters (X and Y), empty for no window
+    /*! Only cluster pairs whose centres differ by at most this amount
+     *  are correlated, useful for pre-aligned data.
+     */
+    std::vector<float> _clusterCorrelationWindow;
+
 	//! Function for guessing the sensor offset
     std::vector<double> guessSensorOffset(int internalSensorID,
                                           int externalSensorID,
@@ -197,6 +209,31 @@ namespace eutelescope {
     
     //! map of Sensor ID and z position
     std::map<int, int> _sensorIDtoZ;
+
+    //! Clear the correlation entries of the previous event
+    void clearCorrelationEntries();
+
+    //! Index the correlation entries of each sensor by their X position
+    void indexCorrelationEntries();
+
+    //! Append all entries of a sensor with xLow <= X <= xHigh to _correlatedEntries
+    void findCorrelationCandidates(std::vector<std::pair<double, size_t>> const &sensorEntries,
+                                   double xLow, double xHigh);
+
+    //! Clusters or hits of the current event, decoded once, in input order
+    std::vector<int> _entrySensorID;
+    std::vector<double> _entryX;
+    std::vector<double> _entryY;
+    //! Whether the entry passes the charge cut as external/internal cluster
+    std::vector<char> _entryIsExternal;
+    std::vector<char> _entryIsInternal;
+
+    //! Entries of each sensor as pairs of X position and entry, sorted
+    /*! The map and the vectors are kept between events. */
+    std::map<int, std::vector<std::pair<double, size_t>>> _sensorEntries;
+
+    //! Scratch buffer for the entries correlated to one external entry
+    std::vector<size_t> _correlatedEntries;
   };
   
   //! A global instance of the processor
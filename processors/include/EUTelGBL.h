@@ -14,6 +14,7 @@
 
 // eutelescope includes ".h"
 #include "EUTelUtility.h"
+#include "EUTelThreadPool.h"
 #include "EUTelTripletGBLUtility.h"
 
 // marlin includes ".h"
@@ -30,12 +31,14 @@
 #endif
 
 //for gbl::MilleBinary
+#include "include/GblTrajectory.h"
 #include "include/MilleBinary.h"
 
 // system includes <>
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 #include <limits>
 
 namespace eutelescope {
@@ -93,6 +96,27 @@ namespace eutelescope {
 
     protected:
       static int const NO_PRINT_EVENT_COUNTER = 3;
+
+      //! A matched track with its GBL trajectory
+      /*! Filled in processEvent() in three steps: the points are set up
+       *  serially, the trajectory is built and fitted by the workers,
+       *  and the results are evaluated serially in track order again.
+       *  The entries are pooled in _gblTracks, so the vectors keep their
+       *  storage from track to track and event to event.
+       */
+      struct gblTrack {
+        EUTelTripletGBLUtility::track* track = nullptr;
+        std::vector<gbl::GblPoint> points;
+        std::vector<double> rx;
+        std::vector<double> ry;
+        std::vector<bool> hasHit;
+        //! z of the upstream triplet's intersection with each plane, only filled when dumping tracks
+        std::vector<double> intersectionZ;
+        std::unique_ptr<gbl::GblTrajectory> traj;
+        double chi2 = 0;
+        int ndf = 0;
+        double lostWeight = 0;
+      };
     
       //! Ordered sensor ID
       /*! Within the processor all the loops are done up to _nPlanes and
@@ -117,11 +141,29 @@ namespace eutelescope {
       std::vector<Eigen::Vector2d> _planeWscatSi;
       std::vector<Eigen::Vector2d> _planeWscatAir;
       std::vector<Eigen::Vector2d> _planeMeasPrec;
+
+      //GBL trajectory layout, fixed by the geometry
+      //! Jacobian from the previous point to each plane
+      std::vector<Eigen::Matrix<double,5,5>> _gblPlaneJacobians;
+      //! Jacobians to the two air scatterers behind each plane
+      std::vector<Eigen::Matrix<double,5,5>> _gblAirJacobiansLeft;
+      std::vector<Eigen::Matrix<double,5,5>> _gblAirJacobiansRight;
+      //! Arc length of all trajectory points
+      std::vector<double> _gblArcLengths;
+      //! Trajectory point label of each plane
+      std::vector<unsigned int> _gblPlaneLabels;
+      //! Alignment labels of each plane, only during alignment
+      std::vector<std::vector<int>> _planeGlobalLabels;
+      //! Distance of each plane to the SUT, only if there is a SUT
+      std::vector<double> _planeDistSUT;
+      double _thicknessSUT;
       std::vector<float> _xResolutionVec;
       std::vector<float> _yResolutionVec;
       int _SUT_ID;
       std::vector<int>_DUT_IDs;
       std::vector<float> _dutCuts;
+      //! Per event index of the hits of each DUT, ordered as _DUT_IDs
+      std::vector<EUTelTripletGBLUtility::positionIndex> _dutHitIndexVec;
       std::vector<int> _excludedPlanes;
       std::vector<int> _fixedPlanes;
       int _requiredPlane;
@@ -169,6 +211,27 @@ namespace eutelescope {
       int _suggestAlignmentCuts;
       int _dumpTracks;
 
+      //! How the cut histograms are filled: 0 not at all, 1 counters (default), 2 directly
+      int _tripletMonitoring;
+
+      //! Number of threads used to fit the tracks of an event
+      int _noOfThreads;
+
+      //! Thread pool, only created if more than one thread is requested
+      std::unique_ptr<EUTelThreadPool> _threadPool;
+
+      //! Pool of tracks, the first _noOfGBLTracks are used in this event
+      std::vector<gblTrack> _gblTracks;
+      size_t _noOfGBLTracks;
+
+      //! Buffers for the GBL results, reused for all tracks
+      Eigen::VectorXd _localPar;
+      Eigen::MatrixXd _localCov;
+      Eigen::VectorXd _measResiduals;
+      Eigen::VectorXd _measErrors;
+      Eigen::VectorXd _measResErrors;
+      Eigen::VectorXd _measDownWeights;
+
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
     //histograms: hits, triplets and tracks
     AIDA::IHistogram1D * hist1D_nTelescopeHits;
@@ -69,12 +69,30 @@ namespace eutelescope {
     virtual void end();
 
   private:
+    // Transform _hitPositions in place, one batch per run of hits on the same sensor
+    void transformConsecutive();
+
+    // Transform _hitPositions via structure-of-arrays buffers, one vectorised batch per sensor
+    void transformVectorised();
+
     // Collection names
     std::string _hitCollectionNameInput;
     std::string _hitCollectionNameOutput;
     
     //parameter
     bool _undoAlignment;
+    bool _vectorisedTransform;
+
+    //per event buffers, kept to avoid reallocation
+    //sensor ID and properties of each input hit
+    std::vector<int> _hitSensorIDs;
+    std::vector<int> _hitProperties;
+    //positions of all hits as consecutive (x,y,z) triples, transformed in place
+    std::vector<double> _hitPositions;
+    //hit indices grouped by sensor and the structure-of-arrays buffers of the vectorised path
+    std::vector<size_t> _hitOrder;
+    std::vector<double> _inputX, _inputY, _inputZ;
+    std::vector<double> _outputX, _outputY, _outputZ;
   };
 
   //! A global instance of the processor
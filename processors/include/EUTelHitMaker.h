@@ -31,6 +31,7 @@
 #endif
 
 #include <IMPL/LCCollectionVec.h>
+#include <IMPL/TrackerHitImpl.h>
 
 // system includes <>
 #include <map>
@@ -332,6 +333,16 @@ namespace eutelescope {
      */
     std::set<int> _alreadyBookedSensorID;
 
+    //! Hits created in the current event, their positions are set after
+    //! the cluster loop
+    std::vector<IMPL::TrackerHitImpl *> _hits;
+
+    //! Sensor ID of each hit in _hits
+    std::vector<int> _hitSensorIDs;
+
+    //! Positions of the hits in _hits as consecutive (x,y,z) triples
+    std::vector<double> _hitPositions;
+
 	//! Histogram maps 
     #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
     std::map<int, AIDA::IBaseHistogram *> _hitLocalHistos;
@@ -12,6 +12,7 @@
 // eutelescope includes ".h"
 #include "EUTelEventImpl.h"
 #include "EUTelGenericSparsePixel.h"
+#include "EUTelNoisyPixelIndex.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -22,6 +23,7 @@
 
 // system includes <>
 #include <map>
+#include <memory>
 #include <string>
 
 namespace eutelescope {
@@ -118,8 +120,8 @@ namespace eutelescope {
     /*! False is everything is OK, true otherwise */
     bool _wrongDataFormat;
 
-    //! Map linking the noise vectors of each plane to the plane ID
-    std::map<int, std::vector<int>> _noisyPixelMap;
+    //! Index of the noisy pixels of all planes
+    std::shared_ptr<EUTelNoisyPixelIndex const> _noisyPixelIndex;
 
     //! Map counting the removed hot pixels per plane
     std::map<int, int> _maskedNoisyClusters;
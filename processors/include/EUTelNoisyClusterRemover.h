@@ -11,6 +11,7 @@
 
 // eutelescope includes ".h"
 #include "EUTelEventImpl.h"
+#include "EUTelNoisyPixelIndex.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -20,8 +21,9 @@
 #include <LCIOTypes.h>
 
 // system includes <>
-#include <string>
 #include <map>
+#include <memory>
+#include <string>
 
 namespace eutelescope {
 
@@ -29,6 +31,10 @@ namespace eutelescope {
   /*! This processor clones the input TrackerPulse collection, but checks
    *  for any clusters if their quality flag: kNoisyCluster is set.
    *  If so, they are removed from the output collection.
+   *
+   *  If a HotPixelCollectionName is given, clusters containing any of its
+   *  pixels are removed as well, without running EUTelNoisyClusterMasker
+   *  first. The noisy pixel index is shared with the masker.
    */
 
   class EUTelNoisyClusterRemover : public marlin::Processor {
@@ -91,6 +97,9 @@ namespace eutelescope {
     //! Output collection name for noise free pulses
     std::string _outputCollectionName;
 
+    //! Name of the hot pixel collection, empty to only check the quality
+    std::string _noisyPixelCollectionName;
+
     //! Integer to track the collection size
     /*! Used to monitor if anything changed and the collection needs
      *! to be updated
@@ -114,6 +123,9 @@ namespace eutelescope {
     //! Static bool flag to mark if any instance of this processor has printed
     //! out generla info
     static bool _staticPrintedSummary;
+
+    //! Index of the noisy pixels of all planes, if a collection is given
+    std::shared_ptr<EUTelNoisyPixelIndex const> _noisyPixelIndex;
   };
 
   //! A global instance of the processor
@@ -12,6 +12,7 @@
 // eutelescope includes ".h"
 #include "EUTelEventImpl.h"
 #include "EUTelGenericSparsePixel.h"
+#include "EUTelTrackerDataColumns.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -26,6 +27,7 @@
 #endif
 
 // system includes <>
+#include <cstdint>
 #include <map>
 
 namespace eutelescope {
@@ -180,14 +182,13 @@ namespace eutelescope {
      */
     std::map<int, sensor> _sensorMap;
 
-    //! Map holding the 2D-"array" which counts the hits
-    /*! The key is the sensorID and the array is implemented as
-     *  a vector of vectors. They are resized initially so there
-     *  is no real overhead with using std::vectors instead of
-     * arrays.
+    //! Map holding the hit counters of each sensor
+    /*! The key is the sensorID, the value a contiguous array with one
+     *  32-bit counter per pixel. The counter of the pixel with the
+     *  (offset corrected) indices x and y is stored at x*sizeY+y. It is
+     *  sized once in initializeHitMaps(), so counting does not allocate.
      */
-    std::map<int, std::vector<std::vector<long int>>> _hitVecMap;
-
+    std::map<int, std::vector<std::uint32_t>> _hitCountMap;
     //! Map for storing the hot pixels in a std::vector as a value
     /*! The key is once again the sensorID.
      */
@@ -198,7 +199,20 @@ namespace eutelescope {
      */
     std::map<int, std::vector<int>> _maskedLinesMap;
 
-	std::map<int, std::vector<long double>> _firingFreqForAllPixels;
+    //! Number of bins of the noisy pixel vs. noise cut histogram
+    int _noiseCutBins;
+    //! Upper edge of the noisy pixel vs. noise cut histogram
+    double _noiseCutHigh;
+    //! Noise cut values of the noisy pixel vs. noise cut histogram
+    std::vector<long double> _noiseCuts;
+    //! Histogram of the firing frequencies in units of noise cuts
+    /*! The key is the sensorID. Entry i counts the pixels for which
+     *  exactly i noise cuts are below the firing frequency. It is filled
+     *  while the pixels are checked, the number of noisy pixels for any
+     *  cut then follows from a sum over the higher entries, no firing
+     *  frequencies have to be stored or sorted.
+     */
+    std::map<int, std::vector<long>> _noiseCutHistoMap;
 
     //! Vectors for storing lines to be masked per sensor
     std::vector<int> _maskedLinesVec0;
@@ -233,6 +247,13 @@ namespace eutelescope {
 
     //! Flag which will be set once we're done finding noisy pixels
     bool _finished;
+
+    //! Columnar buffer for the hit pixels of the current sensor
+    EUTelTrackerDataColumns _pixelColumns;
+
+    //! Counter indices of the hit pixels of the current sensor
+    /*! Set to -1 for pixels outside of the range given by the geometry */
+    std::vector<long> _pixelIndices;
   };
 
   //! A global instance of the processor
@@ -31,6 +31,7 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace eutelescope {
@@ -44,9 +45,10 @@ namespace eutelescope {
     float range;
     float zPos;
     int iden;
+    size_t nPoints;
     
     //! function to get maximum bin of given histogram
-    float getMaxBin(std::vector<int> &histo) {
+    float getMaxBin(std::vector<int> &histo, bool verbose = true) {
       int maxBin(0), maxVal(0);
       //loop over bins
       for(size_t ibin = 0; ibin < histo.size(); ibin++) {
@@ -58,11 +60,13 @@ namespace eutelescope {
       
       //check if maxBin is not at the edges
       if(maxBin == 0 || maxBin == static_cast<int>(histo.size())) {
-        streamlog_out(WARNING3)
-	  << "At least one sensor frame might be empty or heavily "
-	  "misaligned. Please check the GEAR file!"
-	  << " MaxBin: " << maxBin << " histo.size(): " << histo.size()
-	  << std::endl;
+        if(verbose) {
+          streamlog_out(WARNING3)
+	    << "At least one sensor frame might be empty or heavily "
+	    "misaligned. Please check the GEAR file!"
+	    << " MaxBin: " << maxBin << " histo.size(): " << histo.size()
+	    << std::endl;
+        }
         return static_cast<float>(maxBin);
       }
       	
@@ -79,11 +83,13 @@ namespace eutelescope {
 	weight = log((histo.at(maxBin - 1)) + (histo.at(maxBin)) +
                      (histo.at(maxBin + 1)));
       } catch(...) {
-	streamlog_out(ERROR) 
-	  << "Could not execute prealignment bin content retrieval. The "
-	  "sensor frame might be empty or heavily misaligned. Please "
-	  "check the GEAR file!"
-	  << std::endl;
+	if(verbose) {
+	  streamlog_out(ERROR) 
+	    << "Could not execute prealignment bin content retrieval. The "
+	    "sensor frame might be empty or heavily misaligned. Please "
+	    "check the GEAR file!"
+	    << std::endl;
+	}
 	  return(maxBin);
       }
       return (exp(pos1-weight) + exp(pos2-weight) + exp(pos3-weight));
@@ -91,7 +97,7 @@ namespace eutelescope {
     
   public:
   PreAligner(float zPos, int iden)
-    : minX(-20.0), maxX(20.0), range(maxX - minX), zPos(zPos), iden(iden) {
+    : minX(-20.0), maxX(20.0), range(maxX - minX), zPos(zPos), iden(iden), nPoints(0) {
       
       histoX.assign(400, 0); // 500 bins
       histoY.assign(400, 0);
@@ -107,8 +113,14 @@ namespace eutelescope {
       return (iden); 
     }
     
+    //! number of points added so far
+    size_t getNoOfPoints() const {
+      return nPoints;
+    }
+    
     //add point if within bounds, throw away data that is out of bounds
     void addPoint(float x, float y) {
+      ++nPoints;
       try {
 	histoX.at(static_cast<int>((x - minX)*400./range)) += 1;
       } catch(std::out_of_range &e) {;}
@@ -117,12 +129,14 @@ namespace eutelescope {
       } catch(std::out_of_range &e) {;}
     }	
     
-    float getPeakX() { 
-      return (getMaxBin(histoX)*range/400. + minX); 
+    //! current peak position, verbose = false suppresses the warnings for
+    //! empty or misaligned frames (e.g. for intermediate estimates)
+    float getPeakX(bool verbose = true) { 
+      return (getMaxBin(histoX, verbose)*range/400. + minX); 
     }
     
-    float getPeakY() { 
-      return (getMaxBin(histoY)*range/400. + minX); 
+    float getPeakY(bool verbose = true) { 
+      return (getMaxBin(histoY, verbose)*range/400. + minX); 
     }
   };
   
@@ -178,6 +192,49 @@ namespace eutelescope {
     //! Boolean for turning histogram creation on and off
     bool _histogramSwitch;
 
+    //! Number of events between two checks of the offset convergence, 0 = never
+    int _convergenceCheckInterval;
+
+    //! Maximal change of all offsets between two checks to be converged [mm]
+    float _convergenceTolerance;
+
+    //! Stop the whole job once the offsets are converged
+    bool _stopOnConvergence;
+
+    //! Set once the offsets are converged, no further events are used
+    bool _isConverged;
+
+    //! Peak positions (X, Y) of each PreAligner at the last convergence check
+    std::vector<std::pair<float, float>> _lastPeaks;
+
+    //! Check if the offsets changed by less than the tolerance since the last check
+    bool checkConvergence();
+
+    //! Index of the PreAligner of each sensor ID, -1 if there is none
+    std::vector<int> _preAlignerIndex;
+
+    //! Get the PreAligner of a sensor, nullptr if there is none
+    PreAligner *getPreAligner(int sensorID) {
+      if(sensorID < 0 || static_cast<size_t>(sensorID) >= _preAlignerIndex.size() ||
+         _preAlignerIndex[static_cast<size_t>(sensorID)] < 0) {
+        return nullptr;
+      }
+      return &_preAligners[static_cast<size_t>(_preAlignerIndex[static_cast<size_t>(sensorID)])];
+    }
+
+    //! Hits of the fixed plane in the current event (X, Y), reused
+    std::vector<std::pair<double, double>> _refHits;
+
+    //! Hits of the other planes in the current event, reused
+    struct alignHit {
+      double x;
+      double y;
+      double z;
+      int idZ;
+      PreAligner *preAligner;
+    };
+    std::vector<alignHit> _alignHits;
+
 #if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
     std::map<unsigned int, AIDA::IBaseHistogram *> _hitXCorr;
     std::map<unsigned int, AIDA::IBaseHistogram *> _hitYCorr;
@@ -12,6 +12,10 @@
 // eutelescope includes ".h"
 #include "EUTELESCOPE.h"
 #include "EUTelExceptions.h"
+#include "EUTelSparseClusterFinder.h"
+#include "EUTelThreadPool.h"
+#include "EUTelTrackerDataColumns.h"
+#include "EUTelTrackerDataInterfacer.h"
 
 // marlin includes ".h"
 #include "marlin/EventModifier.h"
@@ -29,11 +33,13 @@
 
 // lcio includes <.h>
 #include <IMPL/LCCollectionVec.h>
+#include <IMPL/TrackerDataImpl.h>
 #include <IMPL/TrackerRawDataImpl.h>
 
 // system includes <>
 #include <cmath>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -79,6 +85,17 @@ namespace eutelescope {
    *
    *  @param PulseCollectionName The name of the output TrackerPulse collection.
    *
+   *  @param ClusteringAlgorithm The neighbour search used to group the
+   *  pixels: "Iterative" compares every cluster pixel against all
+   *  remaining pixels, "ColumnIndex" uses the EUTelSparseClusterFinder.
+   *  Both produce identical clusters.
+   *
+   *  @param NumberOfThreads The number of threads used to cluster the
+   *  sensors of an event concurrently. Each sensor is clustered into its
+   *  own staging buffer, the buffers are then written to the output
+   *  collections in the order of the input collection, so the output
+   *  does not depend on the number of threads.
+   *
    */
 
   class EUTelSparseClustering : public marlin::Processor,
@@ -194,6 +211,32 @@ namespace eutelescope {
      */
     void sparseClustering(LCEvent *evt, LCCollectionVec *pulse);
 
+    //! Iterative neighbour search
+    /*! The original clustering: every newly added cluster pixel is
+     *  compared against all remaining pixels of the sensor. The cost
+     *  grows quadratically with the number of hit pixels.
+     *
+     *  @param sparseData The hit pixels of one sensor
+     *  @param type The sparse pixel type of the sensor
+     *  @param clusters The vector the found clusters are appended to
+     */
+    void iterativeClustering(EUTelTrackerDataInterfacer const &sparseData,
+                             SparsePixelType type,
+                             std::vector<std::unique_ptr<TrackerDataImpl>> &clusters);
+
+    //! Neighbour search based on a sorted column index
+    /*! Uses the EUTelSparseClusterFinder to find the same clusters as
+     *  iterativeClustering() in close to linear time. The pixels are
+     *  read via EUTelTrackerDataColumns, no pixel objects are created.
+     *
+     *  @param pixels The decoded hit pixels of one sensor
+     *  @param finder The cluster finder to be used, one per thread
+     *  @param clusters The vector the found clusters are appended to
+     */
+    void columnIndexClustering(EUTelTrackerDataColumns const &pixels,
+                               EUTelSparseClusterFinder &finder,
+                               std::vector<std::unique_ptr<TrackerDataImpl>> &clusters);
+
     //! Input collection name for ZS data
     /*! The input collection is the calibrated data one coming from
      *  the EUTelCalibrateEventProcessor. It is, usually, called
@@ -281,6 +324,33 @@ namespace eutelescope {
 
     //! Squared cut value for distance in pixel index count (integer!)
     int _sparseMinDistanceSquared;
+
+    //! Name of the clustering algorithm as set in the steering file
+    std::string _clusteringAlgorithmString;
+
+    //! Switch to the column index based clustering
+    bool _useColumnIndex;
+
+    //! Number of threads used to cluster the sensors of an event
+    int _noOfThreads;
+
+    //! Thread pool, only created if more than one thread is requested
+    std::unique_ptr<EUTelThreadPool> _threadPool;
+
+    //! Column index cluster finders, one per thread
+    /*! They are reused for all sensors and events.
+     */
+    std::vector<EUTelSparseClusterFinder> _clusterFinders;
+
+    //! Columnar pixel buffers for the column index clustering, one per thread
+    std::vector<EUTelTrackerDataColumns> _pixelColumns;
+
+    //! Per sensor staging buffers for the found clusters
+    /*! The buffers are indexed like the input collection and filled by
+     *  the (possibly concurrent) clustering. Only afterwards they are
+     *  moved into the output collections by the processing thread.
+     */
+    std::vector<std::vector<std::unique_ptr<TrackerDataImpl>>> _clusterStaging;
   };
 
   //! A global instance of the processor
@@ -0,0 +1,96 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+#ifndef ALIBAVACHIPCORRECTION_H
+#define ALIBAVACHIPCORRECTION_H 1
+
+// system includes <>
+#include <cmath>
+
+namespace alibava
+{
+    //! The common mode found for one chip
+    struct ChipCommonMode
+    {
+	double mean;
+	double sigma;
+	// slope: commonmode = a + b * channel
+	double a;
+	double b;
+    };
+
+    //! Pedestal subtraction and common mode correction of the data of one chip
+    /*! The arithmetic of AlibavaPedestalSubtraction, AlibavaConstantCommonModeProcessor and
+     *  AlibavaCommonModeSubtraction, without the collections in between. The common mode is
+     *  rounded to float before it is subtracted, as it is when stored in the common mode
+     *  collection. Masked channels are set to zero. The result is written to signal.
+     */
+    inline ChipCommonMode correctChipData ( int nchannels, const float * rawdata, const float * pedestal, const bool * masked, int iterations, float noiseDeviation, bool slope, float * signal )
+    {
+	// pedestal subtraction
+	for ( int ichan = 0; ichan < nchannels; ichan++ )
+	{
+	    signal[ichan] = masked[ichan] ? 0.0f : rawdata[ichan] - pedestal[ichan];
+	}
+
+	ChipCommonMode cm = { 0, 0, 0, 0 };
+
+	for ( int i = 0; i < iterations; i++ )
+	{
+	    int nchan = 0;
+	    double total_signal = 0;
+	    double total_signal_square = 0;
+	    double channelcount = 0;
+	    double channelcount_square = 0;
+	    double chan_sig = 0;
+
+	    for ( int ichan = 0; ichan < nchannels; ichan++ )
+	    {
+		if ( masked[ichan] )
+		{
+		    continue;
+		}
+
+		double sig = signal[ichan];
+
+		// first iteration: take everything, then exclude outliers
+		if ( i == 0 || fabs ( ( sig - cm.mean ) / cm.sigma ) < noiseDeviation )
+		{
+		    total_signal += sig;
+		    total_signal_square += sig * sig;
+		    nchan++;
+		    channelcount += ichan;
+		    channelcount_square += ichan * ichan;
+		    chan_sig += ichan * sig;
+		}
+	    }
+
+	    double delta = nchan * channelcount_square - channelcount * channelcount;
+	    cm.a = ( channelcount_square * total_signal - channelcount * chan_sig ) / delta;
+	    cm.b = ( nchan * chan_sig - channelcount * total_signal ) / delta;
+
+	    if ( nchan > 0 )
+	    {
+		cm.mean = total_signal / nchan;
+		cm.sigma = sqrt ( total_signal_square / nchan - cm.mean * cm.mean );
+	    }
+	}
+
+	// common mode subtraction
+	for ( int ichan = 0; ichan < nchannels; ichan++ )
+	{
+	    float commonmode = slope ? float ( cm.a + cm.b * ichan ) : float ( cm.mean );
+	    signal[ichan] = masked[ichan] ? 0.0f : signal[ichan] - commonmode;
+	}
+
+	return cm;
+    }
+}
+
+#endif
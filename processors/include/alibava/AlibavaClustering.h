@@ -96,6 +96,9 @@ namespace alibava
 
 	    void findSeedClusters  (TrackerDataImpl * trkdata, LCCollectionVec * clusterCollection, LCCollectionVec * sparseClusterCollectionVec, AlibavaEventImpl * alibavaEvent );
 
+	    // the clustering itself, works on the signals of one chip, which are changed in place if FIR filtering is used
+	    void findSeedClusters ( int chipnum, EVENT::FloatVec & datavec, LCCollectionVec * clusterCollection, LCCollectionVec * sparseClusterCollectionVec, AlibavaEventImpl * alibavaEvent );
+
 	    virtual void end ( );
 
 	    void setClusterCollectionName ( std::string clusterCollectionName );
@@ -142,13 +145,13 @@ namespace alibava
 
 	protected:
 
+	    // for processors doing the clustering as their last step
+	    AlibavaClustering ( std::string processorName );
+
 	    IMPL::LCRunHeaderImpl* _runHeader;
 
     };
 
-    //! A global instance of the processor
-    AlibavaClustering gAlibavaClustering;
-
 }
 
 #endif
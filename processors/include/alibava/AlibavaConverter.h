@@ -13,6 +13,10 @@
 // personal includes ".h"
 #include "ALIBAVA.h"
 #include "AlibavaRunHeaderImpl.h"
+#include "AlibavaEventImpl.h"
+
+// eutelescope includes ".h"
+#include "EUTelMappedFile.h"
 
 // marlin includes ".h"
 #include "marlin/DataSourceProcessor.h"
@@ -80,6 +84,26 @@ namespace alibava
 	    // An option to store pedestal and noise values stored in header of alibava data file
 	    bool _storeHeaderPedestalNoise;
 
+	    // The number of threads decoding events ahead, 0 decodes in the processing thread
+	    int _nDecoderThreads;
+
+	    // The maximum number of events decoded ahead
+	    int _decoderQueueSize;
+
+	    // The firmware version of the data file
+	    int _headerVersion;
+
+	    // The user event type code which stopped reading the file, 0 if none did
+	    unsigned int _userEventTypeCode;
+
+	    // Cut the next event off the input, starting at its header code.
+	    // Returns false at the end of the input or at an unexpected user event type.
+	    bool splitEvent ( eutelescope::EUTelMappedFile::Cursor & input, eutelescope::EUTelMappedFile::Cursor & event );
+
+	    // Decode an event cut off by splitEvent. Without log there is no output,
+	    // so it can run in any thread.
+	    AlibavaEventImpl * decodeEvent ( eutelescope::EUTelMappedFile::Cursor event, int eventNumber, bool log );
+
 	private:
 
 	    // To check if the chip selection is valid
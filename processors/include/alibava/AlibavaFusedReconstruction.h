@@ -0,0 +1,92 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+#ifndef ALIBAVAFUSEDRECONSTRUCTION_H
+#define ALIBAVAFUSEDRECONSTRUCTION_H 1
+
+// alibava includes ".h"
+#include "AlibavaClustering.h"
+#include "ALIBAVA.h"
+
+// marlin includes ".h"
+#include "marlin/Processor.h"
+
+// lcio includes <.h>
+#include <IMPL/LCRunHeaderImpl.h>
+#include <IMPL/TrackerDataImpl.h>
+
+// system includes <>
+#include <string>
+#include <vector>
+
+namespace alibava
+{
+    //! Pedestal subtraction, common mode correction and clustering in one go.
+    /*! This does the same as running AlibavaPedestalSubtraction, AlibavaConstantCommonModeProcessor,
+     *  AlibavaCommonModeSubtraction and AlibavaClustering after each other and writes the same
+     *  cluster collections. The raw data of each chip is corrected in a buffer owned by the
+     *  processor and handed directly to the clustering, the intermediate collections are not
+     *  written to the event. The histograms of the clustering are filled, the ones of the
+     *  intermediate steps are not.
+     */
+    class AlibavaFusedReconstruction : public alibava::AlibavaClustering
+    {
+	public:
+
+	    virtual Processor * newProcessor ( )
+	    {
+		return new AlibavaFusedReconstruction;
+	    }
+
+	    AlibavaFusedReconstruction ( );
+
+	    virtual void init ( );
+
+	    virtual void processRunHeader ( LCRunHeader * run );
+
+	    virtual void processEvent ( LCEvent * evt );
+
+	    virtual void end ( );
+
+	protected:
+
+	    // Everything needed per chip, a few kB which stay in the cache
+	    struct ChipBuffer
+	    {
+		float pedestal[ALIBAVA::NOOFCHANNELS];
+		bool masked[ALIBAVA::NOOFCHANNELS];
+		// the signal of the current event, kept to avoid allocations
+		EVENT::FloatVec signal;
+	    };
+
+	    // Fills the pedestal and mask values of the buffers, call after the chip selection and masking are set
+	    void setChipBuffers ( );
+
+	    // Subtracts pedestal and common mode from the raw data and leaves the result in buffer.signal
+	    void correctRawData ( ChipBuffer & buffer, const EVENT::FloatVec & rawdata );
+
+	    // One buffer per chip, indexed by the chip number
+	    std::vector < ChipBuffer > _chipBuffer;
+
+	    // The file and collection to read the pedestal from
+	    std::string _pedestalInputFile;
+	    std::string _pedestalInputCollectionName;
+
+	    // Common mode calculation, same as in AlibavaConstantCommonModeProcessor
+	    int _Niteration;
+	    float _NoiseDeviation;
+	    std::string _commonmodeMethod;
+	    bool _slopeCommonMode;
+    };
+
+    //! A global instance of the processor
+    AlibavaFusedReconstruction gAlibavaFusedReconstruction;
+}
+
+#endif
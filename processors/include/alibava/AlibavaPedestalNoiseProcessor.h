@@ -12,6 +12,7 @@
 
 // alibava includes ".h"
 #include "AlibavaBaseProcessor.h"
+#include "ALIBAVA.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -26,6 +27,7 @@
 // system includes <>
 #include <string>
 #include <list>
+#include <vector>
 
 namespace alibava
 {
@@ -86,6 +88,54 @@ namespace alibava
 	    //! Calculates and saves pedestal and noise values
 	    void calculatePedestalNoise ( );
 
+	    //! The method used to estimate pedestal and noise: fit or online
+	    std::string _estimationMethod;
+
+	    //! Samples deviating from the running pedestal by more than this many times the running noise are not used, 0 disables the clipping
+	    float _clippingCut;
+
+	    //! Number of events between updates of the clipping reference, the first ones only seed the clipping
+	    int _clippingWarmUp;
+
+	    //! True if the running estimator is used instead of the per channel histograms and fits
+	    bool _onlineEstimation;
+
+	    //! Running estimator of one chip, flat arrays indexed by channel number
+	    struct OnlineEstimate
+	    {
+		//! The data of the current event
+		float data[ALIBAVA::NOOFCHANNELS];
+		//! 1 for channels to be used, 0 for masked channels
+		float weight[ALIBAVA::NOOFCHANNELS];
+		//! 1 if the sample of the current event passes the clipping, 0 otherwise
+		float accepted[ALIBAVA::NOOFCHANNELS];
+		//! Number of samples, mean and sum of squared deviations from the mean
+		float count[ALIBAVA::NOOFCHANNELS];
+		float mean[ALIBAVA::NOOFCHANNELS];
+		float m2[ALIBAVA::NOOFCHANNELS];
+		//! Reference for the clipping: pedestal and the largest squared deviation accepted
+		float clipMean[ALIBAVA::NOOFCHANNELS];
+		float clipLimit[ALIBAVA::NOOFCHANNELS];
+	    };
+
+	    //! One running estimator per chip, indexed by chip number
+	    std::vector < OnlineEstimate > _onlineEstimate;
+
+	    //! Number of events added to the running estimator
+	    int _onlineNoOfEvents;
+
+	    //! Resets the running estimator of all chips
+	    void resetOnlineEstimate ( );
+
+	    //! Adds the data of one chip to the running estimator
+	    void updateOnlineEstimate ( TrackerDataImpl * trkdata );
+
+	    //! Updates the clipping reference from the running estimator
+	    void updateClipping ( );
+
+	    //! Noise of one channel from the running estimator
+	    float getOnlineNoise ( const OnlineEstimate & estimate, int ichan );
+
     };
 
     //! A global instance of the processor
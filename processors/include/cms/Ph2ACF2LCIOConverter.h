@@ -11,7 +11,12 @@
 // marlin includes ".h"
 #include "marlin/DataSourceProcessor.h"
 
+// eutelescope includes ".h"
+#include "EUTelMappedFile.h"
+
 // system includes <>
+#include <array>
+#include <atomic>
 #include <string>
 #include <vector>
 #include <ctime>
@@ -19,6 +24,8 @@
 namespace eutelescope
 {
 
+    class EUTelEventImpl;
+
     class Ph2ACF2LCIOConverter : public marlin::DataSourceProcessor
     {
 	public:
@@ -51,12 +58,39 @@ namespace eutelescope
 
 	    std::string _rawDataCollectionNameTop;
 
+	    // the number of threads decoding events ahead, 0 decodes in the processing thread
+	    int _nDecoderThreads;
+
+	    // the maximum number of events decoded ahead
+	    int _decoderQueueSize;
+
+	    // stubs without sync/or254 found by the decoder threads
+	    std::atomic < unsigned int > _stubSyncErrors;
+
+	    // the number of event parameters of each chip
+	    static const size_t _nChipParameters = 10;
+
+	    // decode one event in raw format, the cursor covers exactly the event,
+	    // without log only _stubSyncErrors is updated, so it can run in any thread
+	    EUTelEventImpl * decodeRawEvent ( EUTelMappedFile::Cursor event, int eventNumber, bool log );
+
+	    // decode one event in slink format, the cursor covers exactly the event
+	    EUTelEventImpl * decodeSlinkEvent ( EUTelMappedFile::Cursor event, int eventNumber, bool log );
+
+	    // the size of an event in bytes for the data format
+	    size_t getEventSize ( ) const;
+
 	private:
 
 	    int _nFE;
 
 	    int _nChips;
 
+	    // event parameter names, built once in init
+	    std::vector < std::array < std::string, 3 > > _feParameterNames;
+
+	    std::vector < std::array < std::string, _nChipParameters > > _chipParameterNames;
+
     };
 
     Ph2ACF2LCIOConverter gPh2ACF2LCIOConverter;
@@ -60,6 +60,8 @@ namespace eutelescope {
   protected:
     // params
     bool _runPede;
+    //! Fit the candidates of an event in batches
+    bool _batchedFit;
     std::string _pedeSteerfileName, _binaryFilename, _alignmentConstantLCIOFile,
         _alignmentConstantCollectionName;
     std::vector<int> _translate, _translateX, _translateY, _zRot, _scale,
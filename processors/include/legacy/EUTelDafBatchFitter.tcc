@@ -0,0 +1,207 @@
+#include "EUTelDafTrackerSystem.h"
+#include <Eigen/Core>
+
+using namespace daffitter;
+
+namespace daffitter{
+  template <typename T, size_t B>
+  inline void BatchEstimate<T,B>::makeSeedInfo(){
+    //Seed for the information filter in all lanes
+    p0.setZero(); p1.setZero(); p2.setZero(); p3.setZero();
+    c00.setZero(); c11.setZero(); c22.setZero(); c33.setZero();
+    c02.setZero(); c13.setZero();
+  }
+
+  template <typename T, size_t B>
+  inline void BatchEstimate<T,B>::select(const Mask& mask, const BatchEstimate<T,B>& other){
+    //Lanes not in mask keep their estimate
+    p0 = mask.select(other.p0, p0); p1 = mask.select(other.p1, p1);
+    p2 = mask.select(other.p2, p2); p3 = mask.select(other.p3, p3);
+    c00 = mask.select(other.c00, c00); c11 = mask.select(other.c11, c11);
+    c22 = mask.select(other.c22, c22); c33 = mask.select(other.c33, c33);
+    c02 = mask.select(other.c02, c02); c13 = mask.select(other.c13, c13);
+  }
+
+  template <typename T, size_t B>
+  template <size_t N>
+  inline void BatchEstimate<T,B>::getLane(size_t lane, TrackEstimate<T,N>& e) const {
+    e.params(0) = p0(lane); e.params(1) = p1(lane);
+    e.params(2) = p2(lane); e.params(3) = p3(lane);
+    e.cov.setZero();
+    e.cov(0,0) = c00(lane); e.cov(1,1) = c11(lane);
+    e.cov(2,2) = c22(lane); e.cov(3,3) = c33(lane);
+    e.cov(0,2) = e.cov(2,0) = c02(lane);
+    e.cov(1,3) = e.cov(3,1) = c13(lane);
+  }
+
+  template <typename T, size_t B>
+  void BatchFitter<T,B>::init(int nPlanes){
+    //Per plane storage of the lanes
+    forward.resize(nPlanes);
+    backward.resize(nPlanes);
+    smoothed.resize(nPlanes);
+    measZ.resize(nPlanes);
+    totWeight.resize(nPlanes);
+    weights.resize(nPlanes);
+  }
+
+  template <typename T, size_t B>
+  template <size_t N>
+  void BatchFitter<T,B>::gatherWeights(const std::vector<FitPlane<T> >& pl,
+				       const std::vector<TrackCandidate<T,N> >& candidates,
+				       size_t first, size_t nLanes){
+    //Transpose the weights of the candidates into lanes, unused lanes get no weight
+    for(size_t plane = 0; plane < pl.size(); plane++){
+      size_t nMeas = pl.at(plane).meas.size();
+      PlaneLanes& planeWeights = weights.at(plane);
+      planeWeights.resize(nMeas);
+      for(size_t m = 0; m < nMeas; m++){
+	planeWeights[m].setZero();
+	for(size_t lane = 0; lane < nLanes; lane++){
+	  const Eigen::Matrix<T, Eigen::Dynamic, 1>& w = candidates.at(first + lane).weights.at(plane);
+	  if(static_cast<size_t>(w.size()) > m){ planeWeights[m](lane) = w(m); }
+	}
+      }
+    }
+  }
+
+  template <typename T, size_t B>
+  inline void BatchFitter<T,B>::predictInfo(size_t prev, size_t cur, BatchEstimate<T,B>& e){
+    //Same as EigenFitter::predictInfo, each lane has its own measurement z
+    Lanes dz = measZ[prev] - measZ[cur];
+    Lanes c02 = e.c02;
+    Lanes c13 = e.c13;
+
+    e.c02 += dz * e.c00;
+    e.c13 += dz * e.c11;
+    //NOTE c02 is no longer equal to e.c02! Same goes for c13.
+    e.c22 += dz * c02 + dz * e.c02;
+    e.c33 += dz * c13 + dz * e.c13;
+
+    //Information vector becomes
+    e.p2 += dz * e.p0;
+    e.p3 += dz * e.p1;
+  }
+
+  template <typename T, size_t B>
+  inline void BatchFitter<T,B>::addScatteringInfo(const FitPlane<T>& pl, BatchEstimate<T,B>& e){
+    //Same as EigenFitter::addScatteringInfo
+    T invScatter = 1.0f/ pl.getScatterThetaSqr();
+    Lanes scattervar2 = (e.c22 + invScatter).inverse();
+    Lanes scattervar3 = (e.c33 + invScatter).inverse();
+    Lanes c20 = e.c02;
+    Lanes c31 = e.c13;
+    Lanes c22 = e.c22;
+    Lanes c33 = e.c33;
+    e.c00 -= c20 * c20 * scattervar2;
+    e.c02 -= c22 * c20 * scattervar2;
+    e.c11 -= c31 * c31 * scattervar3;
+    e.c13 -= c31 * c33 * scattervar3;
+    e.c22 -= c22 * c22 * scattervar2;
+    e.c33 -= c33 * c33 * scattervar3;
+
+    Lanes p2 = e.p2;
+    Lanes p3 = e.p3;
+    e.p0 -= scattervar2 * c20 * p2;
+    e.p1 -= scattervar3 * c31 * p3;
+    e.p2 -= scattervar2 * c22 * p2;
+    e.p3 -= scattervar3 * c33 * p3;
+  }
+
+  template <typename T, size_t B>
+  inline void BatchFitter<T,B>::updateInfoDaf(const FitPlane<T>& pl, size_t plane, BatchEstimate<T,B>& e){
+    //Same as EigenFitter::updateInfoDaf, the weights are taken from the lanes
+    if(pl.isExcluded()) { return;}
+    e.c00 += pl.invMeasVar(0) * totWeight[plane];
+    e.c11 += pl.invMeasVar(1) * totWeight[plane];
+    const PlaneLanes& planeWeights = weights[plane];
+    for(size_t ii = 0 ; ii < pl.meas.size(); ii++){
+      e.p0 += planeWeights[ii] * (pl.meas[ii].getX() * pl.invMeasVar(0));
+      e.p1 += planeWeights[ii] * (pl.meas[ii].getY() * pl.invMeasVar(1));
+    }
+  }
+
+  template <typename T, size_t B>
+  inline void BatchFitter<T,B>::getAvgInfo(const BatchEstimate<T,B>& e1, const BatchEstimate<T,B>& e2,
+					   BatchEstimate<T,B>& result){
+    //Same as EigenFitter::getAvgInfo, fastInvert done per block
+    Lanes c00 = e1.c00 + e2.c00;
+    Lanes c11 = e1.c11 + e2.c11;
+    Lanes c22 = e1.c22 + e2.c22;
+    Lanes c33 = e1.c33 + e2.c33;
+    Lanes c02 = e1.c02 + e2.c02;
+    Lanes c13 = e1.c13 + e2.c13;
+
+    Lanes det = (c00 * c22 - c02 * c02).inverse();
+    result.c00 = det * c22;
+    result.c22 = det * c00;
+    result.c02 = det * -c02;
+    det = (c11 * c33 - c13 * c13).inverse();
+    result.c11 = det * c33;
+    result.c33 = det * c11;
+    result.c13 = det * -c13;
+
+    Lanes x = e1.p0 + e2.p0;
+    Lanes y = e1.p1 + e2.p1;
+    Lanes dx = e1.p2 + e2.p2;
+    Lanes dy = e1.p3 + e2.p3;
+    result.p0 = result.c00 * x + result.c02 * dx;
+    result.p1 = result.c11 * y + result.c13 * dy;
+    result.p2 = result.c02 * x + result.c22 * dx;
+    result.p3 = result.c13 * y + result.c33 * dy;
+  }
+
+  template <typename T, size_t B>
+  void BatchFitter<T,B>::smoothInfo(const Mask& mask){
+    //Get smoothed estimates for all planes of the lanes in mask
+    BatchEstimate<T,B> result;
+    for(size_t ii = 0 ; ii < smoothed.size(); ii++){
+      getAvgInfo( forward[ii], backward[ii], result);
+      smoothed[ii].select(mask, result);
+    }
+  }
+
+  template <typename T, size_t B>
+  typename BatchFitter<T,B>::Lanes BatchFitter<T,B>::fitInfoDafInner(const std::vector<FitPlane<T> >& planes,
+								     const Mask& active){
+    //Same as TrackerSystem::fitPlanesInfoDafInner for the lanes in active
+    size_t nPlanes = planes.size();
+    BatchEstimate<T,B> e;
+    e.makeSeedInfo();
+
+    //Forward fitter
+    forward.at(0).select(active, e);
+    updateInfoDaf( planes.at(0), 0, e);
+    Lanes ndof = Lanes::Constant( -4.0f );
+    ndof += T(2) * totWeight.at(0);
+    for(size_t ii = 1; ii < nPlanes ; ii++ ){
+      if(not planes.at(ii).isExcluded()){
+	ndof += T(2) * totWeight.at(ii);
+      }
+      predictInfo( ii - 1, ii, e );
+      forward.at(ii).select(active, e);
+      updateInfoDaf( planes.at(ii), ii, e );
+      addScatteringInfo( planes.at(ii), e);
+    }
+    //No reason to complete unless >1 measurements are in
+    Mask complete = active;
+    for(size_t lane = 0; lane < B; lane++){
+      if(ndof(lane) < -2.1) { complete(lane) = false; }
+    }
+    if(not complete.any()) { return(ndof);}
+
+    //Backward fitter, never bias
+    e.makeSeedInfo();
+    backward.at( nPlanes -1 ).select(complete, e);
+    updateInfoDaf( planes.at(nPlanes -1 ), nPlanes -1, e );
+    for(int ii = nPlanes -2; ii >= 0; ii-- ){
+      predictInfo( ii + 1, ii, e );
+      addScatteringInfo( planes.at(ii), e);
+      backward.at(ii).select(complete, e);
+      updateInfoDaf( planes.at(ii), ii, e );
+    }
+
+    smoothInfo(complete);
+    return(ndof);
+  }
+}
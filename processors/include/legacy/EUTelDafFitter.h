@@ -65,6 +65,8 @@ namespace eutelescope {
     bool _addToLCIO;
     //! switch to include DUT in track fit
     bool _fitDuts;
+    //! switch to fit the candidates of an event in batches
+    bool _batchedFit;
   };
   //! A global instance of the processor
   EUTelDafFitter gEUTelDafFitter;
@@ -50,6 +50,8 @@ namespace eutelescope {
     // Alignment
     std::vector<int> _shiftXIndex, _shiftYIndex, _scaleXIndex, _scaleYIndex,
         _zRotIndex, _zPosIndex;
+    //! Number of threads used by the minimizer
+    int _noOfThreads;
 
   public:
     // Marlin processor interface funtions
@@ -56,6 +56,8 @@ namespace daffitter {
     // Results from fit
     T chi2, ndof;
     std::vector<TrackEstimate<T, N>> estimates;
+    // Measurement z positions found by the DAF fit, per plane
+    std::vector<T> measZ;
     void print();
     void init(int nPlanes);
     TrackCandidate(int nPlanes);
@@ -148,6 +150,40 @@ namespace daffitter {
     void print();
   };
 
+  // Hits projected into z = 0 for the cluster tracker, binned in one grid per
+  // plane. Cells are at least as large as the cluster radius, so all hits
+  // closer than the radius to a hit are in the 3x3 cells around its cell.
+  template <typename T> class HitGrid {
+  private:
+    std::vector<T> x, y;
+    std::vector<int> plane, index;
+    std::vector<char> used;
+    // Hit indexes sorted by plane and cell, the hits of cell c on plane p are
+    // sorted[cellStart[p * nCells + c]] up to sorted[cellStart[p * nCells + c + 1]]
+    std::vector<size_t> sorted, cellStart, cellOf;
+    size_t nPlanes, nCellX, nCellY, nCells;
+    double x0, y0, cellX, cellY;
+
+    size_t getCell(T hx, T hy) const;
+    void addFromCells(size_t first, size_t last, size_t hit, T sqrRadius,
+                      std::vector<size_t> &cluster);
+
+  public:
+    HitGrid()
+        : nPlanes(0), nCellX(1), nCellY(1), nCells(2), x0(0), y0(0), cellX(1),
+          cellY(1) {}
+    void clear(size_t nPlanes);
+    void addHit(int plane, int index, T x, T y);
+    void build(T sqrRadius);
+    size_t size() const { return (x.size()); }
+    bool isUsed(size_t hit) const { return (used[hit] != 0); }
+    int getPlane(size_t hit) const { return (plane[hit]); }
+    int getIndex(size_t hit) const { return (index[hit]); }
+    // Collect the unused hits connected to seed by steps no longer than the
+    // radius into cluster, and mark them as used
+    void collectCluster(size_t seed, T sqrRadius, std::vector<size_t> &cluster);
+  };
+
   template <typename T, size_t N> class EigenFitter {
     // Eigen recommends fixed size matrixes up to 4x4
     Eigen::Matrix<T, N, N> transM, transMtranspose, tmpNxN, tmpNxN_2, tmpNxN_3;
@@ -202,19 +238,86 @@ namespace daffitter {
                   TrackEstimate<T, N> &e);
   };
 
+  template <typename T, size_t B> class BatchEstimate {
+    // Information filter estimates of B track candidates, one lane per
+    // candidate. Only the elements populated by the information filter are
+    // stored: the information vector and the [x,dx/dz], [y,dy/dz] blocks of
+    // the information matrix.
+  public:
+    typedef Eigen::Array<T, B, 1> Lanes;
+    typedef Eigen::Array<bool, B, 1> Mask;
+    Lanes p0, p1, p2, p3;
+    Lanes c00, c11, c22, c33, c02, c13;
+
+    void makeSeedInfo();
+    // Take the lanes set in mask from other
+    void select(const Mask &mask, const BatchEstimate<T, B> &other);
+    // Copy one lane into a TrackEstimate
+    template <size_t N> void getLane(size_t lane, TrackEstimate<T, N> &e) const;
+  };
+
+  template <typename T, size_t B> class BatchFitter {
+    // Structure of arrays implementation of the weighted information filter
+    // used by the DAF. B track candidates of the same event are fitted
+    // together, plane by plane, each lane follows the arithmetic of
+    // EigenFitter. The results agree with a fit of the candidate on its own
+    // within float rounding.
+  public:
+    typedef typename BatchEstimate<T, B>::Lanes Lanes;
+    typedef typename BatchEstimate<T, B>::Mask Mask;
+    typedef std::vector<BatchEstimate<T, B>,
+                        Eigen::aligned_allocator<BatchEstimate<T, B>>>
+        Estimates;
+    typedef std::vector<Lanes, Eigen::aligned_allocator<Lanes>> PlaneLanes;
+
+    Estimates forward, backward, smoothed;
+    // Per plane: measurement z position and sum of DAF weights of each lane
+    PlaneLanes measZ, totWeight;
+    // Per plane and measurement: DAF weight of each lane
+    std::vector<PlaneLanes> weights;
+
+    void init(int nPlanes);
+    static size_t getWidth() { return (B); }
+    // Collect the DAF weights of nLanes candidates, starting at first
+    template <size_t N>
+    void gatherWeights(const std::vector<FitPlane<T>> &pl,
+                       const std::vector<TrackCandidate<T, N>> &candidates,
+                       size_t first, size_t nLanes);
+
+    // Weighted information filter
+    void predictInfo(size_t prev, size_t cur, BatchEstimate<T, B> &e);
+    void addScatteringInfo(const FitPlane<T> &pl, BatchEstimate<T, B> &e);
+    void updateInfoDaf(const FitPlane<T> &pl, size_t plane,
+                       BatchEstimate<T, B> &e);
+    void getAvgInfo(const BatchEstimate<T, B> &e1,
+                    const BatchEstimate<T, B> &e2, BatchEstimate<T, B> &result);
+    void smoothInfo(const Mask &mask);
+    // Forward, backward and smoothed estimates of the lanes set in active,
+    // returns the ndof of each lane
+    Lanes fitInfoDafInner(const std::vector<FitPlane<T>> &pl,
+                          const Mask &active);
+  };
+
   template <typename T, size_t N> class TrackerSystem {
+    // Batches of 8 candidates fill two SSE or one AVX register of floats
+    typedef BatchFitter<T, 8> DafBatchFitter;
     bool m_inited;
     size_t m_nTracks, m_maxCandidates, m_minClusterSize;
 
     T m_nXdz, m_nYdz, m_nXdzdeviance, m_nYdzdeviance;
     T m_dafChi2, m_ckfChi2, m_chi2OverNdof, m_sqrClusterRadius;
     size_t m_skipMax;
+    // Cluster tracker storage, kept to avoid allocations per event
+    HitGrid<T> m_hitGrid;
+    std::vector<size_t> m_clusterHits;
 
-    int addNeighbors(std::vector<PlaneHit<T>> &candidate,
-                     std::list<PlaneHit<T>> &hits);
     T runTweight(T t, daffitter::TrackCandidate<T, N> &candidate);
     T fitPlanesInfoDafInner(daffitter::TrackCandidate<T, N> &candidate);
     T fitPlanesInfoDafBiased(daffitter::TrackCandidate<T, N> &candidate);
+    T getIntersectionZ(FitPlane<T> &pl, T measZ, TrackEstimate<T, N> &estim);
+    void runTweightBatch(T t, size_t first, size_t nLanes,
+                         const typename DafBatchFitter::Mask &active,
+                         typename DafBatchFitter::Lanes &ndof);
     size_t getMinClusterSize() const { return (m_minClusterSize); }
     void checkNan(TrackEstimate<T, N> &e);
     // CKF
@@ -225,6 +328,7 @@ namespace daffitter {
 
   public:
     EigenFitter<T, N> m_fitter;
+    DafBatchFitter m_batchFitter;
     std::vector<daffitter::FitPlane<T>> planes;
     std::vector<daffitter::TrackCandidate<T, N>> tracks;
 
@@ -279,6 +383,13 @@ namespace daffitter {
     void fitPlanesInfoBiased(daffitter::TrackCandidate<T, N> &candidate);
     void fitPlanesInfoUnBiased(daffitter::TrackCandidate<T, N> &candidate);
     void fitPlanesInfoDaf(daffitter::TrackCandidate<T, N> &candidate);
+    // Same as fitPlanesInfoDaf, for count candidates starting at first,
+    // fitted together by m_batchFitter
+    void fitPlanesInfoDafBatch(size_t first, size_t count);
+    // Run fitPlanesInfoDafBatch on all track candidates
+    void fitPlanesInfoDafBatched();
+    // Set the plane z positions to the ones found by the fit of candidate
+    void restoreMeasZ(const daffitter::TrackCandidate<T, N> &candidate);
     void fitPlanesKF(daffitter::TrackCandidate<T, N> &candidate);
     // partial fitters
     void fitInfoFWBiased(TrackCandidate<T, N> &candidate);
@@ -321,6 +432,7 @@ namespace daffitter {
   }
 }
 #include <EUTelDafEigenFitter.tcc>
+#include <EUTelDafBatchFitter.tcc>
 #include <EUTelDafTrackerSystem.tcc>
 
 #endif
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <algorithm>
+#include <limits>
 #include <Eigen/Core>
 
 using namespace std;
@@ -71,6 +72,7 @@ void TrackCandidate<T,N>::init(int nPlanes){
   indexes.resize(nPlanes);
   weights.resize(nPlanes);
   estimates.resize(nPlanes);
+  measZ.resize(nPlanes);
 }
 
 template<typename T, size_t N>
@@ -223,6 +225,7 @@ void TrackerSystem<T, N>::init(bool quiet){
     }
   }
   m_fitter.init(planes.size());
+  m_batchFitter.init(planes.size());
   m_inited = true;
 }
 
@@ -257,21 +260,120 @@ inline bool clusterSort(PlaneHit<T>& a, PlaneHit<T>& b) {
   return( a.getM().squaredNorm() > b.getM().squaredNorm()  ); 
 }
 
-template <typename T,size_t N>
-inline int TrackerSystem<T, N>::addNeighbors(vector<PlaneHit<T> > &candidate, list<PlaneHit<T> > &hits){
-  // Part of the cluster tracker. Checks distances to measurements, and adds measurement to cluster maybe.
-  int counter(0); //How many hits are added to the cluster this iteration?
-  for(typename list<PlaneHit<T> >::iterator hit = hits.begin(); hit != hits.end(); hit++ ){
-    for(typename vector<PlaneHit<T> >::iterator cand = candidate.begin(); cand != candidate.end(); cand++){
-      Eigen::Matrix<T, 2, 1> resids = (*hit).getM() - (*cand).getM();
-      if(resids.squaredNorm() > m_sqrClusterRadius ) { continue;}
-      candidate.push_back((*hit));
-      hit = hits.erase(hit);
-      counter ++;
-      break;
+template <typename T>
+void HitGrid<T>::clear(size_t nPl){
+  //Remove all hits, keeps the storage
+  nPlanes = nPl;
+  x.clear(); y.clear();
+  plane.clear(); index.clear();
+}
+
+template <typename T>
+void HitGrid<T>::addHit(int pl, int idx, T hx, T hy){
+  //Hits have to be added ordered by plane
+  x.push_back(hx); y.push_back(hy);
+  plane.push_back(pl); index.push_back(idx);
+}
+
+template <typename T>
+inline size_t HitGrid<T>::getCell(T hx, T hy) const {
+  //Cells are numbered x first, the last cell holds hits without finite coordinates
+  if(not (std::isfinite(hx) and std::isfinite(hy))) { return(nCells - 1); }
+  if(nCells == 2) { return(0); }
+  size_t ix = std::min(static_cast<size_t>((hx - x0) / cellX), nCellX - 1);
+  size_t iy = std::min(static_cast<size_t>((hy - y0) / cellY), nCellY - 1);
+  return(iy * nCellX + ix);
+}
+
+template <typename T>
+void HitGrid<T>::build(T sqrRadius){
+  //Bin the hits, the cells are at least as large as the radius plus the rounding of the distances
+  size_t nHits = x.size();
+  used.assign(nHits, 0);
+  double minX(std::numeric_limits<double>::max()), maxX(std::numeric_limits<double>::lowest());
+  double minY(minX), maxY(maxX), maxAbs(0.0);
+  for(size_t ii = 0; ii < nHits; ii++){
+    if(not (std::isfinite(x[ii]) and std::isfinite(y[ii]))) { continue; }
+    double hx(x[ii]), hy(y[ii]);
+    minX = std::min(minX, hx); maxX = std::max(maxX, hx);
+    minY = std::min(minY, hy); maxY = std::max(maxY, hy);
+    maxAbs = std::max(maxAbs, std::max(std::abs(hx), std::abs(hy)));
+  }
+  double sqrR(sqrRadius);
+  double cellSize = std::sqrt(sqrR) * (1.0 + 1e-4) + 4.0 * std::numeric_limits<T>::epsilon() * maxAbs;
+  //About as many cells per plane as hits in total
+  size_t maxCells = 1 + static_cast<size_t>(std::sqrt(static_cast<double>(nHits)));
+  nCellX = nCellY = 1;
+  x0 = y0 = 0.0;
+  cellX = cellY = 1.0;
+  //A single cell if there are no finite hits or every distance is accepted
+  if(minX <= maxX and cellSize > 0 and std::isfinite(cellSize)){
+    x0 = minX; y0 = minY;
+    cellX = std::max(cellSize, (maxX - minX) / maxCells);
+    cellY = std::max(cellSize, (maxY - minY) / maxCells);
+    nCellX = std::min(maxCells, static_cast<size_t>((maxX - minX) / cellX) + 1);
+    nCellY = std::min(maxCells, static_cast<size_t>((maxY - minY) / cellY) + 1);
+  }
+  nCells = nCellX * nCellY + 1;
+
+  //Counting sort by plane and cell, keeps the order of the hits within a cell
+  cellOf.resize(nHits);
+  cellStart.assign(nPlanes * nCells + 1, 0);
+  for(size_t ii = 0; ii < nHits; ii++){
+    cellOf[ii] = getCell(x[ii], y[ii]);
+    cellStart[plane[ii] * nCells + cellOf[ii] + 1]++;
+  }
+  for(size_t ii = 1; ii < cellStart.size(); ii++){ cellStart[ii] += cellStart[ii - 1]; }
+  sorted.resize(nHits);
+  for(size_t ii = 0; ii < nHits; ii++){
+    sorted[cellStart[plane[ii] * nCells + cellOf[ii]]++] = ii;
+  }
+  //Filling moved every start to the start of the next cell
+  for(size_t ii = cellStart.size() - 1; ii > 0; ii--){ cellStart[ii] = cellStart[ii - 1]; }
+  cellStart[0] = 0;
+}
+
+template <typename T>
+inline void HitGrid<T>::addFromCells(size_t first, size_t last, size_t hit, T sqrRadius, vector<size_t>& cluster){
+  //Add unused hits of the consecutive cells first to last - 1 that are close to hit
+  for(size_t ii = cellStart[first]; ii < cellStart[last]; ii++){
+    size_t other = sorted[ii];
+    if(used[other]) { continue; }
+    T dx = x[other] - x[hit];
+    T dy = y[other] - y[hit];
+    if(dx * dx + dy * dy > sqrRadius) { continue; }
+    used[other] = 1;
+    cluster.push_back(other);
+  }
+}
+
+template <typename T>
+void HitGrid<T>::collectCluster(size_t seed, T sqrRadius, vector<size_t>& cluster){
+  //Flood fill from seed, looking at neighbouring cells on all planes
+  cluster.clear();
+  cluster.push_back(seed);
+  used[seed] = 1;
+  for(size_t cc = 0; cc < cluster.size(); cc++){
+    size_t hit = cluster[cc];
+    size_t cell = cellOf[hit];
+    for(size_t pl = 0; pl < nPlanes; pl++){
+      size_t base = pl * nCells;
+      //Hits without finite coordinates are compared to all
+      if(cell == nCells - 1){
+	addFromCells(base, base + nCells, hit, sqrRadius, cluster);
+	continue;
+      }
+      size_t ix = cell % nCellX;
+      size_t iy = cell / nCellX;
+      size_t xLow = ix > 0 ? ix - 1 : 0;
+      size_t xHigh = std::min(ix + 1, nCellX - 1);
+      size_t yHigh = std::min(iy + 1, nCellY - 1);
+      for(size_t yy = iy > 0 ? iy - 1 : 0; yy <= yHigh; yy++){
+	addFromCells(base + yy * nCellX + xLow, base + yy * nCellX + xHigh + 1, hit, sqrRadius, cluster);
+      }
+      addFromCells(base + nCells - 1, base + nCells, hit, sqrRadius, cluster);
     }
   }
-  return (counter);
 }
 
 template <typename T,size_t N>
@@ -290,27 +392,24 @@ void TrackerSystem<T, N>::index0tracker(){
 template <typename T,size_t N>
 void TrackerSystem<T, N>::clusterTracker(){
   //A track fitter that propagates measurements into z = 0, then assumes measurement clusters are track candidates.
-  list<PlaneHit<T> > availableHits;
-  //Add all meas points to list
+  //A cluster holds all hits connected to its first hit by steps within the cluster radius.
+  m_hitGrid.clear(planes.size());
+  //Add all meas points to the grid
   for(size_t ii = 0; ii < planes.size(); ii++){
     if(planes.at(ii).isExcluded()) { continue;}
     T xShift = -1 * getNominalXdz() * planes.at(ii).getZpos();
     T yShift = -1 * getNominalYdz() * planes.at(ii).getZpos();
     for(size_t mm = 0; mm < planes.at(ii).meas.size(); mm++){
-      PlaneHit<T> a(planes.at(ii).meas.at(mm).getX() + xShift, planes.at(ii).meas.at(mm).getY() + yShift, ii, mm);
-      availableHits.push_back( a );
+      m_hitGrid.addHit(ii, mm, planes.at(ii).meas.at(mm).getX() + xShift, planes.at(ii).meas.at(mm).getY() + yShift);
     }
   }
-  //Sort by radius from origin
-  //availableHits.sort(clusterSort<T>);
-  while( not availableHits.empty() ){
-    vector<PlaneHit<T> > candidate;
-    candidate.push_back( availableHits.front() );
-    availableHits.pop_front();
-    while( addNeighbors( candidate , availableHits ) > 0) {;}
+  m_hitGrid.build(m_sqrClusterRadius);
+  for(size_t seed = 0; seed < m_hitGrid.size(); seed++){
+    if(m_hitGrid.isUsed(seed)) { continue; }
+    m_hitGrid.collectCluster(seed, m_sqrClusterRadius, m_clusterHits);
     //If we find enough hits, we make a candidate
 
-    if(candidate.size() < getMinClusterSize() ){ continue; }
+    if(m_clusterHits.size() < getMinClusterSize() ){ continue; }
     if(m_nTracks >= m_maxCandidates) {
       std::cout << "Maximum number of track candidates(" << m_maxCandidates 
 		<< ") reached in DAF fitter! If this happens a lot, your configuration is probably off." 
@@ -328,9 +427,9 @@ void TrackerSystem<T, N>::clusterTracker(){
 	cnd.weights.at(ii).setZero();
       }
     }
-    for(size_t ii = 0; ii < candidate.size(); ii++){
-      PlaneHit<T>& hit = candidate.at(ii);
-      cnd.weights.at( hit.getPlane() )( hit.getIndex()) = 1.0;
+    for(size_t ii = 0; ii < m_clusterHits.size(); ii++){
+      size_t hit = m_clusterHits.at(ii);
+      cnd.weights.at( m_hitGrid.getPlane(hit) )( m_hitGrid.getIndex(hit)) = 1.0;
     }
     tracks.push_back(cnd);
     m_nTracks++;
@@ -549,28 +648,33 @@ void TrackerSystem<T, N>::getChi2UnBiasedInfoDaf(TrackCandidate<T, N>& candidate
   if(isnan(candidate.chi2)){ cout << "NAN CHI2" << endl << endl;}
 }
 
+template <typename T,size_t N>
+T TrackerSystem<T, N>::getIntersectionZ(FitPlane<T>& pl, T measZ, TrackEstimate<T, N>& estim){
+  //Check where a straight line track intersects with a measurement plane, starting from the measurement z position measZ
+  //Line intersects with plane where
+  // d = (p0 - l0) . n / ( l . n )
+  // p0 is refpoint in plane
+  Eigen::Matrix<T, 3, 1>& refPoint = pl.getRef0();
+  // n is vector normal of plane
+  Eigen::Matrix<T, 3, 1>& normVec = pl.getPlaneNorm();
+  // l, point at line is defined by esimate x, y, and prev z
+  Eigen::Matrix<T, 3, 1> linePoint( estim.getX(), estim.getY(), measZ );
+  // l, unit direction of line is normal of dx/dz, dy/dz, 1.0
+  Eigen::Matrix<T, 3, 1> lineDir( estim.getXdz(), estim.getYdz(), 1.0f);
+  lineDir = lineDir.normalized();
+  // p0 - l0
+  Eigen::Matrix<T, 3, 1> distance = refPoint - linePoint;
+  T d = normVec.dot(distance) / normVec.dot(lineDir);
+  //Propagate along track to track/plane intersection
+  return( measZ + d * lineDir(2));
+}
+
 template <typename T,size_t N>
 void TrackerSystem<T, N>::intersect(){
   //Check where a straight line track intersects with a measurement plane, update the measurement z position
   for(size_t plane = 0; plane < planes.size(); plane++ ){
     FitPlane<T>& pl = planes.at(plane);
-    TrackEstimate<T,N>& estim = m_fitter.smoothed.at(plane);
-    //Line intersects with plane where
-    // d = (p0 - l0) . n / ( l . n )
-    // p0 is refpoint in plane
-    Eigen::Matrix<T, 3, 1>& refPoint = pl.getRef0();
-    // n is vector normal of plane
-    Eigen::Matrix<T, 3, 1>& normVec = pl.getPlaneNorm();
-    // l, point at line is defined by esimate x, y, and prev z
-    Eigen::Matrix<T, 3, 1> linePoint( estim.getX(), estim.getY(), pl.getMeasZ() );
-    // l, unit direction of line is normal of dx/dz, dy/dz, 1.0
-    Eigen::Matrix<T, 3, 1> lineDir( estim.getXdz(), estim.getYdz(), 1.0f);
-    lineDir = lineDir.normalized();
-    // p0 - l0
-    Eigen::Matrix<T, 3, 1> distance = refPoint - linePoint;
-    T d = normVec.dot(distance) / normVec.dot(lineDir);
-    //Propagate along track to track/plane intersection
-    pl.setMeasZ( pl.getMeasZ() + d * lineDir(2));
+    pl.setMeasZ( getIntersectionZ(pl, pl.getMeasZ(), m_fitter.smoothed.at(plane)) );
   }
 }
 
@@ -623,6 +727,132 @@ void TrackerSystem<T, N>::fitPlanesInfoDaf(TrackCandidate<T, N>& candidate){
     candidate.ndof = ndof;
     candidate.chi2 = 0;
   }
+  for(size_t ii = 0; ii < planes.size() ; ii++ ){
+    candidate.measZ.at(ii) = planes.at(ii).getMeasZ();
+  }
+}
+
+template <typename T,size_t N>
+void TrackerSystem<T, N>::runTweightBatch(T t, size_t first, size_t nLanes,
+					  const typename DafBatchFitter::Mask& active,
+					  typename DafBatchFitter::Lanes& ndof){
+  //A DAF iteration with temperature t for the lanes in active, see runTweight
+  m_fitter.setT(t);
+  TrackEstimate<T,N> estim;
+  for(size_t lane = 0; lane < nLanes; lane++){
+    if(not active(lane)) { continue; }
+    TrackCandidate<T,N>& candidate = tracks.at(first + lane);
+    for(size_t plane = 0; plane < planes.size(); plane++){
+      m_batchFitter.smoothed.at(plane).getLane(lane, estim);
+      m_fitter.calculatePlaneWeight( planes[plane], estim, getDAFChi2Cut(), candidate.weights.at(plane));
+      m_batchFitter.totWeight.at(plane)(lane) = planes.at(plane).getTotWeight();
+    }
+  }
+  m_batchFitter.gatherWeights(planes, tracks, first, nLanes);
+  typename DafBatchFitter::Lanes innerNdof = m_batchFitter.fitInfoDafInner(planes, active);
+  for(size_t lane = 0; lane < nLanes; lane++){
+    if(not active(lane)) { continue; }
+    for(size_t plane = 0; plane < planes.size(); plane++){
+      T& measZ = m_batchFitter.measZ.at(plane)(lane);
+      m_batchFitter.smoothed.at(plane).getLane(lane, estim);
+      measZ = getIntersectionZ(planes.at(plane), measZ, estim);
+    }
+    ndof(lane) = innerNdof(lane);
+  }
+}
+
+template <typename T,size_t N>
+void TrackerSystem<T, N>::fitPlanesInfoDafBatch(size_t first, size_t count){
+  // Same as fitPlanesInfoDaf for the candidates [first, first + count), at most the batch width.
+  // The weights, the annealing schedule and the chi2 are handled per candidate, the
+  // filtering and smoothing is done by the batch fitter for all candidates together.
+  // All candidates start from the current measurement z positions of the planes,
+  // afterwards the system is left as by a fit of the last candidate. A candidate
+  // failing the fit leaves undefined z positions to the next one in a sequential
+  // fit, within a batch it does not affect the others.
+  typedef typename DafBatchFitter::Lanes Lanes;
+  typedef typename DafBatchFitter::Mask Mask;
+  size_t nLanes = std::min(count, m_batchFitter.getWidth());
+  Mask used = Mask::Constant(false);
+  Lanes ndof = Lanes::Constant(-10.0f);
+
+  for(size_t plane = 0; plane < planes.size(); plane++ ){
+    m_batchFitter.measZ.at(plane).setConstant( planes.at(plane).getMeasZ() );
+    m_batchFitter.totWeight.at(plane).setZero();
+  }
+  for(size_t lane = 0; lane < nLanes; lane++){
+    TrackCandidate<T,N>& candidate = tracks.at(first + lane);
+    used(lane) = true;
+    T cndNdof = -4.0f;
+    for(size_t plane = 0; plane < planes.size(); plane++ ){
+      //set tot weight per plane
+      T totWeight = 0.0f;
+      if ( candidate.weights.at(plane).size() > 0 ){
+	totWeight = candidate.weights.at(plane).sum();
+      }
+      if( totWeight > 1.0f){
+	candidate.weights.at(plane) *= 1.0f / totWeight;
+	totWeight = 1.0f;
+      }
+      m_batchFitter.totWeight.at(plane)(lane) = totWeight;
+      cndNdof += totWeight * 2.0;
+    }
+    if(isnan(cndNdof)) { cndNdof = -10.0; }
+    ndof(lane) = cndNdof;
+  }
+  m_batchFitter.gatherWeights(planes, tracks, first, nLanes);
+  m_batchFitter.fitInfoDafInner(planes, used);
+
+  // Running with fixed annealing schedule.
+  const T temperatures[] = {25.0, 20.0, 14.0, 8.0, 4.0, 1.0};
+  const T minNdof[] = {-1.0f, -1.0f, -1.9f, -1.9f, -1.9f, -1.9f};
+  for(size_t step = 0; step < 6; step++){
+    Mask active = used;
+    for(size_t lane = 0; lane < nLanes; lane++){
+      if(not (ndof(lane) > minNdof[step])) { active(lane) = false; }
+    }
+    if(active.any()) { runTweightBatch(temperatures[step], first, nLanes, active, ndof); }
+  }
+
+  for(size_t lane = 0; lane < nLanes; lane++){
+    TrackCandidate<T,N>& candidate = tracks.at(first + lane);
+    for(size_t ii = 0; ii < planes.size() ; ii++ ){
+      m_batchFitter.forward.at(ii).getLane(lane, m_fitter.forward.at(ii));
+      m_batchFitter.backward.at(ii).getLane(lane, m_fitter.backward.at(ii));
+      m_batchFitter.smoothed.at(ii).getLane(lane, m_fitter.smoothed.at(ii));
+      planes.at(ii).setMeasZ( m_batchFitter.measZ.at(ii)(lane) );
+      planes.at(ii).setTotWeight( m_batchFitter.totWeight.at(ii)(lane) );
+      candidate.measZ.at(ii) = planes.at(ii).getMeasZ();
+    }
+    if(ndof(lane) > -1.9f) {
+      for(size_t ii = 0; ii < planes.size() ; ii++ ){
+	//Store estimates and weights in candidate
+	candidate.estimates.at(ii) = m_fitter.smoothed.at(ii);
+      }
+      getChi2UnBiasedInfoDaf(candidate);
+      weightToIndex(candidate);
+    } else{
+      candidate.ndof = ndof(lane);
+      candidate.chi2 = 0;
+    }
+  }
+}
+
+template <typename T,size_t N>
+void TrackerSystem<T, N>::fitPlanesInfoDafBatched(){
+  // Run the DAF on all track candidates, in batches
+  size_t width = m_batchFitter.getWidth();
+  for(size_t first = 0; first < getNtracks(); first += width){
+    fitPlanesInfoDafBatch(first, std::min(width, getNtracks() - first));
+  }
+}
+
+template <typename T,size_t N>
+void TrackerSystem<T, N>::restoreMeasZ(const TrackCandidate<T, N>& candidate){
+  // Set the measurement z positions to the ones found by the DAF fit of candidate
+  for(size_t ii = 0; ii < planes.size() ; ii++ ){
+    planes.at(ii).setMeasZ( candidate.measZ.at(ii) );
+  }
 }
 
 template <typename T,size_t N>
@@ -8,6 +8,7 @@
 #include <iomanip>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
@@ -17,13 +18,8 @@
 #include <Eigen/Core>
 #include <Eigen/LU>
 
-#ifdef DOTHREAD
-#include <boost/bind.hpp>
-#include <boost/thread.hpp>
-#include <boost/thread/detail/thread_group.hpp>
-#endif
-
 #include "EUTelDafTrackerSystem.h"
+#include "EUTelThreadPool.h"
 //#include "simutils.h"
 #include <stdexcept>
 
@@ -111,26 +107,48 @@ public:
   void printAllFreeParams();
 };
 
+//! Figure of merit of the track sample, evaluated in chunks of tracks
+/*! The tracks are split into chunks of chunkSize tracks. With nThreads
+ *  larger than one the chunks are handed out dynamically to a persistent
+ *  thread pool, each worker fitting on its own copy of the tracker
+ *  system. Every chunk accumulates into its own partial sums, which are
+ *  combined in chunk order afterwards, so the result does not depend on
+ *  the number of threads or on the scheduling.
+ */
 class Minimizer {
   bool inited;
 
 public:
   EstMat &mat;
   FITTERTYPE retVal2;
+  //! Number of threads, has to be set before init()
   size_t nThreads;
+  //! Number of tracks per chunk
+  size_t chunkSize;
   FITTERTYPE result;
-#ifdef DOTHREAD
-  boost::mutex resultGurad;
-#endif
+  std::unique_ptr<eutelescope::EUTelThreadPool> threadPool;
+  //! One tracker system per worker
   vector<TrackerSystem<FITTERTYPE, 4>> systems;
+  //! Partial sum of each chunk, used by the chi2 like minimizers
+  vector<double> partialSums;
 
   // Minimizer(EstMat& mat) : mat(mat) {;}
-  Minimizer(EstMat &mat) : inited(false), mat(mat), nThreads(4) { ; }
+  Minimizer(EstMat &mat)
+      : inited(false), mat(mat), retVal2(0.0f), nThreads(1), chunkSize(64),
+        result(0.0f) {
+    ;
+  }
   virtual ~Minimizer() { ; };
 
   FITTERTYPE operator()(void);
-  virtual void operator()(size_t offset, size_t stride) = 0;
+  //! Evaluate the tracks [begin, end) into the partial sums of chunk
+  virtual void operator()(size_t chunk, size_t begin, size_t end,
+                          TrackerSystem<FITTERTYPE, 4> &system) = 0;
   void prepareThreads();
+  //! Reset the partial sums for noOfChunks chunks, called serially
+  virtual void preparePartials(size_t noOfChunks);
+  //! Combine the partial sums in chunk order into result and retVal2
+  virtual void combinePartials();
   virtual void init();
   virtual bool twoRetVals() { return (false); }
 };
@@ -138,7 +156,8 @@ public:
 class Chi2 : public Minimizer {
 public:
   Chi2(EstMat &mat) : Minimizer(mat) { ; }
-  virtual void operator()(size_t offset, size_t stride);
+  virtual void operator()(size_t chunk, size_t begin, size_t end,
+                          TrackerSystem<FITTERTYPE, 4> &system);
 };
 
 class FakeChi2 : public Minimizer {
@@ -153,30 +172,59 @@ public:
   FakeChi2(EstMat &mat) : Minimizer(mat), firstRun(false) { ; }
   void calibrate(TrackerSystem<FITTERTYPE, 4> &system);
   virtual void init();
-  virtual void operator()(size_t offset, size_t stride);
+  virtual void preparePartials(size_t noOfChunks);
+  virtual void operator()(size_t chunk, size_t begin, size_t end,
+                          TrackerSystem<FITTERTYPE, 4> &system);
 };
 
 class FakeAbsDev : public FakeChi2 {
 public:
   FakeAbsDev(EstMat &mat) : FakeChi2(mat) { ; }
-  virtual void operator()(size_t offset, size_t stride);
+  virtual void operator()(size_t chunk, size_t begin, size_t end,
+                          TrackerSystem<FITTERTYPE, 4> &system);
+};
+
+//! Sums of squared pulls of a chunk of tracks, used by SDR and FwBw
+struct PullSums {
+  std::vector<double> sqrPullXFW, sqrPullXBW, sqrPullYFW, sqrPullYBW;
+  std::vector<std::vector<double>> sqrParams;
+  double logL;
+  int nTracks;
+
+  explicit PullSums(size_t nPlanes)
+      : sqrPullXFW(nPlanes - 2, 0.0), sqrPullXBW(nPlanes - 2, 0.0),
+        sqrPullYFW(nPlanes - 2, 0.0), sqrPullYBW(nPlanes - 2, 0.0),
+        sqrParams(nPlanes - 3, std::vector<double>(4, 0.0)), logL(0.0),
+        nTracks(0) {
+    ;
+  }
+  //! Add the sums of another chunk
+  void add(PullSums const &other);
 };
 
 class SDR : public Minimizer {
 public:
   bool SDR1, SDR2, cholDec;
+  vector<PullSums> partialPulls;
   SDR(bool SDR1, bool SDR2, bool cholDec, EstMat &mat)
       : Minimizer(mat), SDR1(SDR1), SDR2(SDR2), cholDec(cholDec) {
     ;
   }
-  virtual void operator()(size_t offset, size_t stride);
+  virtual void preparePartials(size_t noOfChunks);
+  virtual void combinePartials();
+  virtual void operator()(size_t chunk, size_t begin, size_t end,
+                          TrackerSystem<FITTERTYPE, 4> &system);
 };
 
 class FwBw : public Minimizer {
 public:
   vector<FITTERTYPE> results2;
+  vector<PullSums> partialPulls;
   FwBw(EstMat &mat) : Minimizer(mat), results2(vector<FITTERTYPE>(4, 0.0)) { ; }
-  virtual void operator()(size_t offset, size_t stride);
+  virtual void preparePartials(size_t noOfChunks);
+  virtual void combinePartials();
+  virtual void operator()(size_t chunk, size_t begin, size_t end,
+                          TrackerSystem<FITTERTYPE, 4> &system);
   virtual bool twoRetVals() { return (true); };
 };
 
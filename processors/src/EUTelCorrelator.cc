@@ -50,9 +50,12 @@
 #include <Exceptions.h>
 
 // system includes <>
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -131,6 +134,13 @@ EUTelCorrelator::EUTelCorrelator()
                             "hits (planes->track candidate) (default=5)",
                             _minNumberOfCorrelatedHits,
 			    5);
+
+  registerOptionalParameter("ClusterCorrelationWindow",
+                            "Maximal difference of the cluster centres in X and Y "
+                            "for a cluster pair to be correlated, e.g. for pre-aligned "
+                            "data (default: no window)",
+                            _clusterCorrelationWindow,
+			    std::vector<float>());
 }
 
 void EUTelCorrelator::init() {
@@ -156,6 +166,12 @@ void EUTelCorrelator::init() {
        static_cast<int>(it - _sensorIDVec.begin())));
   }
 
+  if(!_clusterCorrelationWindow.empty() && _clusterCorrelationWindow.size() != 2) {
+    streamlog_out(ERROR) << "ClusterCorrelationWindow needs exactly two values (X and Y), "
+                         << _clusterCorrelationWindow.size() << " were given." << std::endl;
+    throw InvalidParameterException("ClusterCorrelationWindow");
+  }
+
   //reset run and event counters
   _iRun = 0;
   _iEvt = 0;
@@ -271,165 +287,143 @@ void EUTelCorrelator::processEvent(LCEvent *event) {
   
   //[IF] hasCluster
   if(_hasClusterCollection && !_hasHitCollection) {
-    
-    //[START] loop over collection (external)
-    for(size_t eCol = 0; eCol < _clusterCollectionVec.size(); eCol++) {
-    
-      std::string externalInputClusterCollectionName =
-	_clusterCollectionVec[eCol];
-      
-      LCCollectionVec *externalInputClusterCollection =
+
+    //decode every cluster once: sensor, centre of gravity and charge cuts
+    clearCorrelationEntries();
+
+    //[START] loop over collections
+    for(size_t iCol = 0; iCol < _clusterCollectionVec.size(); iCol++) {
+
+      LCCollectionVec *inputClusterCollection =
 	static_cast<LCCollectionVec *>(
-	   event->getCollection(externalInputClusterCollectionName));
-      CellIDDecoder<TrackerPulseImpl> pulseCellDecoder(
-          externalInputClusterCollection);
+	   event->getCollection(_clusterCollectionVec[iCol]));
+      CellIDDecoder<TrackerPulseImpl> pulseCellDecoder(inputClusterCollection);
 
-      //[START] loop over cluster (external)
-      for(size_t iExt = 0; iExt < externalInputClusterCollection->size();
-	  ++iExt) {
+      //[START] loop over clusters
+      for(size_t iClu = 0; iClu < inputClusterCollection->size(); ++iClu) {
 
-        TrackerPulseImpl *externalPulse = static_cast<TrackerPulseImpl *>(
-            externalInputClusterCollection->getElementAt(iExt));
+        TrackerPulseImpl *pulse = static_cast<TrackerPulseImpl *>(
+            inputClusterCollection->getElementAt(iClu));
+        TrackerDataImpl *clusterData =
+            static_cast<TrackerDataImpl *>(pulse->getTrackerData());
 
-        EUTelVirtualCluster *externalCluster;
+        std::unique_ptr<EUTelVirtualCluster> cluster;
 
         ClusterType type = static_cast<ClusterType>(
-            static_cast<int>((pulseCellDecoder(externalPulse)["type"])));
-	
+            static_cast<int>((pulseCellDecoder(pulse)["type"])));
+
         //check that the type of cluster is ok
         if(type == kEUTelDFFClusterImpl) {
-          externalCluster = new EUTelDFFClusterImpl(
-              static_cast<TrackerDataImpl *>(externalPulse->getTrackerData()));
+          cluster = std::make_unique<EUTelDFFClusterImpl>(clusterData);
         } else if(type == kEUTelBrickedClusterImpl) {
-          externalCluster = new EUTelBrickedClusterImpl(
-              static_cast<TrackerDataImpl *>(externalPulse->getTrackerData()));
+          cluster = std::make_unique<EUTelBrickedClusterImpl>(clusterData);
         } else if(type == kEUTelFFClusterImpl) {
-          externalCluster = new EUTelFFClusterImpl(
-              static_cast<TrackerDataImpl *>(externalPulse->getTrackerData()));
+          cluster = std::make_unique<EUTelFFClusterImpl>(clusterData);
         } else if(type == kEUTelSparseClusterImpl) {
-          externalCluster = new EUTelSparseClusterImpl<EUTelGenericSparsePixel>(
-              static_cast<TrackerDataImpl *>(externalPulse->getTrackerData()));
-          if(externalCluster != nullptr &&
-              externalCluster->getTotalCharge() < _clusterChargeMin) {
-            delete externalCluster;
-            continue;
-          }
+          cluster = std::make_unique<EUTelSparseClusterImpl<EUTelGenericSparsePixel>>(
+              clusterData);
         } else {
           continue;
-        }	
+        }
 
-        int externalSensorID = pulseCellDecoder(externalPulse)["sensorID"];
+        //check minimal charge requirement: internal clusters need at least,
+        //external ones more than the minimal charge
+        float charge = cluster->getTotalCharge();
+        if(charge < _clusterChargeMin) {
+          continue;
+        }
 
-        streamlog_out(DEBUG1) << "externalSensorID : " << externalSensorID
-                              << " externalCluster=" << externalCluster
-                              << std::endl;
+        int sensorID = pulseCellDecoder(pulse)["sensorID"];
 
-	//get coordinates of external seed
-        float externalXCenter = 0.;
-        float externalYCenter = 0.;
-        externalCluster->getCenterOfGravity(externalXCenter, externalYCenter);
-        
-        //check minimal charge requirement
-        if(externalCluster->getTotalCharge() <= _clusterChargeMin) {
-          delete externalCluster;
-          continue;
+	//get coordinates of the cluster centre
+        float xCenter = 0.;
+        float yCenter = 0.;
+        cluster->getCenterOfGravity(xCenter, yCenter);
+
+        streamlog_out(DEBUG1) << "sensorID : " << sensorID
+                              << " cluster=" << cluster.get() << std::endl;
+
+        _entrySensorID.push_back(sensorID);
+        _entryX.push_back(xCenter);
+        _entryY.push_back(yCenter);
+        _entryIsExternal.push_back(charge > _clusterChargeMin);
+        _entryIsInternal.push_back(true);
+      }//[END] loop over clusters
+    }//[END] loop over collections
+
+    indexCorrelationEntries();
+    bool useWindow = !_clusterCorrelationWindow.empty();
+
+    //safety margin for rounding in the window boundaries
+    double const margin = 1E-6;
+
+    //[START] loop over clusters (external)
+    for(size_t iExt = 0; iExt < _entryX.size(); ++iExt) {
+
+      if(!_entryIsExternal[iExt]) continue;
+
+      int externalSensorID = _entrySensorID[iExt];
+      double externalXCenter = _entryX[iExt];
+      double externalYCenter = _entryY[iExt];
+
+      //[START] loop over sensors (internal)
+      for(auto const &sensorEntries : _sensorEntries) {
+
+        int internalSensorID = sensorEntries.first;
+        if(sensorEntries.second.empty()) continue;
+
+        if(!((internalSensorID != getFixedPlaneID() &&
+              externalSensorID == getFixedPlaneID()) ||
+             (_sensorIDtoZ.at(internalSensorID) >
+              _sensorIDtoZ.at(externalSensorID)))) continue;
+
+        //clusters of this sensor, within the window if one is given
+        _correlatedEntries.clear();
+        if(useWindow) {
+          findCorrelationCandidates(sensorEntries.second,
+                                    externalXCenter - _clusterCorrelationWindow[0] - margin,
+                                    externalXCenter + _clusterCorrelationWindow[0] + margin);
+        } else {
+          for(auto const &entry : sensorEntries.second) {
+            _correlatedEntries.push_back(entry.second);
+          }
         }
+        //fill in the original cluster order
+        std::sort(_correlatedEntries.begin(), _correlatedEntries.end());
 
-	//[START] loop over collection (internal)
-        for(size_t iCol = 0; iCol < _clusterCollectionVec.size(); iCol++) {
-        
-          std::string internalInputClusterCollectionName =
-              _clusterCollectionVec[iCol];
-
-          LCCollectionVec *internalInputClusterCollection =
-              static_cast<LCCollectionVec *>(
-                  event->getCollection(internalInputClusterCollectionName));
-          CellIDDecoder<TrackerPulseImpl> pulseCellDecoder(
-              internalInputClusterCollection);
-
-	  //[START] loop over cluster (internal)
-          for(size_t iInt = 0; iInt < internalInputClusterCollection->size();
-               ++iInt) {
-
-            TrackerPulseImpl *internalPulse = static_cast<TrackerPulseImpl *>(
-                internalInputClusterCollection->getElementAt(iInt));
-
-            EUTelVirtualCluster *internalCluster;
-
-            ClusterType type = static_cast<ClusterType>(
-                static_cast<int>((pulseCellDecoder(internalPulse)["type"])));
-
-            //check that the type of cluster is ok
-            if(type == kEUTelDFFClusterImpl) {
-              internalCluster =
-                  new EUTelDFFClusterImpl(static_cast<TrackerDataImpl *>(
-                      internalPulse->getTrackerData()));
-            } else if(type == kEUTelBrickedClusterImpl) {
-              internalCluster =
-                  new EUTelBrickedClusterImpl(static_cast<TrackerDataImpl *>(
-                      internalPulse->getTrackerData()));
-            } else if(type == kEUTelFFClusterImpl) {
-              internalCluster =
-                  new EUTelFFClusterImpl(static_cast<TrackerDataImpl *>(
-                      internalPulse->getTrackerData()));
-            } else if(type == kEUTelSparseClusterImpl) {
-              internalCluster =
-                  new EUTelSparseClusterImpl<EUTelGenericSparsePixel>(
-                      static_cast<TrackerDataImpl *>(
-                          internalPulse->getTrackerData()));
-              if(internalCluster != nullptr &&
-                  internalCluster->getTotalCharge() < _clusterChargeMin) {
-                delete internalCluster;
-                continue;
-              }
-            } else {
-              continue;
-			}
-			
-	    //check charge requirement
-            if(internalCluster->getTotalCharge() < _clusterChargeMin) {
-              delete internalCluster;
-              continue;
-            }
-
-            int internalSensorID = pulseCellDecoder(internalPulse)["sensorID"];
-
-            if((internalSensorID != getFixedPlaneID() &&
-                externalSensorID == getFixedPlaneID()) ||
-	       (_sensorIDtoZ.at(internalSensorID) >
-		_sensorIDtoZ.at(externalSensorID))) {
-	      
-	      //get coordinates of internal seed
-              float internalXCenter = 0.;
-              float internalYCenter = 0.;
-              internalCluster->getCenterOfGravity(internalXCenter,
-                                                  internalYCenter);
-
-              streamlog_out(DEBUG5) << "Filling histo for " 
-              << "extID " << externalSensorID << " and intID " 
-	      << internalSensorID << std::endl;
-              
-              //input coordinates in correlation matrix (for X and Y)
-              _clusterXCorrelationMatrix[externalSensorID][internalSensorID]
-                  ->fill(externalXCenter, internalXCenter);
-              _clusterYCorrelationMatrix[externalSensorID][internalSensorID]
-                  ->fill(externalYCenter, internalYCenter);    
-              streamlog_out(MESSAGE1)
-                  << " ex " << externalSensorID << " = [" << externalXCenter
-                  << ":" << externalYCenter << "]"
-                  << " in " << internalSensorID << " = [" << internalXCenter
-                  << ":" << internalYCenter << "]" << std::endl;
-            }
-
-            delete internalCluster;
-          }//[END] loop over cluster (internal)
-        }//[END] loop over collection (internal)
-
-        delete externalCluster;
-      }//[END] loop over cluster (external)
-    }//[END] loop over collection (external)
+	//[START] loop over clusters (internal)
+        for(auto iInt : _correlatedEntries) {
+
+          if(!_entryIsInternal[iInt]) continue;
+
+          double internalXCenter = _entryX[iInt];
+          double internalYCenter = _entryY[iInt];
+
+          if(useWindow &&
+             (std::abs(externalXCenter - internalXCenter) > _clusterCorrelationWindow[0] ||
+              std::abs(externalYCenter - internalYCenter) > _clusterCorrelationWindow[1])) {
+            continue;
+          }
+
+          streamlog_out(DEBUG5) << "Filling histo for "
+          << "extID " << externalSensorID << " and intID "
+	  << internalSensorID << std::endl;
+
+          //input coordinates in correlation matrix (for X and Y)
+          _clusterXCorrelationMatrix[externalSensorID][internalSensorID]
+              ->fill(externalXCenter, internalXCenter);
+          _clusterYCorrelationMatrix[externalSensorID][internalSensorID]
+              ->fill(externalYCenter, internalYCenter);
+          streamlog_out(MESSAGE1)
+              << " ex " << externalSensorID << " = [" << externalXCenter
+              << ":" << externalYCenter << "]"
+              << " in " << internalSensorID << " = [" << internalXCenter
+              << ":" << internalYCenter << "]" << std::endl;
+        }//[END] loop over clusters (internal)
+      }//[END] loop over sensors (internal)
+    }//[END] loop over clusters (external)
   }//[ENDIF] hasCluster
-  
+
   //[IF] hasCollection
   if(_hasHitCollection) {
 
@@ -440,134 +434,150 @@ void EUTelCorrelator::processEvent(LCEvent *event) {
     streamlog_out(MESSAGE2) << "inputHitCollection "
                             << _inputHitCollectionName.c_str() << std::endl;
 
-    //[START] loop over collection (external) 
-    for(size_t iExt = 0; iExt < inputHitCollection->size(); ++iExt) {
-    
-      std::vector<double> trackXVec;
-      std::vector<double> trackYVec;
-      std::vector<int> planeIDVec;
-      trackXVec.clear();
-      trackYVec.clear();
-      planeIDVec.clear();
-
-      //get external hit
-      TrackerHitImpl *externalHit =
-          static_cast<TrackerHitImpl *>(inputHitCollection->getElementAt(iExt));
-      double *externalPosition =
-          const_cast<double *>(externalHit->getPosition());
-      int externalSensorID = hitDecoder(externalHit)["sensorID"];
-      double etrackPointLocal[] = {externalPosition[0], externalPosition[1],
-                                   externalPosition[2]};
-      double etrackPointGlobal[] = {externalPosition[0], externalPosition[1],
-                                    externalPosition[2]};
+    //transform every hit once into the global frame
+    clearCorrelationEntries();
+
+    //[START] loop over hits
+    for(size_t iHit = 0; iHit < inputHitCollection->size(); ++iHit) {
+
+      TrackerHitImpl *hit =
+          static_cast<TrackerHitImpl *>(inputHitCollection->getElementAt(iHit));
+      double const *position = hit->getPosition();
+      int sensorID = hitDecoder(hit)["sensorID"];
+      double trackPointLocal[] = {position[0], position[1], position[2]};
+      double trackPointGlobal[] = {position[0], position[1], position[2]};
 
       //check for coordinate system
-      if(hitDecoder(externalHit)["properties"] != kHitInGlobalCoord) {
+      if(hitDecoder(hit)["properties"] != kHitInGlobalCoord) {
       	//transfer to global frame
-        geo::gGeometry().local2Master(externalSensorID, etrackPointLocal,
-                                      etrackPointGlobal);
+        geo::gGeometry().local2Master(sensorID, trackPointLocal,
+                                      trackPointGlobal);
       } else {
         //do nothing, already in global telescope frame
       }
 
-      trackXVec.push_back(etrackPointGlobal[0]);
-      trackYVec.push_back(etrackPointGlobal[1]);
-      planeIDVec.push_back(externalSensorID);
-
       streamlog_out(MESSAGE2)
-          << "extPlane:" << externalSensorID << " at local position: " << etrackPointLocal[0]
-          << " " << etrackPointLocal[1]
-          << " and global position: " << etrackPointGlobal[0] << " " << etrackPointGlobal[1]
+          << "plane:" << sensorID << " at local position: " << trackPointLocal[0]
+          << " " << trackPointLocal[1]
+          << " and global position: " << trackPointGlobal[0] << " " << trackPointGlobal[1]
           << std::endl;
 
-      //[START] loop over collection (internal)
-      for(size_t iInt = 0; iInt < inputHitCollection->size(); ++iInt) {
-
-        TrackerHitImpl *internalHit = static_cast<TrackerHitImpl *>(
-            inputHitCollection->getElementAt(iInt));
-
-        double *internalPosition =
-            const_cast<double *>(internalHit->getPosition());
-        int internalSensorID = hitDecoder(internalHit)["sensorID"];
-        double itrackPointLocal[] = {internalPosition[0], internalPosition[1],
-                                     internalPosition[2]};
-        double itrackPointGlobal[] = {internalPosition[0], internalPosition[1],
-                                      internalPosition[2]};
-
-	//check for coordinate system
-        if(hitDecoder(internalHit)["properties"] != kHitInGlobalCoord) {
-	  //transfer to global frame
-          geo::gGeometry().local2Master(internalSensorID, itrackPointLocal,
-                                        itrackPointGlobal);
-        } else {
-          //do nothing, already in global telescope frame
-        }
+      _entrySensorID.push_back(sensorID);
+      _entryX.push_back(trackPointGlobal[0]);
+      _entryY.push_back(trackPointGlobal[1]);
+      _entryIsExternal.push_back(true);
+      _entryIsInternal.push_back(true);
+    }//[END] loop over hits
+
+    indexCorrelationEntries();
+
+    //safety margin for rounding in the window boundaries
+    double const margin = 1E-6;
+
+    //[START] loop over hits (external)
+    for(size_t iExt = 0; iExt < _entryX.size(); ++iExt) {
+
+      int externalSensorID = _entrySensorID[iExt];
+      double externalX = _entryX[iExt];
+      double externalY = _entryY[iExt];
+
+      //[START] loop over sensors (internal): collect the correlated hits
+      _correlatedEntries.clear();
+      for(auto const &sensorEntries : _sensorEntries) {
+
+        int internalSensorID = sensorEntries.first;
+        if(sensorEntries.second.empty()) continue;
 
 	//[IF] check planes
-	if((internalSensorID != getFixedPlaneID() &&
-	    externalSensorID == getFixedPlaneID()) ||
-	   (_sensorIDtoZ.at(internalSensorID) >
-	    _sensorIDtoZ.at(externalSensorID))) {
-
-          int iz = _sensorIDtoZ.at(internalSensorID);
-
-	  //[IF] check residual requirement
-          if(((etrackPointGlobal[0] - itrackPointGlobal[0]) <
-               _residualsXMax[iz]) &&
-	     (_residualsXMin[iz] <
-               (etrackPointGlobal[0] - itrackPointGlobal[0])) &&
-	     ((etrackPointGlobal[1] - itrackPointGlobal[1]) <
-               _residualsYMax[iz]) &&
-	     (_residualsYMin[iz] <
-	      (etrackPointGlobal[1] - itrackPointGlobal[1]))) {
-
-            trackXVec.push_back(itrackPointGlobal[0]);
-            trackYVec.push_back(itrackPointGlobal[1]);
-            planeIDVec.push_back(internalSensorID);
-	    
-            streamlog_out(MESSAGE2) << "intPlane:" << internalSensorID
-                                    << " at loc position: " << itrackPointLocal[0] << " "
-                                    << itrackPointLocal[1] 
-                                    << " and global position: " << itrackPointGlobal[0] << " "
-                                    << itrackPointGlobal[1] << std::endl;
-          }//[ENDIF] check residual requirement
-        }//[ENDIF] check planes
-      }//[END] loop over collection (internal)
-
-      std::vector<int> planeID_unique = planeIDVec;          
-      
-      //remove duplicates
-      std::vector<int>::iterator p_end;
-      
-      p_end = unique(planeID_unique.begin(),planeID_unique.end()); 
-      //FIXME: should there be real erasing, change function... (jha92)
-      //planeID_unique.erase(p_end,planeID_unique.end());
-      
-      //[IF] check for minimal number of correlated hits
-      if(static_cast<int>(planeID_unique.size()) > _minNumberOfCorrelatedHits &&
-          trackXVec.size() == trackYVec.size()) {
-                        
-        size_t indexPlane = 0;
-        
-          for(size_t i = 0; i < trackXVec.size(); i++) {
-            if(i == indexPlane) continue; //skip as this one is not booked
-            
-            _hitXCorrelationMatrix[planeIDVec[indexPlane]][planeIDVec[i]]->fill(
-                trackXVec[indexPlane], trackXVec[i]);
-            _hitYCorrelationMatrix[planeIDVec[indexPlane]][planeIDVec[i]]->fill(
-                trackYVec[indexPlane], trackYVec[i]);
-            //assumption: all rotations were done in hitmaker processor
-            _hitXCorrShiftMatrix[planeIDVec[indexPlane]][planeIDVec[i]]->fill(
-                trackXVec[indexPlane], trackXVec[indexPlane] - trackXVec[i]);
-            _hitYCorrShiftMatrix[planeIDVec[indexPlane]][planeIDVec[i]]->fill(
-                trackYVec[indexPlane], trackYVec[indexPlane] - trackYVec[i]);
-          }
+        if(!((internalSensorID != getFixedPlaneID() &&
+              externalSensorID == getFixedPlaneID()) ||
+             (_sensorIDtoZ.at(internalSensorID) >
+              _sensorIDtoZ.at(externalSensorID)))) continue;
+
+        int iz = _sensorIDtoZ.at(internalSensorID);
+
+        //only the hits within the residual band in X can pass the requirement below
+        size_t first = _correlatedEntries.size();
+        findCorrelationCandidates(sensorEntries.second,
+                                  externalX - _residualsXMax[iz] - margin,
+                                  externalX - _residualsXMin[iz] + margin);
+
+	//[IF] check residual requirement
+        auto passes = [&](size_t iInt) {
+          return ((externalX - _entryX[iInt]) < _residualsXMax[iz]) &&
+                 (_residualsXMin[iz] < (externalX - _entryX[iInt])) &&
+                 ((externalY - _entryY[iInt]) < _residualsYMax[iz]) &&
+                 (_residualsYMin[iz] < (externalY - _entryY[iInt]));
+        };
+        _correlatedEntries.erase(
+            std::remove_if(_correlatedEntries.begin() + static_cast<std::ptrdiff_t>(first),
+                           _correlatedEntries.end(),
+                           [&](size_t iInt) { return !passes(iInt); }),
+            _correlatedEntries.end());
+      }//[END] loop over sensors (internal)
+
+      //fill in the original hit order
+      std::sort(_correlatedEntries.begin(), _correlatedEntries.end());
+
+      //[IF] check for minimal number of correlated hits (the external hit
+      //included), counting hits rather than planes as done so far
+      if(static_cast<int>(_correlatedEntries.size() + 1) > _minNumberOfCorrelatedHits) {
+
+        for(auto iInt : _correlatedEntries) {
+          int internalSensorID = _entrySensorID[iInt];
+
+          streamlog_out(MESSAGE2) << "intPlane:" << internalSensorID
+                                  << " at global position: " << _entryX[iInt] << " "
+                                  << _entryY[iInt] << std::endl;
+
+          _hitXCorrelationMatrix[externalSensorID][internalSensorID]->fill(
+              externalX, _entryX[iInt]);
+          _hitYCorrelationMatrix[externalSensorID][internalSensorID]->fill(
+              externalY, _entryY[iInt]);
+          //assumption: all rotations were done in hitmaker processor
+          _hitXCorrShiftMatrix[externalSensorID][internalSensorID]->fill(
+              externalX, externalX - _entryX[iInt]);
+          _hitYCorrShiftMatrix[externalSensorID][internalSensorID]->fill(
+              externalY, externalY - _entryY[iInt]);
+        }
       } //[ENDIF]
-    }//[END] loop over collection (external)
+    }//[END] loop over hits (external)
   }//[ENDIF] hasCollection
 #endif
 }
 
+void EUTelCorrelator::clearCorrelationEntries() {
+  _entrySensorID.clear();
+  _entryX.clear();
+  _entryY.clear();
+  _entryIsExternal.clear();
+  _entryIsInternal.clear();
+}
+
+void EUTelCorrelator::indexCorrelationEntries() {
+  for(auto &sensorEntries : _sensorEntries) {
+    sensorEntries.second.clear();
+  }
+  for(size_t iEntry = 0; iEntry < _entryX.size(); ++iEntry) {
+    _sensorEntries[_entrySensorID[iEntry]].emplace_back(_entryX[iEntry], iEntry);
+  }
+  for(auto &sensorEntries : _sensorEntries) {
+    std::sort(sensorEntries.second.begin(), sensorEntries.second.end());
+  }
+}
+
+void EUTelCorrelator::findCorrelationCandidates(
+    std::vector<std::pair<double, size_t>> const &sensorEntries, double xLow,
+    double xHigh) {
+  auto it = std::lower_bound(sensorEntries.begin(), sensorEntries.end(), xLow,
+                             [](std::pair<double, size_t> const &entry, double value) {
+                               return entry.first < value;
+                             });
+  for(; it != sensorEntries.end() && it->first <= xHigh; ++it) {
+    _correlatedEntries.push_back(it->second);
+  }
+}
+
 void EUTelCorrelator::end() {
 
   streamlog_out(MESSAGE4) << "Successfully finished" << std::endl;
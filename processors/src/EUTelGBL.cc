@@ -161,6 +161,13 @@ EUTelGBL::EUTelGBL(): Processor("EUTelGBL") {
 			    _suggestAlignmentCuts,
 			    0);
 
+  registerOptionalParameter("tripletMonitoring",
+			    "How the triplet slope/residual and matching cut histograms are filled: 0 not at all, "
+			    "1 via binned counters added at the end (same bin contents, default), "
+			    "2 for every candidate directly",
+			    _tripletMonitoring,
+			    1);
+
   registerOptionalParameter("dumpTracks",
 			    "Set to 0 if you do not want to dump tracks in an lcio collection "
 			    "(necessary to dump in an NTuple)",
@@ -247,9 +254,25 @@ EUTelGBL::EUTelGBL(): Processor("EUTelGBL") {
 			    "Name of the steering file for the pede program",
 			    _pedeSteerfileName,
 			    std::string{"steer_mille.txt"});
+
+  registerOptionalParameter("NumberOfThreads",
+			    "Number of threads used to fit the tracks of an event concurrently (1 == no threading)",
+			    _noOfThreads,
+			    1);
+
+  _thicknessSUT = 0;
+  _noOfGBLTracks = 0;
 }
 
 
+inline Eigen::Matrix<double,5,5> Jac55new( double ds ) {
+  Eigen::Matrix<double,5,5> jac = Eigen::Matrix<double,5,5>::Identity();
+  //jac.UnitMatrix();
+  jac(3,1) = ds; // x = x0 + xp * ds
+  jac(4,2) = ds; // y = y0 + yp * ds
+  return jac;
+}
+
 void EUTelGBL::init() {
   geo::gGeometry().initializeTGeoDescription(EUTELESCOPE::GEOFILENAME,
                                              EUTELESCOPE::DUMPGEOROOT);
@@ -311,6 +334,40 @@ void EUTelGBL::init() {
     _planeWscatAir.emplace_back( 1.0/(tetAir*tetAir), 1.0/(tetAir*tetAir) );
   }
 
+  //the GBL trajectory layout only depends on the geometry: one point per
+  //plane and two air scatterers in between, so the Jacobians, arc lengths
+  //and plane labels are the same for all tracks
+  double s = 0;
+  double step = 0;
+  for(size_t ipl = 0; ipl < _nPlanes; ipl++) {
+    //transport matrix in (q/p, x', y', x, y) space
+    _gblPlaneJacobians.emplace_back( Jac55new( step ) );
+    s += step;
+    _gblArcLengths.push_back( s );
+    _gblPlaneLabels.push_back( _gblArcLengths.size() );
+    if( ipl < _nPlanes-1 ) {
+      double distplane = _planePosition[ipl+1] - _planePosition[ipl];
+      step = 0.21*distplane; //in [mm]
+      _gblAirJacobiansLeft.emplace_back( Jac55new( step ) );
+      s += step;
+      _gblArcLengths.push_back( s );
+      step = 0.58*distplane; //in [mm]
+      _gblAirJacobiansRight.emplace_back( Jac55new( step ) );
+      s += step;
+      _gblArcLengths.push_back( s );
+      step = 0.21*distplane; //remaining distance to next plane, in [mm]
+    }
+  }
+
+  //distance of each plane to the SUT, for the kink estimation
+  if(_SUT_ID > 0) {
+    double SUT_zpos = geo::gGeometry().getPlaneZPosition(_SUT_ID);
+    _thicknessSUT = geo::gGeometry().getPlaneZSize(_SUT_ID);
+    for(size_t ipl = 0; ipl < _nPlanes; ipl++) {
+      _planeDistSUT.push_back( _planePosition[ipl] - SUT_zpos );
+    }
+  }
+
   //FIXME: Really needed this output?
   streamlog_out(MESSAGE4) << "Assumed beam energy " << _eBeam << " GeV" <<  std::endl;
   streamlog_out(MESSAGE4) << "\n\t_planeRadLength has size: \t" << _planeRadLength.size() 
@@ -339,6 +396,26 @@ void EUTelGBL::init() {
   //usually a good idea to do
   printParameters ();
 
+  if(_tripletMonitoring < 0 || _tripletMonitoring > 2) {
+    streamlog_out(ERROR) << "The chosen tripletMonitoring: " << _tripletMonitoring
+                         << " is invalid, it has to be 0, 1 or 2." << std::endl;
+    throw InvalidParameterException("tripletMonitoring");
+  }
+  if(_tripletMonitoring == 0 && _suggestAlignmentCuts) {
+    streamlog_out(ERROR) << "suggestAlignmentCuts needs the triplet cut histograms, "
+                         << "tripletMonitoring must not be 0." << std::endl;
+    throw InvalidParameterException("tripletMonitoring");
+  }
+
+  if(_noOfThreads < 1) {
+    streamlog_out(ERROR) << "The chosen NumberOfThreads: " << _noOfThreads
+                         << " is invalid, it has to be at least 1." << std::endl;
+    throw InvalidParameterException("NumberOfThreads");
+  }
+  if(_noOfThreads > 1) {
+    _threadPool = std::make_unique<EUTelThreadPool>(static_cast<size_t>(_noOfThreads));
+  }
+
   //reset run and event counters
   _iRun = 0;
   _iEvt = 0;
@@ -447,6 +524,16 @@ void EUTelGBL::init() {
       streamlog_out( ERROR2 ) << "Could not open steering file." << std::endl;
     }
     // end writing the pede steering file
+
+    //global labels of each plane: x, y, rotZ (and z, rotX, rotY)
+    size_t noOfLabels = (_alignMode == Utility::alignMode::XYShiftsRotZ) ? 3 : 6;
+    for(size_t ipl = 0; ipl < _nPlanes; ipl++) {
+      std::vector<int> globalLabels(noOfLabels);
+      for(size_t iLabel = 0; iLabel < noOfLabels; iLabel++) {
+	globalLabels[iLabel] = _sensorIDVec[ipl] * 10 + static_cast<int>(iLabel) + 1;
+      }
+      _planeGlobalLabels.push_back(globalLabels);
+    }
   }
   streamlog_out( MESSAGE2 ) << "end of init" << std::endl;
 }
@@ -459,14 +546,6 @@ void EUTelGBL::processRunHeader( LCRunHeader* rdr ) {
   ++_iRun;
 }
 
-inline Eigen::Matrix<double,5,5> Jac55new( double ds ) {
-  Eigen::Matrix<double,5,5> jac = Eigen::Matrix<double,5,5>::Identity();
-  //jac.UnitMatrix();
-  jac(3,1) = ds; // x = x0 + xp * ds
-  jac(4,2) = ds; // y = y0 + yp * ds
-  return jac;
-}
-
 void EUTelGBL::processEvent( LCEvent * event ) {
 
   if(_iEvt % 1000 == 0) {
@@ -494,6 +573,10 @@ void EUTelGBL::processEvent( LCEvent * event ) {
     return;
   }
 
+  //one consistent view of the geometry for this event, the fit workers must not
+  //call into geo::gGeometry() since it may be realigned meanwhile
+  auto const geometry = geo::gGeometry().getSnapshot();
+
   CellIDDecoder<TrackerHit> hitCellDecoder(EUTELESCOPE::HITENCODING);
   std::vector<EUTelTripletGBLUtility::hit> telescopeHitsVec;
   std::vector<EUTelTripletGBLUtility::hit> dutHitsVec;
@@ -540,10 +623,25 @@ void EUTelGBL::processEvent( LCEvent * event ) {
   auto upstreamTripletVec = std::vector<EUTelTripletGBLUtility::triplet>();
   auto downstreamTripletVec = std::vector<EUTelTripletGBLUtility::triplet>();
 
-  gblutil.FindTriplets(telescopeHitsVec, _upstreamTriplet_IDs, _upstreamTriplet_ResCut,
-		       _upstreamTriplet_SlopeCut/1000., upstreamTripletVec, false, true);
-  gblutil.FindTriplets(telescopeHitsVec, _downstreamTriplet_IDs, _downstreamTriplet_ResCut,
-		       _downstreamTriplet_SlopeCut/1000., downstreamTripletVec, false, false);
+  //the monitoring of the cut histograms is a compile time policy of gblutil,
+  //monitored(fn) calls fn with the policy selected by tripletMonitoring
+  auto monitored = [this](auto&& fn) {
+    if(_tripletMonitoring == 0) {
+      fn(EUTelTripletGBLUtility::noMonitoring());
+    } else if(_tripletMonitoring == 1) {
+      fn(EUTelTripletGBLUtility::counterMonitoring());
+    } else {
+      fn(EUTelTripletGBLUtility::histogramMonitoring());
+    }
+  };
+
+  monitored([&](auto monitoring) {
+    using Monitoring = decltype(monitoring);
+    gblutil.FindTriplets<Monitoring>(telescopeHitsVec, _upstreamTriplet_IDs, _upstreamTriplet_ResCut,
+				     _upstreamTriplet_SlopeCut/1000., upstreamTripletVec, false, true);
+    gblutil.FindTriplets<Monitoring>(telescopeHitsVec, _downstreamTriplet_IDs, _downstreamTriplet_ResCut,
+				     _downstreamTriplet_SlopeCut/1000., downstreamTripletVec, false, false);
+  });
 
   if(_printEventCounter < NO_PRINT_EVENT_COUNTER){
     streamlog_out(DEBUG2)  << "UpstreamTriplets:" << std::endl;
@@ -560,46 +658,50 @@ void EUTelGBL::processEvent( LCEvent * event ) {
   hist1D_nDownstreamTriplets->fill(downstreamTripletVec.size());
 
   auto matchedTripletVec = std::vector<EUTelTripletGBLUtility::track>();
-  gblutil.MatchTriplets(upstreamTripletVec, downstreamTripletVec, _zMid,
-			_upDownTripletMatchCut, matchedTripletVec);
+  monitored([&](auto monitoring) {
+    gblutil.MatchTriplets<decltype(monitoring)>(upstreamTripletVec, downstreamTripletVec, _zMid,
+						_upDownTripletMatchCut, matchedTripletVec);
+  });
 
   if(_printEventCounter < NO_PRINT_EVENT_COUNTER)
     streamlog_out(DEBUG2) << "Matched to:" << std::endl; 
 
   if(!_DUT_IDs.empty())
     {
-      for(auto& track: matchedTripletVec) {    
-	for(auto dutID: _DUT_IDs) {
-	  //either attach DUT to upstream
-	  if(_isSensorUpstream[dutID]) {
-	    gblutil.AttachDUT(track.get_upstream(), dutHitsVec, dutID, _dutCuts);
-	  }
-	  //or to downstream
-	  else {
-	    gblutil.AttachDUT(track.get_downstream(), dutHitsVec, dutID, _dutCuts);
+      //index the hits of every DUT once per event
+      _dutHitIndexVec.resize(_DUT_IDs.size());
+      for(size_t iDUT = 0; iDUT < _DUT_IDs.size(); ++iDUT) {
+	gblutil.IndexDUTHits(dutHitsVec, _DUT_IDs[iDUT], _dutHitIndexVec[iDUT]);
+      }
+      monitored([&](auto monitoring) {
+	using Monitoring = decltype(monitoring);
+	for(auto& track: matchedTripletVec) {    
+	  for(size_t iDUT = 0; iDUT < _DUT_IDs.size(); ++iDUT) {
+	    auto dutID = _DUT_IDs[iDUT];
+	    //either attach DUT to upstream
+	    if(_isSensorUpstream[dutID]) {
+	      gblutil.AttachDUT<Monitoring>(track.get_upstream(), dutHitsVec, _dutHitIndexVec[iDUT], *geometry, dutID, _dutCuts);
+	    }
+	    //or to downstream
+	    else {
+	      gblutil.AttachDUT<Monitoring>(track.get_downstream(), dutHitsVec, _dutHitIndexVec[iDUT], *geometry, dutID, _dutCuts);
+	    }
 	  }
 	}
-      }
+      });
     }
 
-  //[START] loop over matched tracks
+  //the tracks are prepared first, then fitted (possibly in parallel) and
+  //finally evaluated in their original order
+  //[START] loop over matched tracks: build the GBL points
+  _noOfGBLTracks = 0;
   for(auto& track: matchedTripletVec) 
     {
-      //GBL point vector for the trajectory (in [mm])
-      //GBL with triplet A as seed
-      std::vector<gbl::GblPoint> traj_points;
-      //build up trajectory:
-      std::vector<unsigned int> labelVec;
-      vector<double> sPoint;
-      
-      //arc length at the first measurement plane is 0
-      double s = 0;
-      
       Eigen::Matrix2d proL2m = Eigen::Matrix2d::Identity();
       Eigen::Vector2d scat = Eigen::Vector2d::Zero();
       
-      auto uptriplet = track.get_upstream();
-      auto downtriplet = track.get_downstream();
+      auto& uptriplet = track.get_upstream();
+      auto& downtriplet = track.get_downstream();
       //need triplet slope to compute residual
       auto tripletSlope = uptriplet.slope();
       
@@ -625,6 +727,21 @@ void EUTelGBL::processEvent( LCEvent * event ) {
 	}
         if(rejectTrack) continue;
       }
+
+      //take the next track from the pool, its storage is kept between events
+      if(_noOfGBLTracks == _gblTracks.size()) _gblTracks.emplace_back();
+      auto& gblTrack = _gblTracks[_noOfGBLTracks++];
+      gblTrack.track = &track;
+      //GBL point vector for the trajectory (in [mm])
+      //GBL with triplet A as seed
+      auto& traj_points = gblTrack.points;
+      traj_points.clear();
+      auto& rx = gblTrack.rx;
+      auto& ry = gblTrack.ry;
+      auto& hasHit = gblTrack.hasHit;
+      rx.assign(_nPlanes, -1.0);
+      ry.assign(_nPlanes, -1.0);
+      hasHit.assign(_nPlanes, false);
       
       //FIXME: to be used only during alignment. Matrix defined outside if clause to 
       //avoid complaints from compiler. Could be done better
@@ -654,13 +771,6 @@ void EUTelGBL::processEvent( LCEvent * event ) {
 	alDer6(2,5) = 0.0; // dz/dg
       }
       
-      std::vector<double> rx (_nPlanes, -1.0);
-      std::vector<double> ry (_nPlanes, -1.0);
-      std::vector<bool> hasHit (_nPlanes, false);
-      
-      double step = 0.0;
-      unsigned int iLabel;
-      
       //[START] loop over all planes
       for(size_t ipl=0; ipl<_nPlanes; ++ipl) {
 
@@ -683,10 +793,9 @@ void EUTelGBL::processEvent( LCEvent * event ) {
 	//if there is no hit, take plane position from the geo description
 	double zz = hit ? hit->z : _planePosition[ipl];// [mm]
 	
-	//transport matrix in (q/p, x', y', x, y) space
-	auto jacPointToPoint = Jac55new( step );
-	auto point = gbl::GblPoint( jacPointToPoint );
-	s += step;
+	//transport matrix in (q/p, x', y', x, y) space, fixed by the geometry
+	traj_points.emplace_back( _gblPlaneJacobians[ipl] );
+	auto& point = traj_points.back();
 	
 	if(hit) {
 	  hasHit[ipl] = true; 
@@ -709,13 +818,10 @@ void EUTelGBL::processEvent( LCEvent * event ) {
 	    
 	    //for SUT: add local parameter for kink estimation for the planes after the SUT
 	    if(_SUT_ID > 0){
-	      //FIXME: very sloppy. SUT_zpos should not be retrieved every time
-	      double SUT_zpos = geo::gGeometry().getPlaneZPosition(_SUT_ID);
-	      double distSUT = _planePosition[ipl] - SUT_zpos; 
+	      double distSUT = _planeDistSUT[ipl];
 	      if(distSUT > 0){
-		//FIXME: definition can stay here or should be moved out?
 		Eigen::Matrix<double,2,4> addDer = Eigen::Matrix<double,2,4>::Zero();
-		double thickness = geo::gGeometry().getPlaneZSize(_SUT_ID);
+		double thickness = _thicknessSUT;
 		addDer(0,0) = (distSUT - thickness/sqrt(12)); //first scatterer in target
 		addDer(1,1) = (distSUT - thickness/sqrt(12)); 
 		addDer(0,2) = (distSUT + thickness/sqrt(12)); //second scatterer in target
@@ -728,33 +834,22 @@ void EUTelGBL::processEvent( LCEvent * event ) {
 	    if(_performAlignment) {	      
 	      //alignMode: x,y shifts and rotation z. TO BE FIXED
 	    if( _alignMode == Utility::alignMode::XYShiftsRotZ ) {
-		std::vector<int> globalLabels(3);
-		globalLabels[0] = _sensorIDVec[ipl] * 10 + 1; //x
-		globalLabels[1] = _sensorIDVec[ipl] * 10 + 2; //y
-		globalLabels[2] = _sensorIDVec[ipl] * 10 + 3; //rotZ
 		alDer3(0,2) = -ys; //dx/dphi
 		alDer3(1,2) =  xs; //dy/dphi
-		point.addGlobals( globalLabels, alDer3 );
+		point.addGlobals( _planeGlobalLabels[ipl], alDer3 );
 	      } 
 	      //alignMode: x,y,z shifts and rotation x,y,z
 	      else if( _alignMode == Utility::alignMode::XYZShiftsRotXYZ ) {
 		double z = hit->z;
 		//FIXME: a bit hacky? : deltaz cannot be zero, otherwise this mode doesn't work
 		if ( z < 1E-9 ) z = 1E-9;
-		std::vector<int> globalLabels(6);
-		globalLabels[0] = _sensorIDVec[ipl] * 10 + 1; //x
-		globalLabels[1] = _sensorIDVec[ipl] * 10 + 2; //y
-		globalLabels[2] = _sensorIDVec[ipl] * 10 + 3; //rotZ
-		globalLabels[3] = _sensorIDVec[ipl] * 10 + 4; //z
-		globalLabels[4] = _sensorIDVec[ipl] * 10 + 5; //rotX
-		globalLabels[5] = _sensorIDVec[ipl] * 10 + 6; //rotY
         alDer6(0,4) = z; //dx/db
         alDer6(0,5) = -ys; //dx/dg
         alDer6(1,3) = -z; //dy/da
         alDer6(1,5) = xs; //dy/dg
         alDer6(2,3) = ys; //dz/da
         alDer6(2,4) = -xs; //dz/db
-        point.addGlobals( globalLabels, alDer6 );
+        point.addGlobals( _planeGlobalLabels[ipl], alDer6 );
 	      }
 	    }
 	  }
@@ -764,37 +859,60 @@ void EUTelGBL::processEvent( LCEvent * event ) {
 	if(_sensorIDVec[ipl] != _SUT_ID) {
 	  point.addScatterer( scat, _planeWscatSi[ipl] );
 	}
-	sPoint.push_back( s );
-	iLabel = sPoint.size();
-	labelVec.push_back(iLabel);
-	traj_points.push_back(point);
 
 	//fill up with two air scatters in between planes
 	if( ipl < _nPlanes-1 ) {
-	  double distplane = _planePosition[ipl+1] - _planePosition[ipl];
-	  step = 0.21*distplane; //in [mm]
-	  auto point_left = gbl::GblPoint( Jac55new( step ) );
-	  point_left.addScatterer( scat, _planeWscatAir[ipl] );
-	  s += step;
-	  traj_points.push_back(point_left);
-	  sPoint.push_back( s );
-	  step = 0.58*distplane; //in [mm]
-	  auto point_right = gbl::GblPoint( Jac55new( step ) );
-	  point_right.addScatterer( scat, _planeWscatAir[ipl] );
-	  s += step;
-	  traj_points.push_back(point_right);
-	  sPoint.push_back( s );
-	  step = 0.21*distplane; //remaining distance to next plane, in [mm]
+	  traj_points.emplace_back( _gblAirJacobiansLeft[ipl] );
+	  traj_points.back().addScatterer( scat, _planeWscatAir[ipl] );
+	  traj_points.emplace_back( _gblAirJacobiansRight[ipl] );
+	  traj_points.back().addScatterer( scat, _planeWscatAir[ipl] );
 	}
 	
       }//[END] loop over all planes
+    }//[END] loop over matched tracks: build the GBL points
+
+  //the fits are independent of each other, each task only touches its own track
+  auto fitTrack = [this, &geometry](size_t iTrack, size_t /*iWorker*/) {
+    auto& gblTrack = _gblTracks[iTrack];
+    gblTrack.traj = std::make_unique<gbl::GblTrajectory>(gblTrack.points, false); // curvature = false
+    gblTrack.traj->fit( gblTrack.chi2, gblTrack.ndf, gblTrack.lostWeight );
+
+    if(_dumpTracks) { //CHECK ME CAREFULLY
+      auto& uptriplet = gblTrack.track->get_upstream();
+      auto hit_a = uptriplet.getpoint_at(0);
+      Eigen::Vector3d a(hit_a.x,hit_a.y,hit_a.z);
+      gblTrack.intersectionZ.resize(_nPlanes);
+      for(size_t ix = 0; ix < _nPlanes; ++ix) {
+        auto hit_b = uptriplet.getpoint_at(_planePosition[ix]);
+        Eigen::Vector3d b(hit_b.x,hit_b.y,hit_b.z);
+        Eigen::Vector3d normal = geometry->getPlaneNormalVector(_sensorIDVec[ix]);
+        Eigen::Hyperplane<double,3> pl(normal,Eigen::Vector3d(0.0,0.0,_planePosition[ix]));
+        Eigen::ParametrizedLine<double,3> line = Eigen::ParametrizedLine<double,3>::Through(a,b);
+        gblTrack.intersectionZ[ix] = line.intersectionPoint(pl)[2];
+      }
+    }
+  };
+  if(_threadPool) {
+    _threadPool->run(_noOfGBLTracks, fitTrack);
+  } else {
+    for(size_t iTrack = 0; iTrack < _noOfGBLTracks; ++iTrack) fitTrack(iTrack, 0);
+  }
 
-      double Chi2;
-      int Ndf;
-      double lostWeight;
-      
-      gbl::GblTrajectory traj(traj_points, false); // curvature = false
-      traj.fit( Chi2, Ndf, lostWeight);
+  //[START] loop over matched tracks: histograms, output and Mille in track order
+  for(size_t iTrack = 0; iTrack < _noOfGBLTracks; ++iTrack) 
+    {
+      auto& gblTrack = _gblTracks[iTrack];
+      auto& traj = *gblTrack.traj;
+      double Chi2 = gblTrack.chi2;
+      int Ndf = gblTrack.ndf;
+      auto const & labelVec = _gblPlaneLabels;
+      auto const & sPoint = _gblArcLengths;
+      auto const & rx = gblTrack.rx;
+      auto const & ry = gblTrack.ry;
+      auto const & hasHit = gblTrack.hasHit;
+      auto& uptriplet = gblTrack.track->get_upstream();
+      auto& downtriplet = gblTrack.track->get_downstream();
+      auto tripletSlope = uptriplet.slope();
       
       if(_printEventCounter < NO_PRINT_EVENT_COUNTER){
 	streamlog_out(DEBUG4) << "traj with " << traj.getNumPoints() << " points:" << std::endl;
@@ -830,19 +948,23 @@ void EUTelGBL::processEvent( LCEvent * event ) {
       double probchi = TMath::Prob( Chi2, Ndf );
       hist1D_gblProbAlign->fill( probchi );
       
-      //look at fit:
-      Eigen::VectorXd localPar;
-      Eigen::MatrixXd localCov;
+      //look at fit, the result buffers are kept between tracks:
+      auto& localPar = _localPar;
+      auto& localCov = _localCov;
       double prevAngleX = 0;
       double prevAngleY = 0;
       
       //at plane 0:
       unsigned int ndata = 2;
       unsigned int ndim = 2;
-      Eigen::VectorXd aResiduals(ndim);
-      Eigen::VectorXd aMeasErrors(ndim);
-      Eigen::VectorXd aResErrors(ndim);
-      Eigen::VectorXd aDownWeights(ndim);
+      auto& aResiduals = _measResiduals;
+      auto& aMeasErrors = _measErrors;
+      auto& aResErrors = _measResErrors;
+      auto& aDownWeights = _measDownWeights;
+      aResiduals.resize(ndim);
+      aMeasErrors.resize(ndim);
+      aResErrors.resize(ndim);
+      aDownWeights.resize(ndim);
       
       for(size_t ix = 0; ix < _nPlanes; ++ix) {
 	int ipos = labelVec[ix];
@@ -886,16 +1008,9 @@ void EUTelGBL::processEvent( LCEvent * event ) {
 	  }
 	}
 	
-	if(_dumpTracks) { //CHECK ME CAREFULLY
- 	  auto hit_a = uptriplet.getpoint_at(0);
- 	  auto hit_b = uptriplet.getpoint_at(_planePosition[ix]);
- 	  Eigen::Vector3d a(hit_a.x,hit_a.y,hit_a.z);
- 	  Eigen::Vector3d b(hit_b.x,hit_b.y,hit_b.z);
- 	  Eigen::Vector3d normal = geo::gGeometry().getPlaneNormalVector(_sensorIDVec[ix]);
- 	  Eigen::Hyperplane<double,3> pl(normal,Eigen::Vector3d(0.0,0.0,_planePosition[ix]));
- 	  Eigen::ParametrizedLine<double,3> line = Eigen::ParametrizedLine<double,3>::Through(a,b);
- 	  Eigen::Vector3d point = line.intersectionPoint(pl);
- 	  double zz = point[2];
+	if(_dumpTracks) {
+	  //intersection of the plane with the uptriplet, computed by the fit workers
+	  double zz = gblTrack.intersectionZ[ix];
 
 	  thisTrack->setIntVal(0, _sensorIDVec[ix]); //sensor ID is an int
 	  thisTrack->setIntVal(1, Ndf); //Ndf is an int
@@ -957,6 +1072,8 @@ void EUTelGBL::processEvent( LCEvent * event ) {
 void EUTelGBL::end() {
 
   milleAlignGBL.reset(nullptr);
+  //add the counted triplet cut entries to the histograms
+  gblutil.flushHistos();
   //if user wishes alignment cut suggestion
   if(_suggestAlignmentCuts) {
   	gblutil.determineBestCuts();
@@ -25,13 +25,16 @@
 #include <UTIL/CellIDDecoder.h>
 
 // system includes <>
+#include <algorithm>
 #include <vector>
 
 using namespace eutelescope;
 
 EUTelHitCoordinateTransformer::EUTelHitCoordinateTransformer()
   :Processor("EUTelHitCoordinateTransformer"),
-   _hitCollectionNameInput(), _hitCollectionNameOutput(), _undoAlignment(false) {
+   _hitCollectionNameInput(), _hitCollectionNameOutput(), _undoAlignment(false),
+   _vectorisedTransform(false), _hitSensorIDs(), _hitProperties(), _hitPositions(),
+   _hitOrder(), _inputX(), _inputY(), _inputZ(), _outputX(), _outputY(), _outputZ() {
 
   _description = "EUTelHitCoordinateTransformer is responsible to change local "
                  "coordinates to global using the EUTelGeometryClass.";
@@ -52,6 +55,13 @@ EUTelHitCoordinateTransformer::EUTelHitCoordinateTransformer()
 			    "Set to true to undo the alignment instead",
 			    _undoAlignment,
 			    false);
+
+  registerOptionalParameter("VectorisedTransform",
+			    "Set to true to gather the hits of each sensor into separate x/y/z arrays and "
+			    "transform them with vectorised (SIMD) kernels. The results agree with the default "
+			    "path bit by bit, or within a few ulp if the compiler uses FMA instructions",
+			    _vectorisedTransform,
+			    false);
 }
 
 void EUTelHitCoordinateTransformer::init() {
@@ -102,33 +112,23 @@ void EUTelHitCoordinateTransformer::processEvent(LCEvent* event)
   lcio::CellIDDecoder<TrackerHitImpl> hitDecoder(encoding);
   lcio::UTIL::CellIDReencoder<TrackerHitImpl> cellReencoder(encoding, outputCollection);
   
-  //[START] loop over hits
-  for(int iHit = 0; iHit < inputCollection->getNumberOfElements(); ++iHit) {  
+  auto const noOfHits = static_cast<size_t>(inputCollection->getNumberOfElements());
+  _hitSensorIDs.resize(noOfHits);
+  _hitProperties.resize(noOfHits);
+  _hitPositions.resize(3*noOfHits);
+
+  //[START] loop over hits: decode and check the coordinate system
+  for(size_t iHit = 0; iHit < noOfHits; ++iHit) {
     
-    TrackerHitImpl* inputHit = static_cast<TrackerHitImpl*>(inputCollection->getElementAt(iHit));
-    TrackerHitImpl* outputHit = new IMPL::TrackerHitImpl(); 
+    TrackerHitImpl* inputHit = static_cast<TrackerHitImpl*>(inputCollection->getElementAt(static_cast<int>(iHit)));
     
     //get some basic information
     int properties = hitDecoder(inputHit)["properties"];
-    int sensorID = hitDecoder(inputHit)["sensorID"];
-				
-    //use local2masterHit/master2localHit function in EUTelGeometryTelescopeDescription
-    //to translate input/output position		
-    const double* inputPos = inputHit->getPosition();
-    double outputPos[3];
-    
-    //transform local->global
-    if(!(properties & kHitInGlobalCoord) && !_undoAlignment) {
-      streamlog_out(DEBUG0) << "Transforming hit from local to global!" << std::endl;
-      geo::gGeometry().local2Master(sensorID, inputPos, outputPos);
-    } 
-    //transform global->local
-    else if((properties & kHitInGlobalCoord) && _undoAlignment) {
-      streamlog_out(DEBUG0) << "Transforming hit from global to local!" << std::endl;
-      geo::gGeometry().master2Local(sensorID, inputPos, outputPos);
-    } 
+    _hitProperties[iHit] = properties;
+    _hitSensorIDs[iHit] = hitDecoder(inputHit)["sensorID"];
+
     //error case
-    else {
+    if( static_cast<bool>(properties & kHitInGlobalCoord) != _undoAlignment ) {
       std::cout << "Properties: " << properties << std::endl;
       std::string errMsg;
       if(!_undoAlignment) {
@@ -138,9 +138,30 @@ void EUTelHitCoordinateTransformer::processEvent(LCEvent* event)
       }
       throw InvalidGeometryException(errMsg);
     }
+
+    const double* inputPos = inputHit->getPosition();
+    std::copy(inputPos, inputPos+3, _hitPositions.begin()+3*iHit);
+  }//[END] loop over hits
+
+  if(!_undoAlignment) {
+    streamlog_out(DEBUG0) << "Transforming hits from local to global!" << std::endl;
+  } else {
+    streamlog_out(DEBUG0) << "Transforming hits from global to local!" << std::endl;
+  }
+  if(_vectorisedTransform) {
+    transformVectorised();
+  } else {
+    transformConsecutive();
+  }
+
+  //[START] loop over hits: create the output hits
+  for(size_t iHit = 0; iHit < noOfHits; ++iHit) {  
+    
+    TrackerHitImpl* inputHit = static_cast<TrackerHitImpl*>(inputCollection->getElementAt(static_cast<int>(iHit)));
+    TrackerHitImpl* outputHit = new IMPL::TrackerHitImpl(); 
 	
     //fill new outputHit with information
-    outputHit->setPosition(outputPos);
+    outputHit->setPosition(_hitPositions.data()+3*iHit);
     outputHit->setCovMatrix( inputHit->getCovMatrix());
     outputHit->setType( inputHit->getType() );
     outputHit->setTime( inputHit->getTime() );
@@ -152,7 +173,7 @@ void EUTelHitCoordinateTransformer::processEvent(LCEvent* event)
     //and reencode hit
     cellReencoder.readValues(outputHit);
     //^= is a bitwise XOR i.e. will switch the coordinate system
-    cellReencoder["properties"] = properties ^= kHitInGlobalCoord;
+    cellReencoder["properties"] = _hitProperties[iHit] ^ kHitInGlobalCoord;
     cellReencoder.setCellID(outputHit);
     //finally store it in collection
     outputCollection->push_back(outputHit);
@@ -167,6 +188,74 @@ void EUTelHitCoordinateTransformer::processEvent(LCEvent* event)
   }
 }
 
+void EUTelHitCoordinateTransformer::transformConsecutive()
+{
+  //use local2MasterBatch/master2LocalBatch function in EUTelGeometryTelescopeDescription
+  //to translate the positions in place, one batch per run of hits on the same sensor
+  auto const noOfHits = _hitSensorIDs.size();
+  for(size_t iFirst = 0; iFirst < noOfHits; ) {
+    size_t iLast = iFirst + 1;
+    while(iLast < noOfHits && _hitSensorIDs[iLast] == _hitSensorIDs[iFirst]) ++iLast;
+
+    double* positions = _hitPositions.data()+3*iFirst;
+    if(!_undoAlignment) {
+      geo::gGeometry().local2MasterBatch(_hitSensorIDs[iFirst], iLast-iFirst, positions, positions);
+    } else {
+      geo::gGeometry().master2LocalBatch(_hitSensorIDs[iFirst], iLast-iFirst, positions, positions);
+    }
+    iFirst = iLast;
+  }
+}
+
+void EUTelHitCoordinateTransformer::transformVectorised()
+{
+  auto const noOfHits = _hitSensorIDs.size();
+
+  //group the hits by sensor, keeping their order within a sensor
+  _hitOrder.resize(noOfHits);
+  for(size_t iHit = 0; iHit < noOfHits; ++iHit) _hitOrder[iHit] = iHit;
+  std::stable_sort(_hitOrder.begin(), _hitOrder.end(), [this](size_t a, size_t b) {
+    return _hitSensorIDs[a] < _hitSensorIDs[b];
+  });
+
+  //gather into structure-of-arrays buffers
+  for(auto buffer: {&_inputX, &_inputY, &_inputZ, &_outputX, &_outputY, &_outputZ}) {
+    buffer->resize(noOfHits);
+  }
+  for(size_t iSorted = 0; iSorted < noOfHits; ++iSorted) {
+    auto const iHit = _hitOrder[iSorted];
+    _inputX[iSorted] = _hitPositions[3*iHit];
+    _inputY[iSorted] = _hitPositions[3*iHit+1];
+    _inputZ[iSorted] = _hitPositions[3*iHit+2];
+  }
+
+  //one vectorised batch per sensor
+  for(size_t iFirst = 0; iFirst < noOfHits; ) {
+    auto const sensorID = _hitSensorIDs[_hitOrder[iFirst]];
+    size_t iLast = iFirst + 1;
+    while(iLast < noOfHits && _hitSensorIDs[_hitOrder[iLast]] == sensorID) ++iLast;
+
+    if(!_undoAlignment) {
+      geo::gGeometry().local2MasterBatch(sensorID, iLast-iFirst, 
+                                         &_inputX[iFirst], &_inputY[iFirst], &_inputZ[iFirst],
+                                         &_outputX[iFirst], &_outputY[iFirst], &_outputZ[iFirst]);
+    } else {
+      geo::gGeometry().master2LocalBatch(sensorID, iLast-iFirst, 
+                                         &_inputX[iFirst], &_inputY[iFirst], &_inputZ[iFirst],
+                                         &_outputX[iFirst], &_outputY[iFirst], &_outputZ[iFirst]);
+    }
+    iFirst = iLast;
+  }
+
+  //scatter back in input order
+  for(size_t iSorted = 0; iSorted < noOfHits; ++iSorted) {
+    auto const iHit = _hitOrder[iSorted];
+    _hitPositions[3*iHit] = _outputX[iSorted];
+    _hitPositions[3*iHit+1] = _outputY[iSorted];
+    _hitPositions[3*iHit+2] = _outputZ[iSorted];
+  }
+}
+
 void EUTelHitCoordinateTransformer::end()
 {
   streamlog_out(MESSAGE4) << "Successfully finished" << std::endl;
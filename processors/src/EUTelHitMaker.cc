@@ -59,7 +59,8 @@ using namespace eutelescope;
 EUTelHitMaker::EUTelHitMaker()
     : Processor("EUTelHitMaker"), _pulseCollectionName(),
       _hitCollectionName(), _switchLocalCoordinates(false), _histogramSwitch(true),
-      _iRun(0), _iEvt(0), _alreadyBookedSensorID() {
+      _iRun(0), _iEvt(0), _alreadyBookedSensorID(), _hits(), _hitSensorIDs(),
+      _hitPositions() {
  
   _description = "EUTelHitMaker is responsible to translate cluster "
                  "centers from the local frame of reference \n to the external "
@@ -161,6 +162,9 @@ void EUTelHitMaker::processEvent(LCEvent *event) {
     hitCollection = new LCCollectionVec(LCIO::TRACKERHIT);
   }
 
+  //one view of the geometry for all hits of this event
+  auto const geometry = geo::gGeometry().getSnapshot();
+
   //prepare an encoder for the hit collection
   CellIDEncoder<TrackerHitImpl> idHitEncoder(EUTELESCOPE::HITENCODING,
                                              hitCollection);
@@ -168,6 +172,10 @@ void EUTelHitMaker::processEvent(LCEvent *event) {
   CellIDDecoder<TrackerDataImpl> cellDecoder(
       EUTELESCOPE::ZSDATADEFAULTENCODING);
 
+  _hits.clear();
+  _hitSensorIDs.clear();
+  _hitPositions.clear();
+
   int oldDetectorID = -100;
   double xSize = 0., ySize = 0.;
   double resolutionX = 0., resolutionY = 0.;
@@ -199,12 +207,13 @@ void EUTelHitMaker::processEvent(LCEvent *event) {
       }
 
       //all values given in mm
-      resolutionX = geo::gGeometry().getPlaneXResolution(sensorID);
-      resolutionY = geo::gGeometry().getPlaneYResolution(sensorID);
-      xSize = geo::gGeometry().getPlaneXSize(sensorID);
-      ySize = geo::gGeometry().getPlaneYSize(sensorID);
-      xPitch = geo::gGeometry().getPlaneXPitch(sensorID);
-      yPitch = geo::gGeometry().getPlaneYPitch(sensorID);
+      auto const & plane = geometry->getPlaneRecord(sensorID);
+      resolutionX = plane.xResolution;
+      resolutionY = plane.yResolution;
+      xSize = plane.size(0);
+      ySize = plane.size(1);
+      xPitch = plane.xPitch;
+      yPitch = plane.yPitch;
     }
 
     //LOCAL coordinate system!
@@ -333,31 +342,8 @@ void EUTelHitMaker::processEvent(LCEvent *event) {
     }
 #endif
 
-    if(!_switchLocalCoordinates) {
-      // NOW !!
-      // GLOBAL coordinate system !!!
-      const double localPos[3] = {telPos[0], telPos[1], telPos[2]};
-      geo::gGeometry().local2Master(sensorID, localPos, telPos);
-    }
-
-#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
-    if(_histogramSwitch) {
-      AIDA::IHistogram2D *histo_tel = dynamic_cast<AIDA::IHistogram2D *>(
-              _hitTelescopeHistos[sensorID]);
-      if(histo_tel) {	
-        histo_tel->fill(telPos[0], telPos[1]);
-      } else {
-        streamlog_out(ERROR1)
-            << "Not able to retrieve histogram pointer for hitTelescope_det" << sensorID
-            << ".\nDisabling histogramming from now on " << std::endl;
-        _histogramSwitch = false;
-      }
-    }
-#endif
-
     //create new hit
     TrackerHitImpl *hit = new TrackerHitImpl;
-    hit->setPosition(&telPos[0]);
     float cov[TRKHITNCOVMATRIX] = {0., 0., 0., 0., 0., 0.};
     double resx = resolutionX;
     double resy = resolutionY;
@@ -374,6 +360,11 @@ void EUTelHitMaker::processEvent(LCEvent *event) {
     //add the clusterVec to the hit
     hit->rawHits() = clusterVec;
 
+    //keep the local position, all hits are transformed after the loop
+    _hits.push_back(hit);
+    _hitSensorIDs.push_back(sensorID);
+    _hitPositions.insert(_hitPositions.end(), telPos, telPos+3);
+
     //determine sensorID from the cluster data
     idHitEncoder["sensorID"] = sensorID;
 
@@ -388,6 +379,41 @@ void EUTelHitMaker::processEvent(LCEvent *event) {
     
   }//[END] loop over cluster
 
+  if(!_switchLocalCoordinates) {
+    // NOW !!
+    // GLOBAL coordinate system !!!
+    // transform the positions in place, one batch per run of hits on the same sensor
+    for(size_t iFirst = 0; iFirst < _hits.size(); ) {
+      size_t iLast = iFirst + 1;
+      while(iLast < _hits.size() && _hitSensorIDs[iLast] == _hitSensorIDs[iFirst]) ++iLast;
+      double *positions = _hitPositions.data() + 3 * iFirst;
+      geometry->local2MasterBatch(_hitSensorIDs[iFirst], iLast - iFirst,
+                                  positions, positions);
+      iFirst = iLast;
+    }
+  }
+
+  for(size_t iHit = 0; iHit < _hits.size(); ++iHit) {
+    double const *telPos = _hitPositions.data() + 3 * iHit;
+    _hits[iHit]->setPosition(telPos);
+
+#if defined(USE_AIDA) || defined(MARLIN_USE_AIDA)
+    if(_histogramSwitch) {
+      int sensorID = _hitSensorIDs[iHit];
+      AIDA::IHistogram2D *histo_tel = dynamic_cast<AIDA::IHistogram2D *>(
+              _hitTelescopeHistos[sensorID]);
+      if(histo_tel) {	
+        histo_tel->fill(telPos[0], telPos[1]);
+      } else {
+        streamlog_out(ERROR1)
+            << "Not able to retrieve histogram pointer for hitTelescope_det" << sensorID
+            << ".\nDisabling histogramming from now on " << std::endl;
+        _histogramSwitch = false;
+      }
+    }
+#endif
+  }
+
   try {
     event->getCollection(_hitCollectionName);
   } catch(...) {
@@ -11,9 +11,9 @@
 #include "EUTelNoisyClusterMasker.h"
 #include "CellIDReencoder.h"
 #include "EUTELESCOPE.h"
+#include "EUTelNoisyPixelIndex.h"
 #include "EUTelRunHeaderImpl.h"
 #include "EUTelTrackerDataInterfacerImpl.h"
-#include "EUTelUtility.h"
 
 // marlin includes ".h"
 #include "marlin/Processor.h"
@@ -35,7 +35,6 @@
 #include <Exceptions.h>
 
 // system includes <>
-#include <algorithm>
 #include <memory>
 
 namespace eutelescope {
@@ -45,7 +44,7 @@ namespace eutelescope {
   EUTelNoisyClusterMasker::EUTelNoisyClusterMasker()
       : Processor("EUTelNoisyClusterMasker"), _inputCollectionName(""),
         _iRun(0), _iEvt(0), _firstEvent(true), _dataFormatChecked(false),
-        _wrongDataFormat(false) {
+        _wrongDataFormat(false), _noisyPixelIndex() {
         
     _description = "EUTelNoisyClusterMasker masks pulses which contain hot "
                    "pixels. For this, the quality field of pulses "
@@ -79,13 +78,16 @@ namespace eutelescope {
     ++_iRun;
     //reset event counter
     _iEvt = 0;
+    //the noisy pixels are read again in the first event of the run
+    _firstEvent = true;
   }
 
   void EUTelNoisyClusterMasker::processEvent(LCEvent *event) {
     if (_firstEvent) {
-      //noisy pixel collection stores all thot pixels in event #1, thus read it
-      _noisyPixelMap =
-          Utility::readNoisyPixelList(event, _noisyPixelCollectionName);
+      //noisy pixel collection stores all thot pixels in event #1, thus read it,
+      //the index is shared with all other processors using the collection
+      _noisyPixelIndex =
+          EUTelNoisyPixelIndex::getShared(event, _noisyPixelCollectionName);
       _firstEvent = false;
     }
 
@@ -116,8 +118,9 @@ namespace eutelescope {
           pulseInputCollectionVec->getElementAt(iPulse));
       int sensorID = cellDecoder(pulseData)["sensorID"];
 
-      //get noise vector for the given plane
-      std::vector<int> *noiseVector = &(_noisyPixelMap[sensorID]);
+      //get the noisy pixels of the given plane, nothing to do if there are none
+      auto noisyPixels = _noisyPixelIndex->getSensorMask(sensorID);
+      if(noisyPixels == nullptr) continue;
 
       //each pulse has tracker data attached to it
       TrackerDataImpl *trackerData =
@@ -127,19 +130,8 @@ namespace eutelescope {
           EUTELESCOPE::ZSCLUSTERDEFAULTENCODING);
       int pixelType = trackerDecoder(trackerData)["sparsePixelType"];
 
-      //interface to sparsified data
-      auto sparseData = Utility::getSparseData(trackerData, pixelType);
-      bool noisy = false;
-
-      //[START] loop over all hits
-      for(auto &pixelRef : *sparseData) {
-        auto &pixel = pixelRef.get();
-        if(std::binary_search(noiseVector->begin(), noiseVector->end(),
-                Utility::cantorEncode(pixel.getXCoord(), pixel.getYCoord()))) {
-          noisy = true;
-          break;
-        }
-      }//[END] loop over all hits
+      bool noisy = noisyPixels->containsNoisyPixel(
+          trackerData, static_cast<SparsePixelType>(pixelType));
 
       if(noisy) {
         int quality = cellDecoder(pulseData)["quality"];
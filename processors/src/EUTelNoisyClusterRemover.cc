@@ -10,6 +10,7 @@
 // eutelescope includes ".h"
 #include "EUTelNoisyClusterRemover.h"
 #include "EUTELESCOPE.h"
+#include "EUTelNoisyPixelIndex.h"
 #include "EUTelUtility.h"
 #include "EUTelTrackerDataInterfacerImpl.h"
 
@@ -22,6 +23,7 @@
 #include <LCIOTypes.h>
 
 #include <IMPL/LCCollectionVec.h>
+#include <IMPL/TrackerDataImpl.h>
 #include <IMPL/TrackerPulseImpl.h>
 #include <UTIL/CellIDDecoder.h>
 #include <UTIL/CellIDEncoder.h>
@@ -39,13 +41,14 @@ namespace eutelescope {
 
   EUTelNoisyClusterRemover::EUTelNoisyClusterRemover()
       : Processor("EUTelNoisyClusterRemover"),
-        _inputCollectionName(""), _outputCollectionName(""), _iRun(0),
-        _iEvt(0) {
+        _inputCollectionName(""), _outputCollectionName(""),
+        _noisyPixelCollectionName(""), _iRun(0), _iEvt(0),
+        _noisyPixelIndex() {
 
     _description = "EUTelNoisyClusterRemover removes masked noisy "
-                   "clusters (TrackerPulses) from a collection. It does "
-                   "not read in a hot pixel collection, but removes masked "
-                   "TrackerPulses.";
+                   "clusters (TrackerPulses) from a collection. By default "
+                   "it does not read in a hot pixel collection, but removes "
+                   "masked TrackerPulses.";
 
     registerInputCollection(LCIO::TRACKERPULSE, 
 			    "InputCollectionName",
@@ -58,6 +61,13 @@ namespace eutelescope {
 			     "Output collection where noisy clusters have been removed",
 			     _outputCollectionName,
 			     std::string("noisefree_clusters"));
+
+    registerOptionalParameter("HotPixelCollectionName",
+			      "Name of the hot pixel collection. If set, pulses "
+			      "containing hot pixels are removed as well, even if "
+			      "they have not been masked",
+			      _noisyPixelCollectionName,
+			      std::string(""));
   }
 
   void EUTelNoisyClusterRemover::init() {
@@ -78,10 +88,19 @@ namespace eutelescope {
     ++_iRun;
     //reset event counter
     _iEvt = 0;
+    //the noisy pixels are read again in the first event of the run
+    _noisyPixelIndex.reset();
   }
 
   void EUTelNoisyClusterRemover::processEvent(LCEvent *event) {
-  
+
+    //noisy pixel collection stores all hot pixels in event #1, the index is
+    //shared with all other processors using the collection
+    if(!_noisyPixelCollectionName.empty() && !_noisyPixelIndex) {
+      _noisyPixelIndex =
+          EUTelNoisyPixelIndex::getShared(event, _noisyPixelCollectionName);
+    }
+
     //get the collection of interest from the event
     LCCollectionVec *pulseInputCollectionVec = nullptr;
     try {
@@ -126,9 +145,24 @@ namespace eutelescope {
       //and its quality
       int quality = cellDecoder(inputPulse)["quality"];
       int sensorID = cellDecoder(inputPulse)["sensorID"];
+      bool noisy = quality & kNoisyCluster;
+
+      //check the pixels if requested and the plane has noisy pixels
+      if(!noisy && _noisyPixelIndex) {
+        auto noisyPixels = _noisyPixelIndex->getSensorMask(sensorID);
+        if(noisyPixels != nullptr) {
+          TrackerDataImpl *trackerData =
+              dynamic_cast<TrackerDataImpl *>(inputPulse->getTrackerData());
+          CellIDDecoder<TrackerDataImpl> trackerDecoder(
+              EUTELESCOPE::ZSCLUSTERDEFAULTENCODING);
+          int pixelType = trackerDecoder(trackerData)["sparsePixelType"];
+          noisy = noisyPixels->containsNoisyPixel(
+              trackerData, static_cast<SparsePixelType>(pixelType));
+        }
+      }
 
       //if kNoisyCluster flag is NOT set, add pulse to output collection
-      if(!(quality & kNoisyCluster)) {
+      if(!noisy) {
         //TrackerPulseImpl for output collection
         std::unique_ptr<TrackerPulseImpl> outputPulse =
 	  std::make_unique<TrackerPulseImpl>();
@@ -45,6 +45,7 @@
 #include <Exceptions.h>
 
 // system includes <>
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <iterator>
@@ -57,8 +58,10 @@ namespace eutelescope {
   EUTelNoisyPixelFinder::EUTelNoisyPixelFinder()
       : Processor("EUTelNoisyPixelFinder"), _zsDataCollectionName(""),
         _noisyPixelCollectionName(""), _excludedPlanes(), _noOfEvents(0),
-        _maxAllowedFiringFreq(0.0), _iRun(0), _iEvt(0), _sensorIDVec(),
-        _noisyPixelDBFile(""), _finished(false) {
+        _maxAllowedFiringFreq(0.0), _noiseCutBins(100), _noiseCutHigh(0.006),
+        _noiseCuts(), _iRun(0), _iEvt(0), _sensorIDVec(),
+        _noisyPixelDBFile(""), _finished(false), _pixelColumns(),
+        _pixelIndices() {
         
     _description = "EUTelNoisyPixelFinder computes the firing "
                    "frequency of pixels and applies a cut on this value to "
@@ -123,28 +126,18 @@ namespace eutelescope {
         thisSensor.offY  = minY;
         thisSensor.sizeY = maxY-minY+1;
 
-        //this is the 2-dimensional array used to store all the pixels, it is
-        //implemented as a vector of vectors
-        //first the x-entries-vector
-        std::vector<std::vector<long int>> hitVecP =
-            std::vector<std::vector<long int>>(thisSensor.sizeX);
-
-        //and the y-entries vector
-        for(auto &ihit : hitVecP) {
-          //resize it now
-          ihit.resize(thisSensor.sizeY, 0);
-        }
-
-		//make vector for firing frequency
-	    auto& firingFreqVec = _firingFreqForAllPixels[sensorID];
-	    firingFreqVec.resize(thisSensor.sizeX*thisSensor.sizeY);
+        //one contiguous counter array per sensor, x-major
+        std::vector<std::uint32_t> hitCounts(
+            static_cast<size_t>(thisSensor.sizeX) *
+                static_cast<size_t>(thisSensor.sizeY),
+            0);
 
         //collection to later hold the hot pixels
         std::vector<EUTelGenericSparsePixel> noisyPixelMap;
 
         //store all the collections/pointers in the corresponding maps
         _sensorMap[sensorID] = thisSensor;
-        _hitVecMap[sensorID] = hitVecP;
+        _hitCountMap[sensorID] = std::move(hitCounts);
         _noisyPixelMap[sensorID] = noisyPixelMap;
       } catch (std::runtime_error &e) {
         streamlog_out(ERROR0) << "Noisy pixel masker could not retrieve plane "
@@ -166,6 +159,13 @@ namespace eutelescope {
     geo::gGeometry().initializeTGeoDescription(EUTELESCOPE::GEOFILENAME,
                                                EUTELESCOPE::DUMPGEOROOT);
 
+    //the noise cuts of the noisy pixel vs. noise cut histogram
+    _noiseCuts.clear();
+    long double cutsteps = _noiseCutHigh/static_cast<long double>(_noiseCutBins);
+    for(int ibin = 1; ibin <= _noiseCutBins*10; ++ibin) {
+      _noiseCuts.emplace_back(ibin*cutsteps);
+    }
+
     //prepare the hit maps
     initializeHitMaps();
   }
@@ -196,7 +196,7 @@ namespace eutelescope {
         int sensorID = static_cast<int>(cellDecoder(zsData)["sensorID"]);
 
         sensor *currentSensor = &_sensorMap[sensorID];
-        std::vector<std::vector<long int>> *hitArray = &_hitVecMap[sensorID];
+        std::vector<std::uint32_t> &hitCounts = _hitCountMap[sensorID];
 
         //if this is an excluded sensor go to the next element
         bool foundExcludedSensor = false;
@@ -205,25 +205,36 @@ namespace eutelescope {
         }
         if(foundExcludedSensor) continue;
 
-        //now prepare the EUTelescope interface to sparsified data
+        //decode the pixel indices only, no pixel objects are needed
         int pixelType = cellDecoder(zsData)["sparsePixelType"];
-        auto sparseData = Utility::getSparseData(zsData, pixelType);
-
-        //loop over all pixels in the sparseData object, these are the hit pixels
-        for(auto &pixelRef : *sparseData) {
-          auto &pixel = pixelRef.get();
-
-          //compute the address in the array-like-structure, any offset
-          //has to be substracted (array index starts at 0)
-          int indexX = pixel.getXCoord() - currentSensor->offX;
-          int indexY = pixel.getYCoord() - currentSensor->offY;
+        _pixelColumns.decode(zsData, static_cast<SparsePixelType>(pixelType));
+        auto const & xCoords = _pixelColumns.getXCoords();
+        auto const & yCoords = _pixelColumns.getYCoords();
+
+        //compute the counter index of all hit pixels, any offset has to be
+        //substracted (array index starts at 0). There are no dependencies
+        //between the pixels in this loop, so it can be vectorised
+        long const offX = currentSensor->offX;
+        long const offY = currentSensor->offY;
+        long const sizeX = currentSensor->sizeX;
+        long const sizeY = currentSensor->sizeY;
+        _pixelIndices.resize(_pixelColumns.size());
+        for(size_t iPixel = 0; iPixel < _pixelColumns.size(); ++iPixel) {
+          long indexX = xCoords[iPixel] - offX;
+          long indexY = yCoords[iPixel] - offY;
+          bool inRange = indexX >= 0 && indexX < sizeX && indexY >= 0 &&
+                         indexY < sizeY;
+          _pixelIndices[iPixel] = inRange ? indexX * sizeY + indexY : -1;
+        }
 
-          try {
-            //increment the hit counter for this pixel
-            (hitArray->at(indexX)).at(indexY)++;
-          } catch(std::out_of_range &e) {
+        //increment the hit counters
+        for(size_t iPixel = 0; iPixel < _pixelIndices.size(); ++iPixel) {
+          long index = _pixelIndices[iPixel];
+          if(index >= 0) {
+            ++hitCounts[static_cast<size_t>(index)];
+          } else {
             streamlog_out(ERROR5)
-                << "Pixel: " << pixel.getXCoord() << "|" << pixel.getYCoord()
+                << "Pixel: " << xCoords[iPixel] << "|" << yCoords[iPixel]
                 << " on plane: " << sensorID << " fired." << std::endl
                 << "This pixel is out of the range defined by the geometry. "
                    "Either your data is corrupted or your pixel geometry not "
@@ -325,31 +336,44 @@ namespace eutelescope {
                                    "~~~~~~~~~~~~~~~~~~~~~~~"
                                 << std::endl;
 
-        //get the corresponding hit array-like vector of vectors
-        std::vector<std::vector<long int>> *hitVector = &_hitVecMap[sensorID];
+        //get the corresponding hit counters
+        std::vector<std::uint32_t> const &hitCounts = _hitCountMap[sensorID];
         //and the sensor which stores offsets
         sensor *currentSensor = &_sensorMap[sensorID];
-		auto& firingFreqVec = _firingFreqForAllPixels[sensorID]; 
+        //entry i counts the pixels above exactly i noise cuts
+        auto &noiseCutHisto = _noiseCutHistoMap[sensorID];
+        noiseCutHisto.assign(_noiseCuts.size() + 1, 0);
+
+        //pixels which never fired are below all noise cuts and, unless the
+        //cut is negative, not noisy, so they can be skipped
+        bool const skipSilentPixels = _maxAllowedFiringFreq >= 0;
 
         //[START] loop over all pixels
-        for(auto xIt = hitVector->begin(); xIt != hitVector->end(); ++xIt) {
-          for(auto yIt = xIt->begin(); yIt != xIt->end(); ++yIt) {
-            //compute the firing frequency
-            double fireFreq = static_cast<double>(*yIt) / static_cast<double>(_iEvt);
-            firingFreqVec.push_back(fireFreq);
-            //if larger than the allowed one, write pixel into a collection
-            if(fireFreq > _maxAllowedFiringFreq) {
-              streamlog_out(MESSAGE3)
-                  << "Pixel: " << xIt - hitVector->begin() + currentSensor->offX
-                  << "|" << yIt - xIt->begin() + currentSensor->offY
-                  << " fired " << fireFreq << std::endl;
-              EUTelGenericSparsePixel pixel;
-              pixel.setXCoord(xIt - hitVector->begin() + currentSensor->offX);
-              pixel.setYCoord(yIt - xIt->begin() + currentSensor->offY);
-              pixel.setSignal(fireFreq);
-              //writing it out
-              _noisyPixelMap[sensorID].push_back(pixel);
-            }
+        size_t sizeY = static_cast<size_t>(currentSensor->sizeY);
+        for(size_t index = 0; index < hitCounts.size(); ++index) {
+          if(skipSilentPixels && hitCounts[index] == 0) continue;
+
+          //compute the firing frequency
+          double fireFreq = static_cast<double>(hitCounts[index]) / static_cast<double>(_iEvt);
+
+          //the number of noise cuts below the firing frequency
+          auto cutIt = std::lower_bound(_noiseCuts.begin(), _noiseCuts.end(),
+                                        static_cast<long double>(fireFreq));
+          ++noiseCutHisto[static_cast<size_t>(cutIt - _noiseCuts.begin())];
+
+          //if larger than the allowed one, write pixel into a collection
+          if(fireFreq > _maxAllowedFiringFreq) {
+            int xCoord = static_cast<int>(index / sizeY) + currentSensor->offX;
+            int yCoord = static_cast<int>(index % sizeY) + currentSensor->offY;
+            streamlog_out(MESSAGE3)
+                << "Pixel: " << xCoord << "|" << yCoord
+                << " fired " << fireFreq << std::endl;
+            EUTelGenericSparsePixel pixel;
+            pixel.setXCoord(xCoord);
+            pixel.setYCoord(yCoord);
+            pixel.setSignal(fireFreq);
+            //writing it out
+            _noisyPixelMap[sensorID].push_back(pixel);
           }
         }//[END] loop over pixel
       }//[END] loop over sensors
@@ -472,11 +496,9 @@ namespace eutelescope {
       
       //create 1D histogram: noisy pixel vs noise cut   	
       std::string histName_noisyPixelVsNoiseCut = basePath+"/NoisyPixel_vs_NoiseCut_det"+ std::to_string(det);
-      int nbin = 100;
       double cutLow = 0;
-      double cutHigh = 0.006;
       AIDA::IHistogram1D *hist1D_noisyPixelVsNoiseCut = marlin::AIDAProcessor::histogramFactory(this)->
-	createHistogram1D(histName_noisyPixelVsNoiseCut, nbin, cutLow, cutHigh);
+	createHistogram1D(histName_noisyPixelVsNoiseCut, _noiseCutBins, cutLow, _noiseCutHigh);
       hist1D_noisyPixelVsNoiseCut->setTitle("Number of noisy pixels for given noise cut; noise cut; #noisy pixels");
       
       //create 1D histogram: firing frequency
@@ -497,25 +519,14 @@ namespace eutelescope {
 	createHistogram2D(histName_firingFreq2D, xBin, xMin, xMax, yBin, yMin, yMax);
       hist2D_firingFreq->setTitle("Firing frequency map of hot pixels; Pixel Index X; Pixel Index Y; Percent (%)");
     	
-      //fill vectors for firing frequency and noise cut values
-      auto& firingFreqVec = _firingFreqForAllPixels[det];
-      std::sort(firingFreqVec.begin(), firingFreqVec.end(), [](const double a, const double b) {return a > b; });
-      std::vector<long double> cuts;
-      long double cutsteps = cutHigh/static_cast<long double>(nbin);
-      for(int ibin = 1; ibin <= nbin*10; ++ibin) {
-	cuts.emplace_back(ibin*cutsteps);
-      } 
-      	
-      //fill dataPointSet with noisy pixels in dependence of noise cut
+      //fill dataPointSet with noisy pixels in dependence of noise cut, the
+      //pixels above a cut are the ones above more cuts, highest cut first
+      auto& noiseCutHisto = _noiseCutHistoMap[det];
+      noiseCutHisto.resize(_noiseCuts.size() + 1, 0);
       long counter = 0;
-      for(auto it = firingFreqVec.begin(); it != firingFreqVec.end(); ++it){
-	if(cuts.back() >= *it) {
-	  while(cuts.back() >= *it){
-	    dataPointSet->fill(cuts.back(), counter);
-	    cuts.pop_back();
-	  }
-	}
-	counter++;
+      for(size_t iCut = _noiseCuts.size(); iCut-- > 0;) {
+	counter += noiseCutHisto[iCut + 1];
+	dataPointSet->fill(_noiseCuts[iCut], counter);
       }
       dataPointSet->fillHistogram(*hist1D_noisyPixelVsNoiseCut);
       
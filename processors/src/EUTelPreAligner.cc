@@ -13,6 +13,7 @@
 #include "EUTelBrickedClusterImpl.h"
 #include "EUTelDFFClusterImpl.h"
 #include "EUTelEventImpl.h"
+#include "EUTelExceptions.h"
 #include "EUTelFFClusterImpl.h"
 #include "EUTelGeometryTelescopeGeoDescription.h"
 #include "EUTelRunHeaderImpl.h"
@@ -117,6 +118,24 @@ EUTelPreAligner::EUTelPreAligner()
 			    _histogramSwitch,
 			    true);
 
+  registerOptionalParameter("ConvergenceCheckInterval",
+			    "Number of events between two checks whether the offsets "
+			    "are stable, 0 to always use RequiredEvents (default: 0)",
+			    _convergenceCheckInterval,
+			    0);
+
+  registerOptionalParameter("ConvergenceTolerance",
+			    "Maximal change of all offsets [mm] between two checks for "
+			    "the pre-alignment to be converged (default: 0.01)",
+			    _convergenceTolerance,
+			    0.01f);
+
+  registerOptionalParameter("StopOnConvergence",
+			    "Stop the processing of the whole job once the offsets "
+			    "are converged, otherwise only the pre-alignment stops (default: false)",
+			    _stopOnConvergence,
+			    false);
+
   registerOptionalParameter("DumpGEAR",
 			    "Dump alignment into GEAR file instead of prealignment database",
 			    _dumpGEAR,
@@ -149,17 +168,33 @@ void EUTelPreAligner::init() {
   //usally good idea to do
   printParameters();
 
+  if(_convergenceCheckInterval < 0) {
+    streamlog_out(ERROR) << "The chosen ConvergenceCheckInterval: " << _convergenceCheckInterval
+                         << " is invalid, it has to be positive or 0." << std::endl;
+    throw InvalidParameterException("ConvergenceCheckInterval");
+  }
+
   //reset run and event counters
   _iRun = 0;
   _iEvt = 0;
+  _isConverged = false;
+  _lastPeaks.clear();
 
   _sensorIDVec = geo::gGeometry().sensorIDsVec();
   _sensorIDtoZOrderMap.clear();
+  _preAlignerIndex.clear();
   for(size_t index = 0; index < _sensorIDVec.size(); index++) {
   	int sensorID = _sensorIDVec.at(index);
     _sensorIDtoZOrderMap.insert(std::make_pair(sensorID, static_cast<int>(index)));
   
     if(sensorID != _fixedID) {
+      //direct lookup of the PreAligner by sensor ID
+      if(sensorID >= 0) {
+        if(static_cast<size_t>(sensorID) >= _preAlignerIndex.size()) {
+          _preAlignerIndex.resize(static_cast<size_t>(sensorID) + 1, -1);
+        }
+        _preAlignerIndex[static_cast<size_t>(sensorID)] = static_cast<int>(_preAligners.size());
+      }
       _preAligners.push_back(PreAligner(geo::gGeometry().getPlaneZPosition(sensorID),sensorID));
     }	
   }	
@@ -183,8 +218,8 @@ void EUTelPreAligner::processEvent(LCEvent *event) {
 
   ++_iEvt;
 
-  //if number of required events reached, stop
-  if(_iEvt > _requiredEvents)
+  //if number of required events reached or the offsets are converged, stop
+  if(_iEvt > _requiredEvents || _isConverged)
     return;
 
   EUTelEventImpl *evt = static_cast<EUTelEventImpl *>(event);
@@ -206,67 +241,55 @@ void EUTelPreAligner::processEvent(LCEvent *event) {
         evt->getCollection(_inputHitCollectionName));
     UTIL::CellIDDecoder<TrackerHitImpl> hitDecoder(EUTELESCOPE::HITENCODING);
 
+    //decode the hits once: the fixed plane hits and all others with their PreAligner
+    _refHits.clear();
+    _alignHits.clear();
+    for(size_t iHit = 0; iHit < inputCollectionVec->size(); iHit++) {
+
+      TrackerHitImpl *hit = dynamic_cast<TrackerHitImpl *>(
+          inputCollectionVec->getElementAt(iHit));
+      const double *pos = hit->getPosition();
+      int sensorID = hitDecoder(hit)["sensorID"];
+
+      if(sensorID == _fixedID) {
+        _refHits.emplace_back(pos[0], pos[1]);
+      } else {
+        PreAligner *pa = getPreAligner(sensorID);
+        int idZ = pa ? _sensorIDtoZOrderMap[sensorID] : -1;
+        _alignHits.push_back(alignHit{pos[0], pos[1], pos[2], idZ, pa});
+      }
+    }
+
     std::vector<float> residX;
     std::vector<float> residY;
     std::vector<PreAligner *> prealign;
 
     //[START] loop over hits in fixed plane
-    for(size_t ref = 0; ref < inputCollectionVec->size(); ref++) {
-
-      TrackerHitImpl *refHit =
-          dynamic_cast<TrackerHitImpl *>(inputCollectionVec->getElementAt(ref));
-      const double *refPos = refHit->getPosition();
-      int sensorID = hitDecoder(refHit)["sensorID"];
-      
-      //identify fixed plane
-      if(sensorID != _fixedID)
-        continue;
+    for(auto const &refPos : _refHits) {
 
       residX.clear();
       residY.clear();
       prealign.clear();
 
 	  //[START] loop over other hits
-      for(size_t iHit = 0; iHit < inputCollectionVec->size(); iHit++) {
+      for(auto const &hit : _alignHits) {
 
-        TrackerHitImpl *hit = dynamic_cast<TrackerHitImpl *>(
-            inputCollectionVec->getElementAt(iHit));
-        const double *pos = hit->getPosition();
-        int iHitID = hitDecoder(hit)["sensorID"];
-
-		//if fixed plane, skip
-        if(iHitID == _fixedID)
+        if(!hit.preAligner) {
+          streamlog_out(ERROR5) << "Mismatched hit at " << hit.z << endl;
           continue;
-          
-        bool gotIt(false);
-
-		//[START] loop over preAligners
-        for(size_t ii = 0; ii < _preAligners.size(); ii++) {
-
-          PreAligner &pa = _preAligners.at(ii);
+        }
 
-          if(pa.getIden() != iHitID)
-          	continue;
-   
-   	      gotIt = true;
-
-          double correlationX = refPos[0] - pos[0];
-          double correlationY = refPos[1] - pos[1];
-          int idZ = _sensorIDtoZOrderMap[iHitID];
-
-          if((_residualsXMin[idZ] < correlationX) &&
-              (correlationX < _residualsXMax[idZ]) &&
-              (_residualsYMin[idZ] < correlationY) &&
-              (correlationY < _residualsYMax[idZ])) {
-            residX.push_back(correlationX);
-            residY.push_back(correlationY);
-            prealign.push_back(&pa);
-          }
-          break;
-        }//[END] loop over prealigners
-        
-        if(!gotIt) {
-          streamlog_out(ERROR5) << "Mismatched hit at " << pos[2] << endl;
+        double correlationX = refPos.first - hit.x;
+        double correlationY = refPos.second - hit.y;
+        int idZ = hit.idZ;
+
+        if((_residualsXMin[idZ] < correlationX) &&
+            (correlationX < _residualsXMax[idZ]) &&
+            (_residualsYMin[idZ] < correlationY) &&
+            (correlationY < _residualsYMax[idZ])) {
+          residX.push_back(correlationX);
+          residY.push_back(correlationY);
+          prealign.push_back(hit.preAligner);
         }
       }//[END] loop over other hits
       
@@ -300,6 +323,54 @@ void EUTelPreAligner::processEvent(LCEvent *event) {
 
   if(isFirstEvent())
     _isFirstEvent = false;
+
+  //check if the offsets are stable, then the remaining events are not needed
+  if(_convergenceCheckInterval > 0 && _iEvt % _convergenceCheckInterval == 0 &&
+     checkConvergence()) {
+    _isConverged = true;
+    streamlog_out(MESSAGE5) << "Pre-alignment offsets converged within "
+                            << _convergenceTolerance << " mm after " << _iEvt
+                            << " events" << std::endl;
+    if(_stopOnConvergence) {
+      throw marlin::StopProcessingException(this);
+    }
+  }
+}
+
+bool EUTelPreAligner::checkConvergence() {
+
+  //the first check has nothing to compare to
+  bool converged = (_lastPeaks.size() == _preAligners.size());
+  _lastPeaks.resize(_preAligners.size());
+
+  //[START] loop over prealigners
+  for(size_t ii = 0; ii < _preAligners.size(); ii++) {
+    PreAligner &pa = _preAligners[ii];
+    int sensorID = pa.getIden();
+
+    //excluded planes and coordinates do not get an offset
+    if(find(_excludedPlanes.begin(), _excludedPlanes.end(), sensorID) != _excludedPlanes.end()) {
+      continue;
+    }
+    if(pa.getNoOfPoints() == 0) {
+      converged = false;
+      continue;
+    }
+    bool useX = find(_excludedPlanesXCoord.begin(), _excludedPlanesXCoord.end(), sensorID) ==
+                _excludedPlanesXCoord.end();
+    bool useY = find(_excludedPlanesYCoord.begin(), _excludedPlanesYCoord.end(), sensorID) ==
+                _excludedPlanesYCoord.end();
+    float peakX = useX ? pa.getPeakX(false) : 0.f;
+    float peakY = useY ? pa.getPeakY(false) : 0.f;
+
+    if(std::abs(peakX - _lastPeaks[ii].first) > _convergenceTolerance ||
+       std::abs(peakY - _lastPeaks[ii].second) > _convergenceTolerance) {
+      converged = false;
+    }
+    _lastPeaks[ii] = std::make_pair(peakX, peakY);
+  }//[END] loop over prealigners
+
+  return converged;
 }
 
 void EUTelPreAligner::end() {
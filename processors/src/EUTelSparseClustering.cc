@@ -62,7 +62,9 @@ EUTelSparseClustering::EUTelSparseClustering()
       _pulseCollectionName(""), _initialPulseCollectionSize(0), _iRun(0),
       _iEvt(0), _fillHistos(false), _totalClusterMap(), _noOfDetector(0), 
       _excludedPlanes(), _isGeometryReady(false), _sensorIDVec(), _zsInputDataCollectionVec(nullptr),
-      _pulseCollectionVec(nullptr), _sparseMinDistanceSquared(2) {
+      _pulseCollectionVec(nullptr), _sparseMinDistanceSquared(2),
+      _clusteringAlgorithmString(""), _useColumnIndex(false), _noOfThreads(1),
+      _threadPool(), _clusterFinders(), _pixelColumns(), _clusterStaging() {
 
   _description = "EUTelSparseClustering is looking for clusters into "
                  "a calibrated pixel matrix.";
@@ -94,6 +96,18 @@ EUTelSparseClustering::EUTelSparseClustering()
 			     _sparseMinDistanceSquared,
 			     2);
 
+  registerOptionalParameter("ClusteringAlgorithm",
+			    "Neighbour search used for the clustering. Available algorithms are:"
+			    "\n\t\tIterative - compare each cluster pixel against all remaining pixels,"
+			    "\n\t\tColumnIndex - search neighbours in a sorted column index (same clusters, scales linearly)",
+			    _clusteringAlgorithmString,
+			    std::string("Iterative"));
+
+  registerOptionalParameter("NumberOfThreads",
+			    "Number of threads used to cluster the sensors of an event concurrently (1 == no threading)",
+			    _noOfThreads,
+			    1);
+
   _isFirstEvent = true;
 }
 
@@ -102,6 +116,27 @@ void EUTelSparseClustering::init() {
   //usually a good idea to do
   printParameters();
 
+  if(_clusteringAlgorithmString == "Iterative") {
+    _useColumnIndex = false;
+  } else if(_clusteringAlgorithmString == "ColumnIndex") {
+    _useColumnIndex = true;
+  } else {
+    streamlog_out(ERROR) << "The chosen ClusteringAlgorithm: '" << _clusteringAlgorithmString
+                         << "' is invalid. Please correct your steering template and retry!" << std::endl;
+    throw InvalidParameterException("ClusteringAlgorithm");
+  }
+
+  if(_noOfThreads < 1) {
+    streamlog_out(ERROR) << "The chosen NumberOfThreads: " << _noOfThreads
+                         << " is invalid, it has to be at least 1." << std::endl;
+    throw InvalidParameterException("NumberOfThreads");
+  }
+  _clusterFinders.resize(static_cast<size_t>(_noOfThreads));
+  _pixelColumns.resize(static_cast<size_t>(_noOfThreads));
+  if(_noOfThreads > 1) {
+    _threadPool = std::make_unique<EUTelThreadPool>(static_cast<size_t>(_noOfThreads));
+  }
+
   //init new geometry
   geo::gGeometry().initializeTGeoDescription(EUTELESCOPE::GEOFILENAME,
                                              EUTELESCOPE::DUMPGEOROOT);
@@ -257,6 +292,11 @@ void EUTelSparseClustering::sparseClustering(LCEvent *evt, LCCollectionVec *puls
       EUTELESCOPE::PULSEDEFAULTENCODING, pulseCollection);
 
   //in the zsInputDataCollectionVec we should have one TrackerData for each detector working in ZS mode
+  //the cell IDs are decoded here, the decoder must not be shared among threads
+  std::vector<TrackerDataImpl*> zsDataVec;
+  std::vector<SparsePixelType> typeVec;
+  std::vector<int> sensorIDVec;
+
   //[START] loop over ZS detectors
   for(size_t iDetector = 0; iDetector < _zsInputDataCollectionVec->size(); iDetector++) {
     // get the TrackerData and guess which kind of sparsified data it contains
@@ -275,89 +315,63 @@ void EUTelSparseClustering::sparseClustering(LCEvent *evt, LCCollectionVec *puls
     }
     if(foundExcludedSensor)	continue;
 
-    auto sparseData = Utility::getSparseData(zsData, type);
-    auto hitPixelVec = sparseData->getPixels();
-    std::vector<std::reference_wrapper<EUTelBaseSparsePixel const>> newlyAdded;
-
-    //[START] loop over cluster candidates
-    while(!hitPixelVec.empty()) {
-      //prepare a TrackerData to store the cluster candidate
-      std::unique_ptr<TrackerDataImpl> zsCluster = std::make_unique<TrackerDataImpl>();
-      //prepare a reimplementation of sparsified cluster
-      auto sparseCluster = Utility::getClusterData(zsCluster.get(), type);
-
-      //take any pixel, e.g. the first one, add it to the cluster as well as 
-      //the newly added pixels
-      newlyAdded.push_back(hitPixelVec.front());
-      sparseCluster->push_back(hitPixelVec.front().get());
-      //now remove it from the original collection
-      hitPixelVec.erase(hitPixelVec.begin());
-
-      //now process all newly added pixels, initially this is the just previously 
-      //added one but in the process of neighbour finding more new pixels are added
-      while(!newlyAdded.empty()) {
-        bool newlyDone = true;
-        //check against all pixels in the hitPixelVec
-        for(auto hitVec = hitPixelVec.begin(); hitVec != hitPixelVec.end(); ++hitVec) {
-          //get the relevant infos from the newly added pixel
-          auto x_add = newlyAdded.front().get().getXCoord();
-          auto y_add = newlyAdded.front().get().getYCoord();
-
-          //and the pixel we test against
-          auto x_test = (hitVec->get()).getXCoord();
-          auto y_test = (hitVec->get()).getYCoord();
-
-          auto dX = x_add - x_test;
-          auto dY = y_add - y_test;
-          int distance = dX * dX + dY * dY;
-          //if they pass the spatial cut, add them
-          if(distance <= _sparseMinDistanceSquared) {
-            //add them to the cluster as well as to the newly added ones
-            newlyAdded.push_back(*hitVec);
-            sparseCluster->push_back(*hitVec);
-            //and remove it from the original collection
-            hitPixelVec.erase(hitVec);
-            //for test pixel there might be other neighbours, we still have to check
-            newlyDone = false;
-            break;
-          }
-        }//[END] for-loop over all pixels
-
-        //if no neighbours are found, we can delete the pixel from the newly added;
-        //tested against _ALL_ non cluster pixels, there are no other pixels
-        //which could be neighbours
-        if(newlyDone)	newlyAdded.erase(newlyAdded.begin());
-        
-      }//[END] loop over newly added
-
-      //now process the found cluster
-      if(sparseCluster->size() > 0) {
-        //set the ID for this zsCluster
-        idZSClusterEncoder["sensorID"] = sensorID;
-        idZSClusterEncoder["sparsePixelType"] = static_cast<int>(type);
-        idZSClusterEncoder["quality"] = 0;
-        idZSClusterEncoder.setCellID(zsCluster.get());
-
-        //add it to the cluster collection
-        sparseClusterCollectionVec->push_back(zsCluster.get());
-
-        //prepare a pulse for this cluster
-        std::unique_ptr<TrackerPulseImpl> zsPulse = std::make_unique<TrackerPulseImpl>();
-        idZSPulseEncoder["sensorID"] = sensorID;
-        idZSPulseEncoder["type"] = static_cast<int>(kEUTelSparseClusterImpl);
-        idZSPulseEncoder.setCellID(zsPulse.get());
-        zsPulse->setTrackerData(zsCluster.release());
-        pulseCollection->push_back(zsPulse.release());
-
-        //increment the totalClusterMap
-        _totalClusterMap[sensorID] += 1;
-      } else {
-        //cluster candidate is not passing the threshold... forget about them, 
-        //the memory should be automatically cleaned by smart ptr's
-      }
-    }//[END] loop over cluster candidates
+    zsDataVec.push_back(zsData);
+    typeVec.push_back(type);
+    sensorIDVec.push_back(sensorID);
   }//[END] loop over ZS detectors
 
+  //every sensor is clustered into its own staging buffer, this may happen concurrently
+  _clusterStaging.resize(zsDataVec.size());
+  auto clusterSensor = [&](size_t iSensor, size_t iWorker) {
+    auto& clusters = _clusterStaging[iSensor];
+    clusters.clear();
+    if(_useColumnIndex) {
+      _pixelColumns[iWorker].decode(zsDataVec[iSensor], typeVec[iSensor]);
+      columnIndexClustering(_pixelColumns[iWorker], _clusterFinders[iWorker], clusters);
+    } else {
+      auto sparseData = Utility::getSparseData(zsDataVec[iSensor], typeVec[iSensor]);
+      iterativeClustering(*sparseData, typeVec[iSensor], clusters);
+    }
+  };
+
+  if(_threadPool) {
+    _threadPool->run(zsDataVec.size(), clusterSensor);
+  } else {
+    for(size_t iSensor = 0; iSensor < zsDataVec.size(); ++iSensor) {
+      clusterSensor(iSensor, 0);
+    }
+  }
+
+  //[START] loop over clustered sensors, always in the input order
+  for(size_t iSensor = 0; iSensor < zsDataVec.size(); ++iSensor) {
+    auto type = typeVec[iSensor];
+    auto sensorID = sensorIDVec[iSensor];
+
+    //[START] loop over found clusters
+    for(auto& zsCluster: _clusterStaging[iSensor]) {
+      //set the ID for this zsCluster
+      idZSClusterEncoder["sensorID"] = sensorID;
+      idZSClusterEncoder["sparsePixelType"] = static_cast<int>(type);
+      idZSClusterEncoder["quality"] = 0;
+      idZSClusterEncoder.setCellID(zsCluster.get());
+
+      //add it to the cluster collection
+      sparseClusterCollectionVec->push_back(zsCluster.get());
+
+      //prepare a pulse for this cluster
+      std::unique_ptr<TrackerPulseImpl> zsPulse = std::make_unique<TrackerPulseImpl>();
+      idZSPulseEncoder["sensorID"] = sensorID;
+      idZSPulseEncoder["type"] = static_cast<int>(kEUTelSparseClusterImpl);
+      idZSPulseEncoder.setCellID(zsPulse.get());
+      zsPulse->setTrackerData(zsCluster.release());
+      pulseCollection->push_back(zsPulse.release());
+
+      //increment the totalClusterMap
+      _totalClusterMap[sensorID] += 1;
+    }//[END] loop over found clusters
+    _clusterStaging[iSensor].clear();
+  }//[END] loop over clustered sensors
+
   //if sparseClusterCollectionVec isn't empty, add it to the current event
   if(!isDummyAlreadyExisting) {
     if(sparseClusterCollectionVec->size() != 0) {
@@ -368,8 +382,99 @@ void EUTelSparseClustering::sparseClustering(LCEvent *evt, LCCollectionVec *puls
   }
 }
 
+void EUTelSparseClustering::iterativeClustering(EUTelTrackerDataInterfacer const &sparseData,
+                                                SparsePixelType type,
+                                                std::vector<std::unique_ptr<TrackerDataImpl>> &clusters) {
+
+  auto hitPixelVec = sparseData.getPixels();
+  std::vector<std::reference_wrapper<EUTelBaseSparsePixel const>> newlyAdded;
+
+  //[START] loop over cluster candidates
+  while(!hitPixelVec.empty()) {
+    //prepare a TrackerData to store the cluster candidate
+    std::unique_ptr<TrackerDataImpl> zsCluster = std::make_unique<TrackerDataImpl>();
+    //prepare a reimplementation of sparsified cluster
+    auto sparseCluster = Utility::getClusterData(zsCluster.get(), type);
+
+    //take any pixel, e.g. the first one, add it to the cluster as well as 
+    //the newly added pixels
+    newlyAdded.push_back(hitPixelVec.front());
+    sparseCluster->push_back(hitPixelVec.front().get());
+    //now remove it from the original collection
+    hitPixelVec.erase(hitPixelVec.begin());
+
+    //now process all newly added pixels, initially this is the just previously 
+    //added one but in the process of neighbour finding more new pixels are added
+    while(!newlyAdded.empty()) {
+      bool newlyDone = true;
+      //check against all pixels in the hitPixelVec
+      for(auto hitVec = hitPixelVec.begin(); hitVec != hitPixelVec.end(); ++hitVec) {
+        //get the relevant infos from the newly added pixel
+        auto x_add = newlyAdded.front().get().getXCoord();
+        auto y_add = newlyAdded.front().get().getYCoord();
+
+        //and the pixel we test against
+        auto x_test = (hitVec->get()).getXCoord();
+        auto y_test = (hitVec->get()).getYCoord();
+
+        auto dX = x_add - x_test;
+        auto dY = y_add - y_test;
+        int distance = dX * dX + dY * dY;
+        //if they pass the spatial cut, add them
+        if(distance <= _sparseMinDistanceSquared) {
+          //add them to the cluster as well as to the newly added ones
+          newlyAdded.push_back(*hitVec);
+          sparseCluster->push_back(*hitVec);
+          //and remove it from the original collection
+          hitPixelVec.erase(hitVec);
+          //for test pixel there might be other neighbours, we still have to check
+          newlyDone = false;
+          break;
+        }
+      }//[END] for-loop over all pixels
+
+      //if no neighbours are found, we can delete the pixel from the newly added;
+      //tested against _ALL_ non cluster pixels, there are no other pixels
+      //which could be neighbours
+      if(newlyDone)	newlyAdded.erase(newlyAdded.begin());
+      
+    }//[END] loop over newly added
+
+    if(sparseCluster->size() > 0) {
+      clusters.push_back(std::move(zsCluster));
+    }
+  }//[END] loop over cluster candidates
+}
+
+void EUTelSparseClustering::columnIndexClustering(EUTelTrackerDataColumns const &pixels,
+                                                  EUTelSparseClusterFinder &finder,
+                                                  std::vector<std::unique_ptr<TrackerDataImpl>> &clusters) {
+
+  auto const & xCoords = pixels.getXCoords();
+  auto const & yCoords = pixels.getYCoords();
+
+  finder.clear();
+  finder.reserve(pixels.size());
+  for(size_t iPixel = 0; iPixel < pixels.size(); ++iPixel) {
+    finder.addPixel(xCoords[iPixel], yCoords[iPixel]);
+  }
+  finder.findClusters(_sparseMinDistanceSquared);
+
+  //[START] loop over found clusters
+  for(size_t iCluster = 0; iCluster < finder.getNumberOfClusters(); ++iCluster) {
+    std::unique_ptr<TrackerDataImpl> zsCluster = std::make_unique<TrackerDataImpl>();
+    for(auto pixel = finder.clusterBegin(iCluster); pixel != finder.clusterEnd(iCluster); ++pixel) {
+      pixels.appendPixel(*pixel, *zsCluster);
+    }
+    clusters.push_back(std::move(zsCluster));
+  }//[END] loop over found clusters
+}
+
 void EUTelSparseClustering::end() {
 
+  //stop the worker threads
+  _threadPool.reset();
+
   streamlog_out(MESSAGE4) << "Successfully finished" << std::endl;
 
   std::map<int, int>::iterator iter = _totalClusterMap.begin();
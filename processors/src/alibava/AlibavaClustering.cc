@@ -69,7 +69,18 @@ using namespace marlin;
 using namespace alibava;
 using namespace eutelescope;
 
-AlibavaClustering::AlibavaClustering ( ) : AlibavaBaseProcessor ( "AlibavaClustering" ),
+namespace alibava
+{
+    //! A global instance of the processor, defined here since AlibavaFusedReconstruction includes the header
+    AlibavaClustering gAlibavaClustering;
+}
+
+AlibavaClustering::AlibavaClustering ( ) : AlibavaClustering ( "AlibavaClustering" )
+{
+
+}
+
+AlibavaClustering::AlibavaClustering ( std::string processorName ) : AlibavaBaseProcessor ( processorName ),
 _clusterCollectionName ( ALIBAVA::NOTSET ),
 _clustercharge ( ),
 _clustercount ( 0 )
@@ -272,6 +283,15 @@ void AlibavaClustering::processEvent ( LCEvent * anEvent )
 }
 
 void AlibavaClustering::findSeedClusters(TrackerDataImpl * trkdata, LCCollectionVec * clusterCollection, LCCollectionVec * sparseClusterCollectionVec, AlibavaEventImpl * alibavaEvent )
+{
+    // the data, copied since the filtering changes it
+    FloatVec datavec;
+    datavec = trkdata -> getChargeValues ( );
+
+    findSeedClusters ( getChipNum ( trkdata ), datavec, clusterCollection, sparseClusterCollectionVec, alibavaEvent );
+}
+
+void AlibavaClustering::findSeedClusters ( int chipnum, EVENT::FloatVec & datavec, LCCollectionVec * clusterCollection, LCCollectionVec * sparseClusterCollectionVec, AlibavaEventImpl * alibavaEvent )
 {
     // magic is done here
     streamlog_out ( DEBUG4 ) << "Find Seed loop " << alibavaEvent -> getEventNumber ( ) << endl;
@@ -280,7 +300,6 @@ void AlibavaClustering::findSeedClusters(TrackerDataImpl * trkdata, LCCollection
     float tdc = alibavaEvent -> getEventTime ( );
 
     // the chip number
-    int chipnum = getChipNum ( trkdata );
     streamlog_out ( DEBUG4 ) << "Chip " << chipnum << endl;
 
     // channel spacer
@@ -290,10 +309,6 @@ void AlibavaClustering::findSeedClusters(TrackerDataImpl * trkdata, LCCollection
 	dchip = ALIBAVA::NOOFCHANNELS;
     }
 
-    // the data
-    FloatVec datavec;
-    datavec = trkdata -> getChargeValues ( );
-
     // output the filtered data too
     FloatVec newdatavec;
 
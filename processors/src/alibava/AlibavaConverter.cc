@@ -13,6 +13,10 @@
 #include "AlibavaRunHeaderImpl.h"
 #include "AlibavaEventImpl.h"
 
+// eutelescope includes
+#include "EUTelDecoderPipeline.h"
+#include "EUTelMappedFile.h"
+
 // marlin includes
 #include "marlin/Global.h"
 #include "marlin/Exceptions.h"
@@ -26,6 +30,7 @@
 #include <IMPL/LCGenericObjectImpl.h>
 #include <IMPL/LCEventImpl.h>
 #include <UTIL/CellIDEncoder.h>
+#include <Exceptions.h>
 
 // system includes
 #include <iostream>
@@ -40,6 +45,8 @@
 using namespace std;
 using namespace marlin;
 using namespace alibava;
+using eutelescope::EUTelDecoderPipeline;
+using eutelescope::EUTelMappedFile;
 
 AlibavaConverter::AlibavaConverter ( ) : DataSourceProcessor ( "AlibavaConverter" ),
 _fileName ( ALIBAVA::NOTSET ),
@@ -51,7 +58,11 @@ _rawChipHeaderCollectionName ( "chipheader" ),
 _chipSelection ( ),
 _startEventNum ( -1 ),
 _stopEventNum ( -1 ),
-_storeHeaderPedestalNoise ( false )
+_storeHeaderPedestalNoise ( false ),
+_nDecoderThreads ( 0 ),
+_decoderQueueSize ( 64 ),
+_headerVersion ( 0 ),
+_userEventTypeCode ( 0 )
 {
     // initialize few variables
     _description = "Reads data streams produced by an ALiBaVa and produces the corresponding LCIO output";
@@ -75,6 +86,10 @@ _storeHeaderPedestalNoise ( false )
 
     registerOptionalParameter ( "StoreHeaderPedestalNoise", "Alibava stores a pedestal and a noise set in the run header. These values are not used in the rest of the analysis, so it is optional to store them. By default they will not be stored, but it you want you can set this variable to true to store them in the header of the slcio file", _storeHeaderPedestalNoise, false );
 
+    registerOptionalParameter ( "NumberOfDecoderThreads", "The number of threads decoding events ahead of the processing. Default value is 0, in this case each event is decoded right before processing it", _nDecoderThreads, 0 );
+
+    registerOptionalParameter ( "DecoderQueueSize", "The maximum number of events decoded ahead by the decoder threads", _decoderQueueSize, 64 );
+
 }
 
 AlibavaConverter * AlibavaConverter::newProcessor ( )
@@ -86,6 +101,12 @@ void AlibavaConverter::init ( )
 {
     checkIfChipSelectionIsValid ( );
 
+    if ( _nDecoderThreads < 0 || _decoderQueueSize < 1 )
+    {
+	streamlog_out ( ERROR5 ) << "NumberOfDecoderThreads must not be negative and DecoderQueueSize must be positive!" << endl;
+	exit ( -1 );
+    }
+
     if ( _startEventNum != -1 && _stopEventNum == -1 )
     {
 	streamlog_out ( WARNING5 ) << "First " << _startEventNum << " will be skipped!" << endl;
@@ -115,67 +136,71 @@ void AlibavaConverter::readDataSource ( int /* numEvents */ )
     streamlog_out ( MESSAGE5 ) << "Reading " << _fileName << " with AlibavaConverter " << endl;
     _runNumber = atoi ( _formattedRunNumber.c_str ( ) );
 
-    //  Open File
-    ifstream infile;
-    infile.open ( _fileName.c_str ( ) );
-    if ( !infile.is_open ( ) )
+    //  Open File, the whole file is mapped into memory and decoded in place
+    std::unique_ptr < EUTelMappedFile > infile;
+    try
     {
-	streamlog_out ( ERROR5 ) << "AlibavaConverter could not read the file " << _fileName << " correctly. Please check the path and file names that have been input" << endl;
-	exit ( -1 );
+	infile.reset ( new EUTelMappedFile ( _fileName ) );
     }
-    else
+    catch ( lcio::IOException & e )
     {
-	streamlog_out ( MESSAGE4 ) << "Input file " << _fileName << " is opened!" << endl;
+	streamlog_out ( ERROR5 ) << "AlibavaConverter could not read the file " << _fileName << " correctly. Please check the path and file names that have been input" << endl;
+	exit ( -1 );
     }
+    streamlog_out ( MESSAGE4 ) << "Input file " << _fileName << " is opened!" << endl;
+    EUTelMappedFile::Cursor input = infile -> getCursor ( );
 
     time_t date;
     int type;
     unsigned int lheader; // length of the header
     string header;
-    int version; // Alibava firmware version
 
     // Read Header
-    infile.read ( reinterpret_cast < char * > ( &date ), sizeof ( time_t ) );
-    infile.read ( reinterpret_cast < char * > ( &type ), sizeof ( int ) );
+    if ( !input.canRead ( sizeof ( time_t ) + sizeof ( int ) + sizeof ( unsigned int ) ) )
+    {
+	streamlog_out ( ERROR5 ) << "The file " << _fileName << " is too short for an Alibava header!" << endl;
+	return;
+    }
+    date = input.read < time_t > ( );
+    type = input.read < int > ( );
+    lheader = input.read < unsigned int > ( ); //length of header
 
-    header.clear ( );
-    infile.read ( reinterpret_cast < char * > ( &lheader ), sizeof ( unsigned int ) ); //length of header
-    for ( unsigned int ic = 0; ic < lheader; ic++ )
+    // the header pedestal and noise follow the header
+    const int nHeaderChannels = ALIBAVA::NOOFCHIPS * ALIBAVA::NOOFCHANNELS;
+    if ( !input.canRead ( lheader + 2 * nHeaderChannels * sizeof ( double ) ) )
     {
-	char tmp_c;
-	infile.read ( &tmp_c, sizeof ( char ) );
-	header.append ( 1, tmp_c );
+	streamlog_out ( ERROR5 ) << "The file " << _fileName << " is too short for an Alibava header!" << endl;
+	return;
     }
+    header.assign ( input.position ( ), lheader );
+    input.skip ( lheader );
 
     header = trim_str ( header );
 
     if ( header[0] != 'V' && header[0] != 'v' )
     {
-	version = 0;
+	_headerVersion = 0;
     }
     else
     {
-	version =  header[1] - '0' ;
+	_headerVersion =  header[1] - '0' ;
 	header = header.substr ( 5 );
     }
 
     // Read header pedestal and noise
     // Alibava stores a pedestal and noise set in the run header. These values are not used in te rest of the analysis, so it is optional to store it. By default it will not be stored, but it you want you can set _storeHeaderPedestalNoise variable to true.
-    float tmp_float;
     FloatVec headerPedestal;
     FloatVec headerNoise;
 
     // first pedestal
-    for ( int ichan = 0; ichan < ALIBAVA::NOOFCHIPS * ALIBAVA::NOOFCHANNELS; ichan++ )
+    for ( int ichan = 0; ichan < nHeaderChannels; ichan++ )
     {
-	infile.read ( reinterpret_cast < char * > ( &tmp_float ), sizeof ( double ) );
-	headerPedestal.push_back ( tmp_float );
+	headerPedestal.push_back ( input.read < double > ( ) );
     }
     // now noise
-    for ( int ichan = 0; ichan < ALIBAVA::NOOFCHIPS * ALIBAVA::NOOFCHANNELS; ichan++ )
+    for ( int ichan = 0; ichan < nHeaderChannels; ichan++ )
     {
-	infile.read ( reinterpret_cast < char * > ( &tmp_float ), sizeof ( double ) );
-	headerNoise.push_back ( tmp_float );
+	headerNoise.push_back ( input.read < double > ( ) );
     }
 
     // Process Header
@@ -185,7 +210,7 @@ void AlibavaConverter::readDataSource ( int /* numEvents */ )
     // this can lead to multiple gear files not working
     // runHeader -> setDetectorName ( Global::GEAR -> getDetectorName ( ) );
     runHeader -> setHeader ( header );
-    runHeader -> setHeaderVersion ( version );
+    runHeader -> setHeaderVersion ( _headerVersion );
     runHeader -> setDataType ( type );
     runHeader -> setDateTime ( string ( ctime ( &date ) ) );
     if ( _storeHeaderPedestalNoise )
@@ -209,185 +234,248 @@ void AlibavaConverter::readDataSource ( int /* numEvents */ )
     delete runHeader;
 
     // Read Event
-    if ( version < 2 )
+    if ( _headerVersion < 2 )
     {
 	// this code is not written for version<=1.
-	streamlog_out ( ERROR5 ) << "Unexpected data version found (version = " << version << " < 2). Data is not saved!" << endl;
+	streamlog_out ( ERROR5 ) << "Unexpected data version found (version = " << _headerVersion << " < 2). Data is not saved!" << endl;
 	return;
     }
 
-    do
+    // with decoder threads the events are decoded ahead, without logging
+    _userEventTypeCode = 0;
+    std::unique_ptr < EUTelDecoderPipeline > pipeline;
+    if ( _nDecoderThreads > 0 )
     {
-	if ( eventCounter % 1000 == 0 )
+	int lastEvent = _stopEventNum != -1 ? _stopEventNum + 1 : -1;
+	int splitCounter = 0;
+	pipeline.reset ( new EUTelDecoderPipeline ( _nDecoderThreads, _decoderQueueSize,
+	    [ &, lastEvent, splitCounter ] ( EUTelMappedFile::Cursor & event ) mutable
+	    {
+		// no need to decode beyond the event reaching StopEventNum
+		if ( lastEvent != -1 && splitCounter > lastEvent )
+		{
+		    return false;
+		}
+		splitCounter++;
+		return splitEvent ( input, event );
+	    },
+	    [ this ] ( EUTelMappedFile::Cursor event, size_t eventIndex ) -> LCEventImpl *
+	    {
+		return decodeEvent ( event, static_cast < int > ( eventIndex ), false );
+	    } ) );
+    }
+
+    while ( true )
+    {
+	std::unique_ptr < LCEventImpl > anEvent;
+	if ( pipeline )
 	{
-	    streamlog_out ( MESSAGE4 ) << "Processing event " << eventCounter << " in run " << _runNumber << endl;
+	    anEvent = pipeline -> next ( );
 	}
-
-	unsigned int headerCode, eventSize, userEventTypeCode = 0, eventTypeCode = 0;
-	do
+	else
 	{
-	    infile.read ( reinterpret_cast < char * > ( &headerCode ), sizeof ( unsigned int ) );
-	    if ( infile.bad ( ) || infile.eof ( ) )
+	    EUTelMappedFile::Cursor event ( nullptr, nullptr );
+	    if ( splitEvent ( input, event ) )
 	    {
-		return;
+		anEvent.reset ( decodeEvent ( event, eventCounter, true ) );
 	    }
-	    eventTypeCode = ( headerCode >> 16 ) & 0xFFFF;
 	}
-	while ( eventTypeCode != 0xcafe );
+	if ( !anEvent )
+	{
+	    break;
+	}
 
-	eventTypeCode = headerCode & 0x0fff;
-	userEventTypeCode = headerCode & 0x1000;
+	if ( eventCounter % 1000 == 0 )
+	{
+	    streamlog_out ( MESSAGE4 ) << "Processing event " << eventCounter << " in run " << _runNumber << endl;
+	}
 
-	if ( userEventTypeCode )
+	if ( _startEventNum != -1 && eventCounter < _startEventNum )
 	{
-	    streamlog_out ( ERROR5 ) << "Unexpected data type found (type = " << userEventTypeCode << "). Data is not saved!" << endl;
-	    return;
+	    streamlog_out ( MESSAGE5 ) << "Skipping event " << eventCounter << ". StartEventNum is set to " << _startEventNum << endl;
+	    eventCounter++;
+	    continue;
 	}
 
-	infile.read ( reinterpret_cast < char * > ( &eventSize ), sizeof ( unsigned int ) );
+	if ( _stopEventNum!=-1 && eventCounter > _stopEventNum )
+	{
+	    streamlog_out ( MESSAGE5 ) << "Reached StopEventNum: " << _stopEventNum << ". Last saved event number is " << eventCounter << endl;
+	    break;
+	}
 
-	double value, charge, delay;
-	infile.read ( reinterpret_cast < char * > ( &value ), sizeof ( double ) );
+	ProcessorMgr::instance ( ) -> processEvent ( anEvent.get ( ) ) ;
+	eventCounter++;
+    }
+    pipeline.reset ( );
 
-	//see AlibavaGUI.cc
-	charge = int ( value ) & 0xff;
-	delay = int ( value ) >> 16;
-	charge = charge * 1024;
+    if ( _userEventTypeCode )
+    {
+	streamlog_out ( ERROR5 ) << "Unexpected data type found (type = " << _userEventTypeCode << "). Data is not saved!" << endl;
+	return;
+    }
 
-	// timestamp
-	unsigned int clock;
-	unsigned int tdcTime;
-	// temperature measured on Daughter board
-	unsigned short temp;
+    if ( _stopEventNum != -1 && eventCounter < _stopEventNum )
+    {
+	streamlog_out ( MESSAGE5 ) << "Stooped before reaching StopEventNum: " << _stopEventNum << ". The file has " << eventCounter << " events." << endl;
+    }
+}
 
-	// firmware v3 introduces the clock to the header
-	if ( version == 3 )
+bool AlibavaConverter::splitEvent ( EUTelMappedFile::Cursor & input, EUTelMappedFile::Cursor & event )
+{
+    // skip to the next header code
+    unsigned int headerCode = 0;
+    do
+    {
+	if ( !input.canRead ( sizeof ( unsigned int ) ) )
 	{
-	    infile.read ( reinterpret_cast < char * > ( &clock ), sizeof ( unsigned int ) );
+	    return false;
 	}
+	headerCode = input.read < unsigned int > ( );
+    }
+    while ( ( ( headerCode >> 16 ) & 0xFFFF ) != 0xcafe );
 
-	infile.read ( reinterpret_cast < char * > ( &tdcTime ), sizeof ( unsigned int ) );
-	infile.read ( reinterpret_cast < char * > ( &temp ), sizeof ( unsigned short ) );
+    if ( headerCode & 0x1000 )
+    {
+	_userEventTypeCode = headerCode & 0x1000;
+	return false;
+    }
 
-	unsigned short chipHeader[2][ALIBAVA::CHIPHEADERLENGTH];
-	short tmp_short;
+    // event size, value, the clock for firmware v3, tdc time, temperature and the chips
+    size_t size = sizeof ( unsigned int ) + sizeof ( double ) + ( _headerVersion == 3 ? sizeof ( unsigned int ) : 0 ) + sizeof ( unsigned int ) + sizeof ( unsigned short );
+    size += ALIBAVA::NOOFCHIPS * ( ALIBAVA::CHIPHEADERLENGTH + ALIBAVA::NOOFCHANNELS ) * sizeof ( unsigned short );
 
-	// vector for data
-	FloatVec all_data;
-	all_data.reserve ( ALIBAVA::NOOFCHIPS * ALIBAVA::NOOFCHANNELS );
+    // a truncated event at the end of the file is not converted
+    if ( !input.canRead ( size ) )
+    {
+	return false;
+    }
+    const char * begin = input.position ( ) - sizeof ( unsigned int );
+    input.skip ( size );
+    event = EUTelMappedFile::Cursor ( begin, input.position ( ) );
+    return true;
+}
 
-	// vector for chip header
-	FloatVec all_chipheaders;
-	all_chipheaders.reserve ( ALIBAVA::NOOFCHIPS * ALIBAVA::CHIPHEADERLENGTH );
+AlibavaEventImpl * AlibavaConverter::decodeEvent ( EUTelMappedFile::Cursor event, int eventNumber, bool log )
+{
+    unsigned int headerCode = event.read < unsigned int > ( );
+    unsigned int eventTypeCode = headerCode & 0x0fff;
+    unsigned int eventSize = event.read < unsigned int > ( );
+
+    double value, charge, delay;
+    value = event.read < double > ( );
+
+    //see AlibavaGUI.cc
+    charge = int ( value ) & 0xff;
+    delay = int ( value ) >> 16;
+    charge = charge * 1024;
+
+    // timestamp
+    unsigned int clock = 0;
+    unsigned int tdcTime;
+    // temperature measured on Daughter board
+    unsigned short temp;
+
+    // firmware v3 introduces the clock to the header
+    if ( _headerVersion == 3 )
+    {
+	clock = event.read < unsigned int > ( );
+    }
 
-	// iterate over number of chips
-	FloatVec::iterator it;
-	for ( int ichip = 0; ichip < ALIBAVA::NOOFCHIPS; ichip++ )
-	{
-	    infile.read ( reinterpret_cast < char * > ( chipHeader[ichip] ), ALIBAVA::CHIPHEADERLENGTH * sizeof ( unsigned short ) );
+    tdcTime = event.read < unsigned int > ( );
+    temp = event.read < unsigned short > ( );
 
-	    // store chip header in all_chipheaders vector
+    unsigned short chipHeader[ALIBAVA::NOOFCHIPS][ALIBAVA::CHIPHEADERLENGTH];
+
+    // vector for data
+    FloatVec all_data;
+    all_data.reserve ( ALIBAVA::NOOFCHIPS * ALIBAVA::NOOFCHANNELS );
+
+    // vector for chip header
+    FloatVec all_chipheaders;
+    all_chipheaders.reserve ( ALIBAVA::NOOFCHIPS * ALIBAVA::CHIPHEADERLENGTH );
+
+    // iterate over number of chips
+    for ( int ichip = 0; ichip < ALIBAVA::NOOFCHIPS; ichip++ )
+    {
+	event.read ( chipHeader[ichip], ALIBAVA::CHIPHEADERLENGTH );
+
+	// store chip header in all_chipheaders vector
+	if ( log )
+	{
 	    streamlog_out ( DEBUG0 ) << "Chip " << ichip << " Header: " ;
 	    for ( int j = 0; j < ALIBAVA::CHIPHEADERLENGTH; j++ )
 	    {
 		streamlog_out ( DEBUG0 ) << " " << chipHeader[ichip][j];
-		all_chipheaders.push_back ( float ( chipHeader[ichip][j] ) );
 	    }
 	    streamlog_out ( DEBUG0 ) << endl;
-
-	    // store data in all_data vector
-	    for ( int ichan = 0; ichan < ALIBAVA::NOOFCHANNELS; ichan++ )
-	    {
-		infile.read ( reinterpret_cast < char * > ( &tmp_short ), sizeof ( unsigned short ) );
-		all_data.push_back ( float ( tmp_short ) );
-	    }
 	}
+	all_chipheaders.insert ( all_chipheaders.end ( ), chipHeader[ichip], chipHeader[ichip] + ALIBAVA::CHIPHEADERLENGTH );
 
-	// Process Event
-	// now write these to AlibavaEvent
-	AlibavaEventImpl* anEvent = new AlibavaEventImpl ( );
-	anEvent -> setRunNumber ( _runNumber );
-	anEvent -> setEventNumber ( eventCounter );
-	anEvent -> setEventType ( eventTypeCode );
-	anEvent -> setEventSize ( eventSize );
-	anEvent -> setEventValue ( value );
-
-	if ( version == 3 )
-	{
-	    anEvent -> setEventClock ( clock );
-	}
-	anEvent -> setEventTime ( tdc_time ( tdcTime ) );
-	anEvent -> setEventTemp ( get_temperature ( temp ) );
-	anEvent -> setCalCharge ( charge );
-	anEvent -> setCalDelay ( delay );
-	anEvent -> unmaskEvent ( );
-
-	// creating LCCollection for raw data
-	LCCollectionVec* rawDataCollection = new LCCollectionVec ( LCIO::TRACKERDATA );
-	CellIDEncoder < TrackerDataImpl > chipIDEncoder ( ALIBAVA::ALIBAVADATA_ENCODE, rawDataCollection );
- 
-	// creating LCCollection for raw chip header
-	LCCollectionVec* rawChipHeaderCollection = new LCCollectionVec ( LCIO::TRACKERDATA );
-	CellIDEncoder < TrackerDataImpl > chipIDEncoder2 ( ALIBAVA::ALIBAVADATA_ENCODE, rawChipHeaderCollection );
-
-	// for this to work the _chipselection has to be sorted in ascending order
-	for ( unsigned int ichip = 0; ichip < _chipSelection.size ( ); ichip++ )
-	{
-	    // store raw data
-	    FloatVec chipdata;
-	    chipdata.clear ( );
-
-	    // separate data for each chip
-	    chipdata.insert ( chipdata.end ( ), all_data.begin ( ) + _chipSelection[ichip] * ALIBAVA::NOOFCHANNELS, all_data.begin ( ) + ( _chipSelection[ichip] + 1 ) * ALIBAVA::NOOFCHANNELS );
-	    TrackerDataImpl * arawdata = new TrackerDataImpl ( );
-	    arawdata -> setChargeValues ( chipdata );
-	    chipIDEncoder[ALIBAVA::ALIBAVADATA_ENCODE_CHIPNUM] = _chipSelection[ichip];
-	    chipIDEncoder.setCellID ( arawdata );
-	    rawDataCollection -> push_back ( arawdata );
-
-	    // store chip header
-	    FloatVec chipHeader_vec;
-	    chipHeader_vec.clear ( );
-
-	    //separate chip headers for each chip
-	    chipHeader_vec.insert ( chipHeader_vec.end ( ), all_chipheaders.begin ( ) + _chipSelection[ichip] * ALIBAVA::CHIPHEADERLENGTH, all_chipheaders.begin ( ) + ( _chipSelection[ichip] + 1 ) * ALIBAVA::CHIPHEADERLENGTH );
-	    TrackerDataImpl * achipheader = new TrackerDataImpl ( );
-	    achipheader -> setChargeValues ( chipHeader_vec );
-	    chipIDEncoder2[ALIBAVA::ALIBAVADATA_ENCODE_CHIPNUM] = _chipSelection[ichip];
-	    chipIDEncoder2.setCellID ( achipheader );
-	    rawChipHeaderCollection -> push_back ( achipheader );
-	}
-
-	anEvent -> addCollection ( rawDataCollection, _rawDataCollectionName );
-	anEvent -> addCollection ( rawChipHeaderCollection, _rawChipHeaderCollectionName );
-
-	if ( _startEventNum != -1 && eventCounter < _startEventNum )
-	{
-	    streamlog_out ( MESSAGE5 ) << "Skipping event " << eventCounter << ". StartEventNum is set to " << _startEventNum << endl;
-	    eventCounter++;
-	    continue;
-	}
-
-	if ( _stopEventNum!=-1 && eventCounter > _stopEventNum )
-	{
-	    streamlog_out ( MESSAGE5 ) << "Reached StopEventNum: " << _stopEventNum << ". Last saved event number is " << eventCounter << endl;
-	    break;
-	}
-
-	ProcessorMgr::instance ( ) -> processEvent ( static_cast < LCEventImpl* > ( anEvent ) ) ;
-	eventCounter++;
-
-	delete anEvent;
-
+	// store data in all_data vector
+	short chipData[ALIBAVA::NOOFCHANNELS];
+	event.read ( chipData, ALIBAVA::NOOFCHANNELS );
+	all_data.insert ( all_data.end ( ), chipData, chipData + ALIBAVA::NOOFCHANNELS );
     }
-    while ( !( infile.bad ( ) || infile.eof ( ) ) );
 
-    infile.close ( );
+    // Process Event
+    // now write these to AlibavaEvent
+    AlibavaEventImpl* anEvent = new AlibavaEventImpl ( );
+    anEvent -> setRunNumber ( _runNumber );
+    anEvent -> setEventNumber ( eventNumber );
+    anEvent -> setEventType ( eventTypeCode );
+    anEvent -> setEventSize ( eventSize );
+    anEvent -> setEventValue ( value );
 
-    if ( _stopEventNum != -1 && eventCounter < _stopEventNum )
+    if ( _headerVersion == 3 )
     {
-	streamlog_out ( MESSAGE5 ) << "Stooped before reaching StopEventNum: " << _stopEventNum << ". The file has " << eventCounter << " events." << endl;
+	anEvent -> setEventClock ( clock );
+    }
+    anEvent -> setEventTime ( tdc_time ( tdcTime ) );
+    anEvent -> setEventTemp ( get_temperature ( temp ) );
+    anEvent -> setCalCharge ( charge );
+    anEvent -> setCalDelay ( delay );
+    anEvent -> unmaskEvent ( );
+
+    // creating LCCollection for raw data
+    LCCollectionVec* rawDataCollection = new LCCollectionVec ( LCIO::TRACKERDATA );
+    CellIDEncoder < TrackerDataImpl > chipIDEncoder ( ALIBAVA::ALIBAVADATA_ENCODE, rawDataCollection );
+
+    // creating LCCollection for raw chip header
+    LCCollectionVec* rawChipHeaderCollection = new LCCollectionVec ( LCIO::TRACKERDATA );
+    CellIDEncoder < TrackerDataImpl > chipIDEncoder2 ( ALIBAVA::ALIBAVADATA_ENCODE, rawChipHeaderCollection );
+
+    // for this to work the _chipselection has to be sorted in ascending order
+    for ( unsigned int ichip = 0; ichip < _chipSelection.size ( ); ichip++ )
+    {
+	// store raw data
+	FloatVec chipdata;
+	chipdata.clear ( );
+
+	// separate data for each chip
+	chipdata.insert ( chipdata.end ( ), all_data.begin ( ) + _chipSelection[ichip] * ALIBAVA::NOOFCHANNELS, all_data.begin ( ) + ( _chipSelection[ichip] + 1 ) * ALIBAVA::NOOFCHANNELS );
+	TrackerDataImpl * arawdata = new TrackerDataImpl ( );
+	arawdata -> setChargeValues ( chipdata );
+	chipIDEncoder[ALIBAVA::ALIBAVADATA_ENCODE_CHIPNUM] = _chipSelection[ichip];
+	chipIDEncoder.setCellID ( arawdata );
+	rawDataCollection -> push_back ( arawdata );
+
+	// store chip header
+	FloatVec chipHeader_vec;
+	chipHeader_vec.clear ( );
+
+	//separate chip headers for each chip
+	chipHeader_vec.insert ( chipHeader_vec.end ( ), all_chipheaders.begin ( ) + _chipSelection[ichip] * ALIBAVA::CHIPHEADERLENGTH, all_chipheaders.begin ( ) + ( _chipSelection[ichip] + 1 ) * ALIBAVA::CHIPHEADERLENGTH );
+	TrackerDataImpl * achipheader = new TrackerDataImpl ( );
+	achipheader -> setChargeValues ( chipHeader_vec );
+	chipIDEncoder2[ALIBAVA::ALIBAVADATA_ENCODE_CHIPNUM] = _chipSelection[ichip];
+	chipIDEncoder2.setCellID ( achipheader );
+	rawChipHeaderCollection -> push_back ( achipheader );
     }
+
+    anEvent -> addCollection ( rawDataCollection, _rawDataCollectionName );
+    anEvent -> addCollection ( rawChipHeaderCollection, _rawChipHeaderCollectionName );
+
+    return anEvent;
 }
 
 void AlibavaConverter::end ( )
@@ -0,0 +1,248 @@
+/*
+ *   This source code is part of the Eutelescope package of Marlin.
+ *   You are free to use this source files for your own development as
+ *   long as it stays in a public research context. You are not
+ *   allowed to use it for commercial purpose. You must put this
+ *   header with author names in all development based on this file.
+ *
+ */
+
+// eutelescope includes ".h"
+#include "EUTELESCOPE.h"
+
+// alibava includes ".h"
+#include "AlibavaFusedReconstruction.h"
+#include "AlibavaChipCorrection.h"
+#include "AlibavaRunHeaderImpl.h"
+#include "AlibavaEventImpl.h"
+#include "ALIBAVA.h"
+#include "AlibavaPedNoiCalIOManager.h"
+
+// marlin includes ".h"
+#include "marlin/Processor.h"
+#include "marlin/Exceptions.h"
+#include "marlin/Global.h"
+
+// lcio includes <.h>
+#include <lcio.h>
+#include <UTIL/CellIDEncoder.h>
+#include <IMPL/LCCollectionVec.h>
+#include <IMPL/TrackerDataImpl.h>
+#include <IMPL/TrackerPulseImpl.h>
+
+// system includes <>
+#include <string>
+#include <iostream>
+#include <stdlib.h>
+#include <memory>
+
+using namespace std;
+using namespace lcio;
+using namespace marlin;
+using namespace alibava;
+
+AlibavaFusedReconstruction::AlibavaFusedReconstruction ( ) : AlibavaClustering ( "AlibavaFusedReconstruction" ),
+_chipBuffer ( ),
+_pedestalInputFile ( ALIBAVA::NOTSET ),
+_pedestalInputCollectionName ( ALIBAVA::NOTSET ),
+_Niteration ( 3 ),
+_NoiseDeviation ( 2.5 ),
+_commonmodeMethod ( "slope" ),
+_slopeCommonMode ( true )
+{
+    // modify processor description
+    _description = "AlibavaFusedReconstruction subtracts pedestal and common mode from the raw data and clusters it, without writing the intermediate collections. The InputCollectionName has to be the raw data collection.";
+
+    // the pedestal, the noise for the clustering is read as in AlibavaClustering
+    registerProcessorParameter ( "PedestalInputFile", "The filename where the pedestal values are stored", _pedestalInputFile, string ( "pedestal.slcio" ) );
+
+    registerProcessorParameter ( "PedestalCollectionName", "Pedestal collection name, better not to change", _pedestalInputCollectionName, string ( "pedestal" ) );
+
+    // the common mode parameters
+    registerOptionalParameter ( "CommonModeErrorCalculationIteration", "The number of iterations that should be used in common mode calculation", _Niteration, 3 );
+
+    registerOptionalParameter ( "NoiseDeviation", "The limit to the deviation of noise. The data that exceeds this deviation will be considered as signal and not be included in common mode error calculation", _NoiseDeviation, 2.5f );
+
+    registerOptionalParameter ( "Method", "The method with which to calculate the common mode. Options are: constant or slope", _commonmodeMethod, string ( "slope" ) );
+}
+
+void AlibavaFusedReconstruction::init ( )
+{
+    // the global parameters and the FIR coefficients
+    AlibavaClustering::init ( );
+
+    if ( _commonmodeMethod == "constant" )
+    {
+	_slopeCommonMode = false;
+    }
+    else if ( _commonmodeMethod == "slope" )
+    {
+	_slopeCommonMode = true;
+    }
+    else
+    {
+	streamlog_out ( ERROR5 ) << "Unknown common mode method " << _commonmodeMethod << " ! Options are: constant or slope" << endl;
+	exit ( -1 );
+    }
+}
+
+void AlibavaFusedReconstruction::processRunHeader ( LCRunHeader * rdr )
+{
+    streamlog_out ( MESSAGE4 ) << "Running processRunHeader" << endl;
+
+    auto arunHeader = std::make_unique < AlibavaRunHeaderImpl > ( rdr );
+    arunHeader -> addProcessor ( type ( ) );
+
+    setChipSelection ( arunHeader -> getChipSelection ( ) );
+
+    setChannelsToBeUsed ( );
+
+    // the noise for the clustering
+    setPedestals ( );
+
+    // the pedestal and masking for the raw data
+    setChipBuffers ( );
+
+    bookHistos ( );
+
+    // set number of skipped events to zero (defined in AlibavaBaseProcessor)
+    _numberOfSkippedEvents = 0;
+}
+
+void AlibavaFusedReconstruction::setChipBuffers ( )
+{
+    AlibavaPedNoiCalIOManager man;
+
+    _chipBuffer.assign ( ALIBAVA::NOOFCHIPS, ChipBuffer ( ) );
+
+    EVENT::IntVec selectedchips = getChipSelection ( );
+    for ( unsigned int ichip = 0; ichip < selectedchips.size ( ); ichip++ )
+    {
+	int chipnum = selectedchips[ichip];
+	if ( chipnum < 0 || chipnum >= ALIBAVA::NOOFCHIPS )
+	{
+	    streamlog_out ( ERROR5 ) << "Selected chip " << chipnum << " does not exist!" << endl;
+	    exit ( -1 );
+	}
+
+	EVENT::FloatVec pedVec = man.getPedNoiCalForChip ( _pedestalInputFile, _pedestalInputCollectionName, chipnum );
+	if ( int ( pedVec.size ( ) ) != ALIBAVA::NOOFCHANNELS )
+	{
+	    streamlog_out ( ERROR5 ) << "The pedestal values for chip " << chipnum << " could not be read from " << _pedestalInputFile << " !" << endl;
+	    exit ( -1 );
+	}
+
+	ChipBuffer & buffer = _chipBuffer[chipnum];
+	for ( int ichan = 0; ichan < ALIBAVA::NOOFCHANNELS; ichan++ )
+	{
+	    buffer.pedestal[ichan] = pedVec[ichan];
+	    buffer.masked[ichan] = isMasked ( chipnum, ichan );
+	}
+	buffer.signal.assign ( ALIBAVA::NOOFCHANNELS, 0 );
+    }
+}
+
+void AlibavaFusedReconstruction::processEvent ( LCEvent * anEvent )
+{
+    if ( anEvent -> getEventNumber ( ) % 1000 == 0 )
+    {
+	streamlog_out ( MESSAGE4 ) << "Looping events " << anEvent -> getEventNumber ( ) << endl;
+    }
+
+    AlibavaEventImpl * alibavaEvent = static_cast < AlibavaEventImpl* > ( anEvent );
+
+    // the raw data we read
+    LCCollectionVec * inputCollectionVec;
+    try
+    {
+	inputCollectionVec = dynamic_cast < LCCollectionVec * > ( alibavaEvent -> getCollection ( getInputCollectionName ( ) ) );
+    }
+    catch ( lcio::DataNotAvailableException& )
+    {
+	streamlog_out ( ERROR5 ) << "Collection (" << getInputCollectionName ( ) << ") not found in event " << anEvent -> getEventNumber ( ) << " ! " << endl;
+	return;
+    }
+
+    // the collections we output, as in AlibavaClustering
+    LCCollectionVec * clusterCollection;
+    try
+    {
+	clusterCollection = dynamic_cast < LCCollectionVec * > ( alibavaEvent -> getCollection ( _clusterCollectionName ) );
+	streamlog_out ( DEBUG5 ) << "clusterCollection exists..." <<  endl;
+    }
+    catch ( lcio::DataNotAvailableException& )
+    {
+	clusterCollection = new LCCollectionVec ( LCIO::TRACKERPULSE );
+	streamlog_out ( DEBUG5 ) << "clusterCollection doesn't exist..." <<  endl;
+    }
+    LCCollectionVec * sparseClusterCollectionVec = new LCCollectionVec ( LCIO::TRACKERDATA );
+
+    filteredcollectionVec = nullptr;
+    if ( _usefir == true )
+    {
+	filteredcollectionVec = new LCCollectionVec ( LCIO::TRACKERDATA );
+    }
+
+    // Masked events still get their (empty) output collections, so the following processors stay in sync
+    if ( _skipMaskedEvents && ( alibavaEvent -> isEventMasked ( ) ) )
+    {
+	_numberOfSkippedEvents++;
+	CellIDEncoder < TrackerPulseImpl > pulseEncoder ( eutelescope::EUTELESCOPE::PULSEDEFAULTENCODING, clusterCollection );
+	CellIDEncoder < TrackerDataImpl > dataEncoder ( eutelescope::EUTELESCOPE::ZSCLUSTERDEFAULTENCODING, sparseClusterCollectionVec );
+    }
+    else
+    {
+	int noOfChip = inputCollectionVec -> getNumberOfElements ( );
+	for ( int i = 0; i < noOfChip; ++i )
+	{
+	    TrackerDataImpl * trkdata = dynamic_cast < TrackerDataImpl * > ( inputCollectionVec -> getElementAt ( i ) );
+	    int chipnum = getChipNum ( trkdata );
+
+	    // read in place, no copy of the raw data
+	    const EVENT::FloatVec & rawdata = trkdata -> getChargeValues ( );
+
+	    if ( isChipValid ( chipnum ) == false )
+	    {
+		streamlog_out ( ERROR5 ) << "Chip " << chipnum << " is not selected, skipping it in event " << anEvent -> getEventNumber ( ) << " !" << endl;
+		continue;
+	    }
+	    if ( int ( rawdata.size ( ) ) != ALIBAVA::NOOFCHANNELS )
+	    {
+		streamlog_out ( ERROR5 ) << "Number of channels in input data is not equal to ALIBAVA::NOOFCHANNELS! Skipping chip " << chipnum << " in event " << anEvent -> getEventNumber ( ) << " !" << endl;
+		continue;
+	    }
+
+	    ChipBuffer & buffer = _chipBuffer[chipnum];
+	    correctRawData ( buffer, rawdata );
+
+	    streamlog_out ( DEBUG4 ) << "Calling clustering function in event: " << anEvent -> getEventNumber ( ) << " !" << endl;
+	    findSeedClusters ( chipnum, buffer.signal, clusterCollection, sparseClusterCollectionVec, alibavaEvent );
+	}
+    }
+
+    alibavaEvent -> addCollection ( sparseClusterCollectionVec, _sparseclusterCollectionName );
+    alibavaEvent -> addCollection ( clusterCollection, getClusterCollectionName ( ) );
+
+    if ( _usefir == true )
+    {
+	alibavaEvent -> addCollection ( filteredcollectionVec, _filteredCollectionName );
+    }
+}
+
+void AlibavaFusedReconstruction::correctRawData ( ChipBuffer & buffer, const EVENT::FloatVec & rawdata )
+{
+    ChipCommonMode cm = correctChipData ( ALIBAVA::NOOFCHANNELS, rawdata.data ( ), buffer.pedestal, buffer.masked, _Niteration, _NoiseDeviation, _slopeCommonMode, buffer.signal.data ( ) );
+
+    streamlog_out ( DEBUG0 ) << "CommonModeCorrection = " << cm.mean << ", CommonModeCorrectionError = " << cm.sigma << ", slope a = " << cm.a << " , b = " << cm.b << endl;
+}
+
+void AlibavaFusedReconstruction::end ( )
+{
+    if ( _numberOfSkippedEvents > 0 )
+    {
+	streamlog_out ( MESSAGE5 ) << _numberOfSkippedEvents << " events skipped since they are masked" << endl;
+    }
+
+    // the fits and coefficients of the clustering
+    AlibavaClustering::end ( );
+}
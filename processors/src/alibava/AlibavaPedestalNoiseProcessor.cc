@@ -46,6 +46,9 @@
 #include <iostream>
 #include <sstream>
 #include <memory>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 using namespace std;
 using namespace lcio;
@@ -57,7 +60,13 @@ _pedestalHistoName ( "hpedestal" ),
 _noiseHistoName ( "hnoise" ),
 _temperatureHistoName ( "htemperature" ),
 _chanDataHistoName ( "Data_chan" ),
-_chanDataFitName ( "Fit_chan" )
+_chanDataFitName ( "Fit_chan" ),
+_estimationMethod ( "fit" ),
+_clippingCut ( 0.0 ),
+_clippingWarmUp ( 100 ),
+_onlineEstimation ( false ),
+_onlineEstimate ( ),
+_onlineNoOfEvents ( 0 )
 {
 
     // modify processor description
@@ -73,6 +82,12 @@ _chanDataFitName ( "Fit_chan" )
 
     registerOptionalParameter ( "NoiseCollectionName", "Noise collection name, better not to change", _noiseCollectionName, string ( "noise" ) );
 
+    registerOptionalParameter ( "EstimationMethod", "The method with which to estimate pedestal and noise. Options are: fit (gaussian fit to a histogram of each channel) or online (running mean and standard deviation of each channel, no histograms are filled)", _estimationMethod, string ( "fit" ) );
+
+    registerOptionalParameter ( "ClippingCut", "Only for the online method: samples deviating from the running pedestal by more than this many times the running noise are not used, e.g. to exclude signals. The noise is corrected for the clipped tails of a gaussian distribution. Set to 0 to disable the clipping", _clippingCut, float ( 0.0 ) );
+
+    registerOptionalParameter ( "ClippingWarmUp", "Only for the online method with clipping: the first events, this many, are used to seed the clipping and are not included in the result. Afterwards the clipping is updated from the running pedestal and noise every this many events", _clippingWarmUp, 100 );
+
 }
 
 void AlibavaPedestalNoiseProcessor::init ( )
@@ -97,6 +112,27 @@ void AlibavaPedestalNoiseProcessor::init ( )
 	streamlog_out ( MESSAGE4 ) << "The Global Parameter " << ALIBAVA::SKIPMASKEDEVENTS << " is not set! Masked events will be used!" << endl;
     }
 
+    if ( _estimationMethod == "fit" )
+    {
+	_onlineEstimation = false;
+    }
+    else if ( _estimationMethod == "online" )
+    {
+	_onlineEstimation = true;
+    }
+    else
+    {
+	streamlog_out ( ERROR5 ) << "Unknown EstimationMethod " << _estimationMethod << ", options are: fit or online" << endl;
+	exit ( -1 );
+    }
+
+    // the clipping parameters only matter for the online method
+    if ( _onlineEstimation && ( _clippingCut < 0 || ( _clippingCut > 0 && _clippingWarmUp < 2 ) ) )
+    {
+	streamlog_out ( ERROR5 ) << "ClippingCut must not be negative and ClippingWarmUp must be at least 2!" << endl;
+	exit ( -1 );
+    }
+
     printParameters ( );
 
 }
@@ -114,6 +150,10 @@ void AlibavaPedestalNoiseProcessor::processRunHeader ( LCRunHeader * rdr )
     man.createFile ( _pedestalFile, arunHeader -> lcRunHeader ( ) );
 
     bookHistos ( );
+    if ( _onlineEstimation )
+    {
+	resetOnlineEstimate ( );
+    }
 
     // set number of skipped events to zero (defined in AlibavaBaseProcessor)
     _numberOfSkippedEvents = 0;
@@ -145,7 +185,23 @@ void AlibavaPedestalNoiseProcessor::processEvent ( LCEvent * anEvent )
 	for ( size_t i = 0; i < noOfDetector; ++i )
 	{
 	    TrackerDataImpl * trkdata = dynamic_cast < TrackerDataImpl * > ( collectionVec -> getElementAt ( i ) ) ;
-	    fillHistos ( trkdata );
+	    if ( _onlineEstimation )
+	    {
+		updateOnlineEstimate ( trkdata );
+	    }
+	    else
+	    {
+		fillHistos ( trkdata );
+	    }
+	}
+
+	if ( _onlineEstimation )
+	{
+	    _onlineNoOfEvents++;
+	    if ( _clippingCut > 0 && _onlineNoOfEvents % _clippingWarmUp == 0 )
+	    {
+		updateClipping ( );
+	    }
 	}
     }
     catch ( lcio::DataNotAvailableException& )
@@ -191,6 +247,14 @@ void AlibavaPedestalNoiseProcessor::calculatePedestalNoise ( )
 		ped=0;
 		noi=0;
 	    }
+	    else if ( _onlineEstimation )
+	    {
+		// the running estimator is already up to date, just copy
+		ped = _onlineEstimate[ichip].mean[ichan];
+		noi = getOnlineNoise ( _onlineEstimate[ichip], ichan );
+		hped -> SetBinContent ( ichan + 1, ped );
+		hnoi -> SetBinContent ( ichan + 1, noi );
+	    }
 	    else
 	    {
 		tempFitName = getChanDataFitName ( ichip, ichan );
@@ -297,6 +361,13 @@ void AlibavaPedestalNoiseProcessor::bookHistos ( )
 	noiseHisto -> SetTitle ( ( sn.str ( ) ) .c_str ( ) );
     }
 
+    // the online estimator needs neither the histograms nor the fits of each channel
+    if ( _onlineEstimation )
+    {
+	streamlog_out ( MESSAGE1 )  << "End of Booking histograms. " << endl;
+	return;
+    }
+
     AIDAProcessor::tree ( this ) -> mkdir ( getInputCollectionName ( ) .c_str ( ) );
     AIDAProcessor::tree ( this ) -> cd ( getInputCollectionName ( ) .c_str ( ) );
 
@@ -329,3 +400,102 @@ void AlibavaPedestalNoiseProcessor::bookHistos ( )
 
     streamlog_out ( MESSAGE1 )  << "End of Booking histograms. " << endl;
 }
+
+void AlibavaPedestalNoiseProcessor::resetOnlineEstimate ( )
+{
+    _onlineEstimate.assign ( ALIBAVA::NOOFCHIPS, OnlineEstimate ( ) );
+    _onlineNoOfEvents = 0;
+
+    EVENT::IntVec chipSelection = getChipSelection ( );
+    for ( unsigned int i = 0; i < chipSelection.size ( ); i++ )
+    {
+	unsigned int ichip = chipSelection[i];
+	OnlineEstimate & estimate = _onlineEstimate[ichip];
+	for ( int ichan = 0; ichan < ALIBAVA::NOOFCHANNELS; ichan++ )
+	{
+	    estimate.weight[ichan] = isMasked ( ichip, ichan ) ? 0.0 : 1.0;
+	    // no clipping until the first update
+	    estimate.clipLimit[ichan] = numeric_limits < float >::infinity ( );
+	}
+    }
+}
+
+void AlibavaPedestalNoiseProcessor::updateOnlineEstimate ( TrackerDataImpl * trkdata )
+{
+    const FloatVec & datavec = trkdata -> getChargeValues ( );
+
+    int chipnum = getChipNum ( trkdata );
+    if ( !isChipValid ( chipnum ) || datavec.size ( ) != size_t ( ALIBAVA::NOOFCHANNELS ) )
+    {
+	streamlog_out ( ERROR5 ) << "Data of chip " << chipnum << " has " << datavec.size ( ) << " channels, expected " << ALIBAVA::NOOFCHANNELS << ". Skipping it!" << endl;
+	return;
+    }
+
+    OnlineEstimate & estimate = _onlineEstimate[chipnum];
+    copy ( datavec.begin ( ), datavec.end ( ), estimate.data );
+
+    // The loops below have a fixed number of iterations, no branches and no
+    // dependencies between the channels, so they can be vectorised. Masked and
+    // clipped samples are added with the weight 0.
+    for ( int ichan = 0; ichan < ALIBAVA::NOOFCHANNELS; ichan++ )
+    {
+	float clipDelta = estimate.data[ichan] - estimate.clipMean[ichan];
+	estimate.accepted[ichan] = clipDelta * clipDelta <= estimate.clipLimit[ichan] ? 1.0 : 0.0;
+    }
+
+    // Welford's update of mean and sum of squared deviations. For w = 1 the
+    // denominator is the new count, for w = 0 it is only there to avoid 0/0
+    for ( int ichan = 0; ichan < ALIBAVA::NOOFCHANNELS; ichan++ )
+    {
+	float w = estimate.weight[ichan] * estimate.accepted[ichan];
+	float delta = estimate.data[ichan] - estimate.mean[ichan];
+	estimate.count[ichan] += w;
+	estimate.mean[ichan] += w * delta / ( estimate.count[ichan] + 1 - w );
+	estimate.m2[ichan] += w * delta * ( estimate.data[ichan] - estimate.mean[ichan] );
+    }
+}
+
+void AlibavaPedestalNoiseProcessor::updateClipping ( )
+{
+    float cut2 = _clippingCut * _clippingCut;
+    // the seeding events were not clipped, thus they are not used further
+    bool seeding = _onlineNoOfEvents == _clippingWarmUp;
+
+    for ( OnlineEstimate & estimate : _onlineEstimate )
+    {
+	for ( int ichan = 0; ichan < ALIBAVA::NOOFCHANNELS; ichan++ )
+	{
+	    estimate.clipMean[ichan] = estimate.mean[ichan];
+	    if ( estimate.count[ichan] > 1 )
+	    {
+		// the noise corrected for the clipped tails, so the cut is at ClippingCut times the true noise
+		float noise = getOnlineNoise ( estimate, ichan );
+		estimate.clipLimit[ichan] = cut2 * noise * noise;
+	    }
+	    if ( seeding )
+	    {
+		estimate.count[ichan] = 0;
+		estimate.mean[ichan] = 0;
+		estimate.m2[ichan] = 0;
+	    }
+	}
+    }
+}
+
+float AlibavaPedestalNoiseProcessor::getOnlineNoise ( const OnlineEstimate & estimate, int ichan )
+{
+    if ( estimate.count[ichan] < 2 )
+    {
+	return 0;
+    }
+    double variance = estimate.m2[ichan] / ( estimate.count[ichan] - 1 );
+
+    // the variance of a gaussian clipped at +-k sigma is smaller by 1 - 2 k phi(k) / erf(k/sqrt(2))
+    if ( _clippingCut > 0 && _onlineNoOfEvents > _clippingWarmUp )
+    {
+	double k = _clippingCut;
+	double phi = exp ( -0.5 * k * k ) / sqrt ( 2 * acos ( -1.0 ) );
+	variance /= 1 - 2 * k * phi / erf ( k / sqrt ( 2.0 ) );
+    }
+    return float ( sqrt ( variance ) );
+}
@@ -20,10 +20,12 @@
 #include <IMPL/LCGenericObjectImpl.h>
 #include <IMPL/LCEventImpl.h>
 #include <UTIL/CellIDEncoder.h>
+#include <Exceptions.h>
 
 // eutelescope includes
 #include "EUTelEventImpl.h"
 #include "EUTelRunHeaderImpl.h"
+#include "EUTelDecoderPipeline.h"
 
 // system includes
 #include <iostream>
@@ -36,13 +38,13 @@
 #include <algorithm>
 #include <stdio.h>
 #include <string.h>
-#include <bitset>
 
 using namespace std;
 using namespace marlin;
 using namespace eutelescope;
 
-Ph2ACF2LCIOConverter::Ph2ACF2LCIOConverter ( ) : DataSourceProcessor ( "Ph2ACF2LCIOConverter" )
+Ph2ACF2LCIOConverter::Ph2ACF2LCIOConverter ( ) : DataSourceProcessor ( "Ph2ACF2LCIOConverter" ),
+_stubSyncErrors ( 0 )
 
 {
     _description = "Reads Ph2ACF data streams and converts to LCIO";
@@ -63,6 +65,10 @@ Ph2ACF2LCIOConverter::Ph2ACF2LCIOConverter ( ) : DataSourceProcessor ( "Ph2ACF2L
 
     registerOutputCollection ( LCIO::TRACKERDATA, "TopRawDataCollectionName", "Name of the collection for the top sensor", _rawDataCollectionNameTop, string ( "rawdata1" ) );
 
+    registerProcessorParameter ( "NumberOfDecoderThreads", "The number of threads decoding events ahead of the processing, 0 decodes each event right before processing it", _nDecoderThreads, 0 );
+
+    registerProcessorParameter ( "DecoderQueueSize", "The maximum number of events decoded ahead by the decoder threads", _decoderQueueSize, 64 );
+
 }
 
 
@@ -76,6 +82,85 @@ void Ph2ACF2LCIOConverter::init ( )
 {
     printParameters ( );
 
+    if ( _nDecoderThreads < 0 || _decoderQueueSize < 1 )
+    {
+	streamlog_out ( ERROR5 ) << "NumberOfDecoderThreads must not be negative and DecoderQueueSize must be positive!" << endl;
+	exit ( -1 );
+    }
+
+    // the names of the event parameters, in the order of the ChipParameter enum
+    const char * chipParameterPrefix[_nChipParameters] = { "l1cnt_", "pipeaddr", "buf_ovf", "lat_err", "stub1_", "stub2_", "stub3_", "bend1_", "bend2_", "bend3_" };
+    _feParameterNames.clear ( );
+    _chipParameterNames.clear ( );
+    for ( int i = 0; i < _nFE; i++ )
+    {
+	_feParameterNames.push_back ( { { "chip_data_mask_" + std::to_string ( i ), "header2_size_" + std::to_string ( i ), "event_size_" + std::to_string ( i ) } } );
+	for ( int j = 0; j < _nChips; j++ )
+	{
+	    std::array < std::string, _nChipParameters > names;
+	    for ( size_t k = 0; k < _nChipParameters; k++ )
+	    {
+		names[k] = chipParameterPrefix[k] + std::to_string ( i ) + "_" + std::to_string ( j );
+	    }
+	    _chipParameterNames.push_back ( names );
+	}
+    }
+
+}
+
+
+namespace
+{
+    // the per chip values stored as event parameters
+    enum ChipParameter { kL1cnt, kPipeaddr, kBufOvf, kLatErr, kStub1, kStub2, kStub3, kBend1, kBend2, kBend3 };
+
+    // the number of strips of a sensor on one chip
+    const size_t nStrips = 127;
+
+    // append the strips of one sensor, stored in 4 words starting with the last strips,
+    // the highest bit of the last word is unused
+    void appendStrips ( const uint32_t * words, FloatVec & strips )
+    {
+	size_t offset = strips.size ( );
+	strips.resize ( offset + nStrips );
+	float * out = strips.data ( ) + offset;
+	for ( int i = 3; i >= 0; i-- )
+	{
+	    unsigned int nBits = ( i == 3 ) ? 31 : 32;
+	    for ( unsigned int k = 0; k < nBits; k++ )
+	    {
+		*out++ = ( words[i] >> k ) & 1;
+	    }
+	}
+    }
+
+    // debug output of the strips of one sensor on one chip
+    void printStrips ( const char * name, const FloatVec & strips )
+    {
+	if ( streamlog_level ( DEBUG0 ) )
+	{
+	    std::string bits ( nStrips, '0' );
+	    for ( size_t k = 0; k < nStrips; k++ )
+	    {
+		if ( strips[strips.size ( ) - nStrips + k] != 0 )
+		{
+		    bits[k] = '1';
+		}
+	    }
+	    streamlog_out ( DEBUG0 ) << name << bits << endl;
+	}
+    }
+}
+
+
+size_t Ph2ACF2LCIOConverter::getEventSize ( ) const
+{
+    if ( _dataformat == "slink" )
+    {
+	return 19 * sizeof ( uint32_t );
+    }
+    // 5 words header 1, for each FE one word header 2 and 11 words for each chip
+    return ( 5 + _nFE * ( 1 + _nChips * 11 ) ) * sizeof ( uint32_t );
 }
 
 
@@ -92,30 +177,31 @@ void Ph2ACF2LCIOConverter::readDataSource ( int /* numEvents */ )
     streamlog_out ( DEBUG4 ) << "Reading " << _fileName << " with Ph2ACF2LCIOConverter!" << endl;
     _runNumber = atoi ( _formattedRunNumber.c_str ( ) );
 
-    // open file
-    ifstream infile;
-    infile.open ( _fileName.c_str ( ) );
-    if ( !infile.is_open ( ) )
+    // open file, the whole file is mapped into memory and decoded in place
+    std::unique_ptr < EUTelMappedFile > infile;
+    try
+    {
+	infile.reset ( new EUTelMappedFile ( _fileName ) );
+    }
+    catch ( lcio::IOException & e )
     {
 	streamlog_out ( ERROR5 ) << "Ph2ACF2LCIOConverter could not read the file " << _fileName << " correctly. Please check the path and file names that have been input!" << endl;
 	exit ( -1 );
     }
+
+    streamlog_out ( DEBUG4 ) << "Input file " << _fileName << " successfully opened!" << endl;
+    if ( _dataformat == "raw" )
+    {
+	streamlog_out ( DEBUG4 ) << "Assuming the file is encoded in RAW file format!" << endl;
+    }
+    else if ( _dataformat == "slink" )
+    {
+	streamlog_out ( DEBUG4 ) << "Assuming the file is encoded in SLINK file format!" << endl;
+    }
     else
     {
-	streamlog_out ( DEBUG4 ) << "Input file " << _fileName << " successfully opened!" << endl;
-	if ( _dataformat == "raw" )
-	{
-	    streamlog_out ( DEBUG4 ) << "Assuming the file is encoded in RAW file format!" << endl;
-	}
-	else if ( _dataformat == "slink" )
-	{
-	    streamlog_out ( DEBUG4 ) << "Assuming the file is encoded in SLINK file format!" << endl;
-	}
-	else
-	{
-	    streamlog_out ( ERROR5 ) << "Unknown file format set! Valid inputs are 'raw' and 'slink'!" << endl;
-	    exit ( -1 );
-	}
+	streamlog_out ( ERROR5 ) << "Unknown file format set! Valid inputs are 'raw' and 'slink'!" << endl;
+	exit ( -1 );
     }
 
     LCRunHeaderImpl * runHeader = new LCRunHeaderImpl ( );
@@ -124,487 +210,419 @@ void Ph2ACF2LCIOConverter::readDataSource ( int /* numEvents */ )
     ProcessorMgr::instance ( ) -> processRunHeader ( runHeader ) ;
     delete runHeader;
 
-    // the header in raw file format
-    bool raw_headeropen = false;
-    bool maxreached = false;
+    EUTelMappedFile::Cursor cursor = infile -> getCursor ( );
 
-    do
+    // the header in raw file format
+    if ( _dataformat == "raw" )
     {
-
-	// header / event parameters
-
-	// header 1
-	unsigned int header1_size = 0;
-	unsigned int fe_nbr = 0;
-	unsigned int block_size = 0;
-	unsigned int cic_id = 0;
-	unsigned int chip_id = 0;
-	unsigned int data_format_ver = 0;
-	unsigned int dummy_size = 0;
-	unsigned int trigdata_size = 0;
-	unsigned int event_nbr = 0;
-	unsigned int bx_cnt = 0;
-	unsigned int stubdata_size = 0;
-	unsigned int tlu_trigger_id = 0;
-	unsigned int tdc = 0;
-
-	// header 2, for each FE
-	std::vector < unsigned int > chip_data_mask;
-	std::vector < unsigned int > header2_size;
-	std::vector < unsigned int > event_size;
-
-	// cbc trigdata, for each chip
-	std::vector < std::vector < unsigned int > > lat_err;
-	std::vector < std::vector < unsigned int > > buf_ovf;
-	std::vector < std::vector < unsigned int > > pipeaddr;
-	std::vector < std::vector < unsigned int > > l1cnt;
-
-	// cbc stubdata, for each chip
-	std::vector < std::vector < unsigned int > > stub1;
-	std::vector < std::vector < unsigned int > > stub2;
-	std::vector < std::vector < unsigned int > > stub3;
-	std::vector < std::vector < unsigned int > > bend1;
-	std::vector < std::vector < unsigned int > > bend2;
-	std::vector < std::vector < unsigned int > > bend3;
-
-	if ( eventCounter > _maxRecordNumber && _maxRecordNumber > 0 )
+	uint32_t cMask = 0xAAAAAAAA;
+	uint32_t headervec[12] = { 0 };
+	if ( cursor.canRead ( sizeof ( headervec ) ) )
 	{
-	    maxreached = true;
-	    break ;
+	    cursor.read ( headervec, 12 );
 	}
-
-	if ( eventCounter % 1000 == 0 || eventCounter < 10 )
+	streamlog_out ( DEBUG0 ) << "File Header: ";
+	for ( int i = 0; i < 12; i++ )
 	{
-	    streamlog_out ( DEBUG4 ) << "Processing event " << eventCounter << " in run " << _runNumber << endl;
+	    streamlog_out ( DEBUG0 ) << headervec[i] << " ";
+	}
+	streamlog_out ( DEBUG0 ) << endl;
+	if ( headervec[0] == cMask && headervec[3] == cMask && headervec[6] == cMask && headervec[9] == cMask && headervec[11] == cMask )
+	{
+	    char cType[8] = { 0 };
+	    cType[0] = ( headervec[1] && 0xFF000000 ) >> 24;
+	    cType[1] = ( headervec[1] && 0x00FF0000 ) >> 16;
+	    cType[2] = ( headervec[1] && 0x0000FF00 ) >> 8;
+	    cType[3] = ( headervec[1] && 0x000000FF );
+
+	    cType[4] = ( headervec[2] && 0xFF000000 ) >> 24;
+	    cType[5] = ( headervec[2] && 0x00FF0000 ) >> 16;
+	    cType[6] = ( headervec[2] && 0x0000FF00 ) >> 8;
+	    cType[7] = ( headervec[2] && 0x000000FF );
+
+	    std::string cTypeString ( cType );
+	    std::string fType = cTypeString;
+
+	    uint32_t fVersionMajor = headervec[4];
+	    uint32_t fVersionMinor = headervec[5];
+
+	    uint32_t fBeId = headervec[7] & 0x000003FF;
+	    uint32_t fNCbc = headervec[8];
+
+	    uint32_t fEventSize32 = headervec[10];
+	    streamlog_out ( DEBUG4 ) << "Board Type: " << fType << endl;
+	    streamlog_out ( DEBUG4 ) << "FWMajor: " << fVersionMajor << endl;
+	    streamlog_out ( DEBUG4 ) << "FWMinor: " << fVersionMinor << endl;
+	    streamlog_out ( DEBUG4 ) << "BeId: " << fBeId << endl;
+	    streamlog_out ( DEBUG4 ) << "NCbc: " << fNCbc << endl;
+	    streamlog_out ( DEBUG4 ) << "EventSize32: " << fEventSize32 << endl;
+	    streamlog_out ( DEBUG4 ) << "Valid header!" << endl;
 	}
+	else
+	{
+	    streamlog_out ( ERROR5 ) << "Error, this is not a valid header!" << endl;
+	    exit ( -1 );
+	}
+    }
 
-	if ( _dataformat == "raw" )
+    // all events have the same size, a truncated last event is not converted
+    size_t eventSize = getEventSize ( );
+    auto splitEvent = [ & ] ( EUTelMappedFile::Cursor & event )
+    {
+	if ( !cursor.canRead ( eventSize ) )
 	{
+	    return false;
+	}
+	event = cursor.take ( eventSize );
+	return true;
+    };
 
-	    // the first event has a header
-	    if ( raw_headeropen == false )
+    // with decoder threads the events are decoded ahead, without logging
+    std::unique_ptr < EUTelDecoderPipeline > pipeline;
+    if ( _nDecoderThreads > 0 )
+    {
+	_stubSyncErrors = 0;
+	int maxEvents = _maxRecordNumber > 0 ? _maxRecordNumber + 1 : -1;
+	int splitCounter = 0;
+	pipeline.reset ( new EUTelDecoderPipeline ( _nDecoderThreads, _decoderQueueSize,
+	    [ &, maxEvents, splitCounter ] ( EUTelMappedFile::Cursor & event ) mutable
 	    {
-		uint32_t cMask = 0xAAAAAAAA;
-		std::vector < uint32_t > headervec;
-		raw_headeropen = true;
-		streamlog_out ( DEBUG0 ) << "File Header: ";
-		for ( int i = 0; i < 12; i++ )
-		{
-		    uint32_t tempint;
-		    infile.read ( reinterpret_cast < char * > ( &tempint ), sizeof ( uint32_t ) );
-		    headervec.push_back ( tempint );
-		    streamlog_out ( DEBUG0 ) << tempint << " ";
-		}
-		streamlog_out ( DEBUG0 ) << endl;
-		if ( headervec.at ( 0 ) == cMask && headervec.at ( 3 ) == cMask && headervec.at ( 6 ) == cMask && headervec.at ( 9 ) == cMask && headervec.at ( 11 ) == cMask )
+		if ( maxEvents >= 0 && splitCounter >= maxEvents )
 		{
-		    char cType[8] = { 0 };
-		    cType[0] = ( headervec.at ( 1 ) && 0xFF000000 ) >> 24;
-		    cType[1] = ( headervec.at ( 1 ) && 0x00FF0000 ) >> 16;
-		    cType[2] = ( headervec.at ( 1 ) && 0x0000FF00 ) >> 8;
-		    cType[3] = ( headervec.at ( 1 ) && 0x000000FF );
-
-		    cType[4] = ( headervec.at ( 2 ) && 0xFF000000 ) >> 24;
-		    cType[5] = ( headervec.at ( 2 ) && 0x00FF0000 ) >> 16;
-		    cType[6] = ( headervec.at ( 2 ) && 0x0000FF00 ) >> 8;
-		    cType[7] = ( headervec.at ( 2 ) && 0x000000FF );
-
-		    std::string cTypeString ( cType );
-		    std::string fType = cTypeString;
-
-		    uint32_t fVersionMajor = headervec.at ( 4 );
-		    uint32_t fVersionMinor = headervec.at ( 5 );
-
-		    uint32_t fBeId = headervec.at ( 7 ) & 0x000003FF;
-		    uint32_t fNCbc = headervec.at ( 8 );
-
-		    uint32_t fEventSize32 = headervec.at ( 10 );
-		    streamlog_out ( DEBUG4 ) << "Board Type: " << fType << endl;
-		    streamlog_out ( DEBUG4 ) << "FWMajor: " << fVersionMajor << endl;
-		    streamlog_out ( DEBUG4 ) << "FWMinor: " << fVersionMinor << endl;
-		    streamlog_out ( DEBUG4 ) << "BeId: " << fBeId << endl;
-		    streamlog_out ( DEBUG4 ) << "NCbc: " << fNCbc << endl;
-		    streamlog_out ( DEBUG4 ) << "EventSize32: " << fEventSize32 << endl;
-		    streamlog_out ( DEBUG4 ) << "Valid header!" << endl;
+		    return false;
 		}
-		else
+		splitCounter++;
+		return splitEvent ( event );
+	    },
+	    [ this ] ( EUTelMappedFile::Cursor event, size_t eventIndex ) -> LCEventImpl *
+	    {
+		if ( _dataformat == "raw" )
 		{
-		    streamlog_out ( ERROR5 ) << "Error, this is not a valid header!" << endl;
-		    exit ( -1 );
+		    return decodeRawEvent ( event, static_cast < int > ( eventIndex ), false );
 		}
+		return decodeSlinkEvent ( event, static_cast < int > ( eventIndex ), false );
+	    } ) );
+    }
 
-	    }
-
-	    // the output vectors
-	    FloatVec dataoutputvec_top;
-	    FloatVec dataoutputvec_bot;
-
-	    // read event header
-	    streamlog_out ( DEBUG1 ) << endl;
-	    streamlog_out ( DEBUG1 ) << "CBC Header1:" << endl;
-	    uint32_t tempint;
-	    std::vector < uint32_t > vec_header1;
-	    for ( int i = 0; i < 5; i++ )
-	    {
-		infile.read ( reinterpret_cast < char * > ( &tempint ), sizeof ( uint32_t ) );
-		vec_header1.push_back ( tempint );
-	    }
+    while ( true )
+    {
+	if ( eventCounter > _maxRecordNumber && _maxRecordNumber > 0 )
+	{
+	    break ;
+	}
 
-	    for ( unsigned int i = 0 ; i < vec_header1.size ( ); i++ )
+	std::unique_ptr < LCEventImpl > anEvent;
+	if ( pipeline )
+	{
+	    anEvent = pipeline -> next ( );
+	}
+	else
+	{
+	    EUTelMappedFile::Cursor event ( nullptr, nullptr );
+	    if ( splitEvent ( event ) )
 	    {
-		if ( i == 0 )
+		if ( _dataformat == "raw" )
 		{
-		    streamlog_out ( DEBUG3 ) << "Part 0: " << vec_header1.at ( i ) << endl;
-
-		    header1_size = ( vec_header1.at ( i ) >> 24 );
-		    streamlog_out ( DEBUG3 ) << " header1_size " << header1_size << endl;
-
-		    fe_nbr = ( vec_header1.at ( i ) >> 16 ) & 0xFF;
-		    streamlog_out ( DEBUG3 ) << " fe_nbr " << fe_nbr << endl;
-
-		    block_size = ( ( ( vec_header1.at ( i ) >> 8 ) & 0xFF ) + ( ( vec_header1.at ( i ) ) & 0xFF ) );
-		    streamlog_out ( DEBUG3 ) << " block_size " << block_size << endl;
+		    anEvent.reset ( decodeRawEvent ( event, eventCounter, true ) );
 		}
-		if ( i == 1 )
+		else
 		{
-		    streamlog_out ( DEBUG3 ) << "Part 1: " << vec_header1.at ( i ) << endl;
-
-		    cic_id = ( vec_header1.at ( i ) >> 24 );
-		    streamlog_out ( DEBUG3 ) << " cic_id " << cic_id << endl;
-
-		    chip_id = ( vec_header1.at ( i ) >> 16 ) & 0xFF;
-		    streamlog_out ( DEBUG3 ) << " chip_id " << chip_id << endl;
-
-		    data_format_ver = ( vec_header1.at ( i ) >> 8 ) & 0xFF;
-		    streamlog_out ( DEBUG3 ) << " data_format_ver " << data_format_ver << endl;
-
-		    dummy_size = ( vec_header1.at ( i ) ) & 0xFF;
-		    streamlog_out ( DEBUG3 ) << " dummy_size " << dummy_size << endl;
+		    anEvent.reset ( decodeSlinkEvent ( event, eventCounter, true ) );
 		}
-		if ( i == 2 )
-		{
-		    streamlog_out ( DEBUG3 ) << "Part 2: " << vec_header1.at ( i ) << endl;
+	    }
+	}
+	if ( !anEvent )
+	{
+	    break;
+	}
 
-		    trigdata_size = ( vec_header1.at ( i ) >> 24 );
-		    streamlog_out ( DEBUG3 ) << " trigdata_size " << trigdata_size << endl;
+	if ( eventCounter % 1000 == 0 || eventCounter < 10 )
+	{
+	    streamlog_out ( DEBUG4 ) << "Processing event " << eventCounter << " in run " << _runNumber << endl;
+	}
 
-		    event_nbr = ( ( ( vec_header1.at ( i ) >> 16 ) & 0xFF ) + ( ( vec_header1.at ( i ) >> 8 ) & 0xFF ) + ( ( vec_header1.at ( i ) ) & 0xFF ) );
-		    streamlog_out ( DEBUG3 ) << " event_nbr " << event_nbr << endl;
-		}
-		if ( i == 3 )
-		{
-		    streamlog_out ( DEBUG3 ) << "Part 3: " << vec_header1.at ( i ) << endl;
+	ProcessorMgr::instance ( ) -> processEvent ( anEvent.get ( ) ) ;
+	eventCounter++;
+    }
+    pipeline.reset ( );
 
-		    bx_cnt = ( vec_header1.at ( i ) );
-		    streamlog_out ( DEBUG3 ) << " bx_cnt " << bx_cnt << endl;
-		}
-		if ( i == 4 )
-		{
-		    streamlog_out ( DEBUG3 ) << "Part 4: " << vec_header1.at ( i ) << endl;
+    if ( _stubSyncErrors > 0 )
+    {
+	streamlog_out ( WARNING1 ) << "Warning! " << _stubSyncErrors.load ( ) << " stubs found, but sync/or254 is not 1!" << endl;
+    }
 
-		    stubdata_size = ( vec_header1.at ( i ) >> 24 );
-		    streamlog_out ( DEBUG3 ) << " stubdata_size " << stubdata_size << endl;
+    if ( cursor.remaining ( ) > 0 && cursor.remaining ( ) < eventSize )
+    {
+	streamlog_out ( WARNING1 ) << "Ignoring " << cursor.remaining ( ) << " bytes of an incomplete event at the end of " << _fileName << endl;
+    }
 
-		    tlu_trigger_id = ( ( ( vec_header1.at ( i ) >> 16 ) & 0xFF ) + ( ( vec_header1.at ( i ) >> 8 ) & 0xFF ) );
-		    streamlog_out ( DEBUG3 ) << " tlu_trigger_id " << tlu_trigger_id << endl;
+}
 
-		    tdc = ( vec_header1.at ( i ) ) & 0xFF;
-		    streamlog_out ( DEBUG3 ) << " tdc " << tdc << endl;
-		}
-	    }
 
-	    // loop frontends
-	    for ( int iFE = 0; iFE < _nFE; iFE++ )
-	    {
-		// read header 2
-		std::vector < uint32_t > vec_header2;
-		uint32_t tempint;
-		infile.read ( reinterpret_cast < char * > ( &tempint ), sizeof ( uint32_t ) );
-		vec_header2.push_back ( tempint );
-		streamlog_out ( DEBUG2 ) << endl;
-		streamlog_out ( DEBUG2 ) << "CBC Header2, FE " << iFE << ":" << endl;
-		for ( unsigned int i = 0; i < vec_header2.size ( ); i++ )
-		{
-		    if ( i == 0 )
-		    {
-			chip_data_mask.push_back ( vec_header2.at ( i ) >> 24 );
-			streamlog_out ( DEBUG2 ) << " chip_data_mask " << chip_data_mask.at ( iFE ) << endl;
+EUTelEventImpl * Ph2ACF2LCIOConverter::decodeRawEvent ( EUTelMappedFile::Cursor event, int eventNumber, bool log )
+{
+    // header 1
+    unsigned int header1_size = 0;
+    unsigned int fe_nbr = 0;
+    unsigned int block_size = 0;
+    unsigned int cic_id = 0;
+    unsigned int chip_id = 0;
+    unsigned int data_format_ver = 0;
+    unsigned int dummy_size = 0;
+    unsigned int trigdata_size = 0;
+    unsigned int event_nbr = 0;
+    unsigned int bx_cnt = 0;
+    unsigned int stubdata_size = 0;
+    unsigned int tlu_trigger_id = 0;
+    unsigned int tdc = 0;
+
+    // header 2, for each FE: chip_data_mask, header2_size and event_size
+    std::vector < std::array < unsigned int, 3 > > feValues ( _nFE );
+
+    // cbc trigdata and stubdata, for each chip
+    std::vector < std::array < unsigned int, _nChipParameters > > chipValues ( _nFE * _nChips );
+
+    const unsigned int stubMask = createMask ( 0, 7 );
+    const unsigned int bendMask = createMask ( 0, 3 );
+
+    // the output vectors
+    FloatVec dataoutputvec_top;
+    FloatVec dataoutputvec_bot;
+    dataoutputvec_top.reserve ( _nFE * _nChips * nStrips );
+    dataoutputvec_bot.reserve ( _nFE * _nChips * nStrips );
+
+    // read event header
+    uint32_t vec_header1[5];
+    event.read ( vec_header1, 5 );
+
+    header1_size = ( vec_header1[0] >> 24 );
+    fe_nbr = ( vec_header1[0] >> 16 ) & 0xFF;
+    block_size = ( ( ( vec_header1[0] >> 8 ) & 0xFF ) + ( ( vec_header1[0] ) & 0xFF ) );
+
+    cic_id = ( vec_header1[1] >> 24 );
+    chip_id = ( vec_header1[1] >> 16 ) & 0xFF;
+    data_format_ver = ( vec_header1[1] >> 8 ) & 0xFF;
+    dummy_size = ( vec_header1[1] ) & 0xFF;
+
+    trigdata_size = ( vec_header1[2] >> 24 );
+    event_nbr = ( ( ( vec_header1[2] >> 16 ) & 0xFF ) + ( ( vec_header1[2] >> 8 ) & 0xFF ) + ( ( vec_header1[2] ) & 0xFF ) );
+
+    bx_cnt = ( vec_header1[3] );
+
+    stubdata_size = ( vec_header1[4] >> 24 );
+    tlu_trigger_id = ( ( ( vec_header1[4] >> 16 ) & 0xFF ) + ( ( vec_header1[4] >> 8 ) & 0xFF ) );
+    tdc = ( vec_header1[4] ) & 0xFF;
+
+    if ( log )
+    {
+	streamlog_out ( DEBUG1 ) << endl;
+	streamlog_out ( DEBUG1 ) << "CBC Header1:" << endl;
+	streamlog_out ( DEBUG3 ) << "Part 0: " << vec_header1[0] << endl;
+	streamlog_out ( DEBUG3 ) << " header1_size " << header1_size << endl;
+	streamlog_out ( DEBUG3 ) << " fe_nbr " << fe_nbr << endl;
+	streamlog_out ( DEBUG3 ) << " block_size " << block_size << endl;
+	streamlog_out ( DEBUG3 ) << "Part 1: " << vec_header1[1] << endl;
+	streamlog_out ( DEBUG3 ) << " cic_id " << cic_id << endl;
+	streamlog_out ( DEBUG3 ) << " chip_id " << chip_id << endl;
+	streamlog_out ( DEBUG3 ) << " data_format_ver " << data_format_ver << endl;
+	streamlog_out ( DEBUG3 ) << " dummy_size " << dummy_size << endl;
+	streamlog_out ( DEBUG3 ) << "Part 2: " << vec_header1[2] << endl;
+	streamlog_out ( DEBUG3 ) << " trigdata_size " << trigdata_size << endl;
+	streamlog_out ( DEBUG3 ) << " event_nbr " << event_nbr << endl;
+	streamlog_out ( DEBUG3 ) << "Part 3: " << vec_header1[3] << endl;
+	streamlog_out ( DEBUG3 ) << " bx_cnt " << bx_cnt << endl;
+	streamlog_out ( DEBUG3 ) << "Part 4: " << vec_header1[4] << endl;
+	streamlog_out ( DEBUG3 ) << " stubdata_size " << stubdata_size << endl;
+	streamlog_out ( DEBUG3 ) << " tlu_trigger_id " << tlu_trigger_id << endl;
+	streamlog_out ( DEBUG3 ) << " tdc " << tdc << endl;
+    }
 
-			header2_size.push_back ( ( vec_header2.at ( i ) >> 16 ) & 0xFF );
-			streamlog_out ( DEBUG2 ) << " header2_size " << header2_size.at ( iFE ) << endl;
+    // loop frontends
+    for ( int iFE = 0; iFE < _nFE; iFE++ )
+    {
+	// read header 2
+	uint32_t header2 = event.read < uint32_t > ( );
+	std::array < unsigned int, 3 > & fe = feValues[iFE];
+	fe[0] = header2 >> 24;
+	fe[1] = ( header2 >> 16 ) & 0xFF;
+	fe[2] = ( ( header2 >> 8 ) & 0xFF ) + ( header2 & 0xFF );
+	if ( log )
+	{
+	    streamlog_out ( DEBUG2 ) << endl;
+	    streamlog_out ( DEBUG2 ) << "CBC Header2, FE " << iFE << ":" << endl;
+	    streamlog_out ( DEBUG2 ) << " chip_data_mask " << fe[0] << endl;
+	    streamlog_out ( DEBUG2 ) << " header2_size " << fe[1] << endl;
+	    streamlog_out ( DEBUG2 ) << " event_size " << fe[2] << endl;
+	    streamlog_out ( DEBUG2 ) << endl;
+	}
 
-			event_size.push_back ( ( ( vec_header2.at ( i ) >> 8 ) & 0xFF ) + ( ( vec_header2.at ( i ) ) & 0xFF ) );
-			streamlog_out ( DEBUG2 ) << " event_size " << event_size.at ( iFE ) << endl;
-		    }
-		}
-		streamlog_out ( DEBUG2 ) << endl;
-
-		// chip loop
-		// push_back for the vectors...
-		lat_err.push_back ( std::vector < unsigned int > ( ) );
-		buf_ovf.push_back ( std::vector < unsigned int > ( ) );
-		pipeaddr.push_back ( std::vector < unsigned int > ( ) );
-		l1cnt.push_back ( std::vector < unsigned int > ( ) );
-		stub1.push_back ( std::vector < unsigned int > ( ) );
-		stub2.push_back ( std::vector < unsigned int > ( ) );
-		stub3.push_back ( std::vector < unsigned int > ( ) );
-		bend1.push_back ( std::vector < unsigned int > ( ) );
-		bend2.push_back ( std::vector < unsigned int > ( ) );
-		bend3.push_back ( std::vector < unsigned int > ( ) );
-
-		for ( int j = 0; j < _nChips; j++ )
-		{
-		    // top sensor
-		    int topvec[4][32] = { 0 };
-		    // bottom sensor
-		    int botvec[4][32] = { 0 };
-
-		    // 9 for trg data, 2 for stub
-		    for ( int i = 0; i < 11; i++ )
-		    {
-			uint32_t tempint;
-			infile.read ( reinterpret_cast < char * > ( &tempint ), sizeof ( uint32_t ) );
-
-			if ( i < 4 )
-			{
-			    // top sensor
-			    bitset < 32 > tempbit ( tempint );
-			    for ( unsigned j = 0; j < tempbit.size ( ); j++ )
-			    {
-				if ( tempbit.test ( j ) )
-				{
-				    topvec[i][j] = 1;
-				}
-				else
-				{
-				    topvec[i][j] = 0;
-				}
-			    }
-			}
-			if ( i >=4 && i < 8 )
-			{
-			    // bottom sensor
-			    bitset < 32 > tempbit ( tempint );
-			    for ( unsigned j = 0; j < tempbit.size ( ); j++ )
-			    {
-				if ( tempbit.test ( j ) )
-				{
-				    botvec[i - 4][j] = 1;
-				}
-				else
-				{
-				    botvec[i - 4][j] = 0;
-				}
-			    }
-			}
-			if ( i == 8 )
-			{
-			    // cbc trgdata status
-			    unsigned int test =  ( ( tempint & 1 ) >> 1 );
-			    lat_err[iFE].push_back ( test );
-			    streamlog_out ( DEBUG1 ) << " lat_err " << lat_err.at ( iFE ).at ( j ) << endl;
-			    buf_ovf[iFE].push_back ( ( tempint & 2 ) >> 2 );
-			    streamlog_out ( DEBUG1 ) << " buf_ovf " << buf_ovf.at ( iFE ).at ( j ) << endl;
-			    pipeaddr[iFE].push_back ( ( tempint >> 4 ) & 0x09 );
-			    streamlog_out ( DEBUG1 ) << " pipeaddr " << pipeaddr.at ( iFE ).at ( j ) << endl;
-			    l1cnt[iFE].push_back ( ( tempint >> 16 ) & 0xFE );
-			    streamlog_out ( DEBUG1 ) << " l1cnt " << l1cnt.at ( iFE ).at ( j ) << endl;
-			}
-			if ( i == 9 )
-			{
-			    // stubdata
-			    stub1[iFE].push_back ( createMask ( 0, 7 ) & tempint );
-			    stub2[iFE].push_back ( createMask ( 0, 7 ) & ( tempint >> 8 ) );
-			    stub3[iFE].push_back ( createMask ( 0, 7 ) & ( tempint >> 16 ) );
-			    streamlog_out ( DEBUG1 ) << " stub1 " << stub1.at ( iFE ).at ( j ) << " stub2 " << stub2.at ( iFE ).at ( j ) << " stub3 " << stub3.at ( iFE ).at ( j ) << endl;
-			}
-			if ( i == 10 )
-			{
-			    // stubdata
-			    unsigned int sync = ( ( tempint >> 3) & 1 );
-			    unsigned int or254 = ( ( tempint >> 1 ) & 1 );
-			    streamlog_out ( DEBUG1 ) << " sync " << sync << " or254 " << or254 << endl;
-			    bend1[iFE].push_back ( createMask ( 0, 3 ) & ( tempint >> 8 ) );
-			    bend2[iFE].push_back ( createMask ( 0, 3 ) & ( tempint >> 16 ) );
-			    bend3[iFE].push_back ( createMask ( 0, 3 ) & ( tempint >> 24 ) );
-			    streamlog_out ( DEBUG1 ) << " bend1 " << bend1.at ( iFE ).at ( j ) << " bend2 " << bend2.at ( iFE ).at ( j ) << " bend3 " << bend3.at ( iFE ).at ( j ) << endl;
-
-			    // check
-			    if ( stub1.at ( iFE).at ( j ) == 1 )
-			    {
-				if ( sync != 1 || or254 != 1 )
-				{
-				    streamlog_out ( WARNING1 ) << "Warning! Stub found, but sync/or254 is not 1!" << endl;
-				}
-			    }
-			}
-		    }
-
-		    int counter = 0;
-		    streamlog_out ( DEBUG0 ) << "Top ";
-		    for ( int i = 3; i >= 0; i-- )
-		    {
-			for ( int k = 0; k < 32; k++ )
-			{
-			    counter++;
-			    if ( counter != 32 )
-			    {
-				streamlog_out ( DEBUG0 ) << topvec[i][k] ;
-				// output to the vector
-				dataoutputvec_top.push_back ( topvec[i][k] );
-			    }
-			}
-		    }
-		    streamlog_out ( DEBUG0 ) << endl;
-		    counter = 0;
-		    streamlog_out ( DEBUG0 ) << "Bot ";
-		    for ( int i = 3; i >= 0; i-- )
-		    {
-			for ( int k = 0; k < 32; k++ )
-			{
-			    counter ++;
-			    if ( counter != 32 )
-			    {
-				streamlog_out ( DEBUG0 ) << botvec[i][k] ;
-				// output to the vector
-				dataoutputvec_bot.push_back ( botvec[i][k] );
-			    }
-			}
-		    }
-		    streamlog_out ( DEBUG0 ) << endl;
-
-		} // done chip loop
-
-	    } // done FE loop
-
-	    // let there be output
-	    EUTelEventImpl* anEvent = new EUTelEventImpl ( );
-	    const char * dummyencode = "CBCRaw:1,";
-
-	    LCCollectionVec* rawDataCollectionTop = new LCCollectionVec ( LCIO::TRACKERDATA );
-	    CellIDEncoder < TrackerDataImpl > chipIDEncoderTop ( dummyencode, rawDataCollectionTop );
-	    TrackerDataImpl * rawtop = new TrackerDataImpl ( );
-	    rawtop -> setChargeValues ( dataoutputvec_top );
-	    chipIDEncoderTop.setCellID ( rawtop );
-	    rawDataCollectionTop -> push_back ( rawtop );
-	    anEvent -> addCollection ( rawDataCollectionTop, _rawDataCollectionNameTop );
-
-	    LCCollectionVec* rawDataCollectionBot = new LCCollectionVec ( LCIO::TRACKERDATA );
-	    CellIDEncoder < TrackerDataImpl > chipIDEncoderBot ( dummyencode, rawDataCollectionBot );
-	    TrackerDataImpl * rawbot = new TrackerDataImpl ( );
-	    rawbot -> setChargeValues ( dataoutputvec_bot );
-	    chipIDEncoderBot.setCellID ( rawbot );
-	    rawDataCollectionBot -> push_back ( rawbot );
-	    anEvent -> addCollection ( rawDataCollectionBot, _rawDataCollectionNameBottom );
-
-	    anEvent -> setRunNumber ( _runNumber );
-	    anEvent -> setEventNumber ( eventCounter );
-	    anEvent -> setDetectorName ( "CBC" );
-	    anEvent -> parameters ( ).setValue ( "EventType", 2 );
-
-	    // now we set all the header parameters
-	    anEvent -> parameters ( ).setValue ( "header1_size", int ( header1_size ) );
-	    anEvent -> parameters ( ).setValue ( "fe_nbr", int ( fe_nbr ) );
-	    anEvent -> parameters ( ).setValue ( "block_size", int ( block_size ) );
-	    anEvent -> parameters ( ).setValue ( "cic_id", int ( cic_id ) );
-	    anEvent -> parameters ( ).setValue ( "chip_id", int ( chip_id ) );
-	    anEvent -> parameters ( ).setValue ( "data_format_ver", int ( data_format_ver ) );
-	    anEvent -> parameters ( ).setValue ( "dummy_size", int ( dummy_size ) );
-	    anEvent -> parameters ( ).setValue ( "trigdata_size", int ( trigdata_size ) );
-	    anEvent -> parameters ( ).setValue ( "event_nbr", int ( event_nbr ) );
-	    anEvent -> parameters ( ).setValue ( "bx_cnt", int ( bx_cnt ) );
-	    anEvent -> parameters ( ).setValue ( "stubdata_size", int ( stubdata_size ) );
-	    anEvent -> parameters ( ).setValue ( "tlu_trigger_id", int ( tlu_trigger_id ) );
-	    anEvent -> parameters ( ).setValue ( "tdc", int ( tdc ) );
-
-	    for ( int i = 0; i < _nFE; i++ )
+	// chip loop
+	for ( int j = 0; j < _nChips; j++ )
+	{
+	    // 4 words top sensor, 4 words bottom sensor, 1 trg data, 2 stub data
+	    uint32_t words[11];
+	    event.read ( words, 11 );
+	    std::array < unsigned int, _nChipParameters > & chip = chipValues[iFE * _nChips + j];
+
+	    // cbc trgdata status
+	    chip[kLatErr] = ( words[8] & 1 ) >> 1;
+	    chip[kBufOvf] = ( words[8] & 2 ) >> 2;
+	    chip[kPipeaddr] = ( words[8] >> 4 ) & 0x09;
+	    chip[kL1cnt] = ( words[8] >> 16 ) & 0xFE;
+
+	    // stubdata
+	    chip[kStub1] = stubMask & words[9];
+	    chip[kStub2] = stubMask & ( words[9] >> 8 );
+	    chip[kStub3] = stubMask & ( words[9] >> 16 );
+	    unsigned int sync = ( ( words[10] >> 3) & 1 );
+	    unsigned int or254 = ( ( words[10] >> 1 ) & 1 );
+	    chip[kBend1] = bendMask & ( words[10] >> 8 );
+	    chip[kBend2] = bendMask & ( words[10] >> 16 );
+	    chip[kBend3] = bendMask & ( words[10] >> 24 );
+
+	    // top sensor
+	    appendStrips ( words, dataoutputvec_top );
+	    // bottom sensor
+	    appendStrips ( words + 4, dataoutputvec_bot );
+
+	    // check
+	    bool syncError = chip[kStub1] == 1 && ( sync != 1 || or254 != 1 );
+	    if ( !log )
 	    {
-		anEvent -> parameters ( ).setValue ( "chip_data_mask_" + std::to_string ( i ), int ( chip_data_mask.at ( i ) ) );
-		anEvent -> parameters ( ).setValue ( "header2_size_" + std::to_string ( i ), int ( header2_size.at ( i ) ) );
-		anEvent -> parameters ( ).setValue ( "event_size_" + std::to_string ( i ), int ( event_size.at ( i ) ) );
-
-		for ( int j = 0; j < _nChips; j++ )
+		if ( syncError )
 		{
-		    anEvent -> parameters ( ).setValue ( "l1cnt_" + std::to_string ( i ) + "_" + std::to_string ( j ), int ( l1cnt.at ( i ).at ( j ) ) );
-		    anEvent -> parameters ( ).setValue ( "pipeaddr" + std::to_string ( i ) + "_" + std::to_string ( j ), int ( pipeaddr.at ( i ).at ( j ) ) );
-		    anEvent -> parameters ( ).setValue ( "buf_ovf" + std::to_string ( i ) + "_" + std::to_string ( j ), int ( buf_ovf.at ( i ).at ( j ) ) );
-		    anEvent -> parameters ( ).setValue ( "lat_err" + std::to_string ( i ) + "_" + std::to_string ( j ), int ( lat_err.at ( i ).at ( j ) ) );
-		    anEvent -> parameters ( ).setValue ( "stub1_" + std::to_string ( i ) + "_" + std::to_string ( j ), int ( stub1.at ( i ).at ( j ) ) );
-		    anEvent -> parameters ( ).setValue ( "stub2_" + std::to_string ( i ) + "_" + std::to_string ( j ), int ( stub2.at ( i ).at ( j ) ) );
-		    anEvent -> parameters ( ).setValue ( "stub3_" + std::to_string ( i ) + "_" + std::to_string ( j ), int ( stub3.at ( i ).at ( j ) ) );
-		    anEvent -> parameters ( ).setValue ( "bend1_" + std::to_string ( i ) + "_" + std::to_string ( j ), int ( bend1.at ( i ).at ( j ) ) );
-		    anEvent -> parameters ( ).setValue ( "bend2_" + std::to_string ( i ) + "_" + std::to_string ( j ), int ( bend2.at ( i ).at ( j ) ) );
-		    anEvent -> parameters ( ).setValue ( "bend3_" + std::to_string ( i ) + "_" + std::to_string ( j ), int ( bend3.at ( i ).at ( j ) ) );
+		    _stubSyncErrors++;
 		}
-
+		continue;
 	    }
 
-	    // FIXME this will be the TLU trigger ID
-	    anEvent -> setTimeStamp ( long64 ( eventCounter * 100.0 ) );
-
-	    ProcessorMgr::instance ( ) -> processEvent ( static_cast < LCEventImpl* > ( anEvent ) ) ;
-	    eventCounter++;
-	    delete anEvent;
-	
-	} // done _dataformat if
-	else if ( _dataformat == "slink" )
+	    streamlog_out ( DEBUG1 ) << " lat_err " << chip[kLatErr] << endl;
+	    streamlog_out ( DEBUG1 ) << " buf_ovf " << chip[kBufOvf] << endl;
+	    streamlog_out ( DEBUG1 ) << " pipeaddr " << chip[kPipeaddr] << endl;
+	    streamlog_out ( DEBUG1 ) << " l1cnt " << chip[kL1cnt] << endl;
+	    streamlog_out ( DEBUG1 ) << " stub1 " << chip[kStub1] << " stub2 " << chip[kStub2] << " stub3 " << chip[kStub3] << endl;
+	    streamlog_out ( DEBUG1 ) << " sync " << sync << " or254 " << or254 << endl;
+	    streamlog_out ( DEBUG1 ) << " bend1 " << chip[kBend1] << " bend2 " << chip[kBend2] << " bend3 " << chip[kBend3] << endl;
+	    if ( syncError )
+	    {
+		streamlog_out ( WARNING1 ) << "Warning! Stub found, but sync/or254 is not 1!" << endl;
+	    }
+	    printStrips ( "Top ", dataoutputvec_top );
+	    printStrips ( "Bot ", dataoutputvec_bot );
+
+	} // done chip loop
+
+    } // done FE loop
+
+    // let there be output
+    EUTelEventImpl* anEvent = new EUTelEventImpl ( );
+    const char * dummyencode = "CBCRaw:1,";
+
+    LCCollectionVec* rawDataCollectionTop = new LCCollectionVec ( LCIO::TRACKERDATA );
+    CellIDEncoder < TrackerDataImpl > chipIDEncoderTop ( dummyencode, rawDataCollectionTop );
+    TrackerDataImpl * rawtop = new TrackerDataImpl ( );
+    rawtop -> setChargeValues ( dataoutputvec_top );
+    chipIDEncoderTop.setCellID ( rawtop );
+    rawDataCollectionTop -> push_back ( rawtop );
+    anEvent -> addCollection ( rawDataCollectionTop, _rawDataCollectionNameTop );
+
+    LCCollectionVec* rawDataCollectionBot = new LCCollectionVec ( LCIO::TRACKERDATA );
+    CellIDEncoder < TrackerDataImpl > chipIDEncoderBot ( dummyencode, rawDataCollectionBot );
+    TrackerDataImpl * rawbot = new TrackerDataImpl ( );
+    rawbot -> setChargeValues ( dataoutputvec_bot );
+    chipIDEncoderBot.setCellID ( rawbot );
+    rawDataCollectionBot -> push_back ( rawbot );
+    anEvent -> addCollection ( rawDataCollectionBot, _rawDataCollectionNameBottom );
+
+    anEvent -> setRunNumber ( _runNumber );
+    anEvent -> setEventNumber ( eventNumber );
+    anEvent -> setDetectorName ( "CBC" );
+    anEvent -> parameters ( ).setValue ( "EventType", 2 );
+
+    // now we set all the header parameters
+    anEvent -> parameters ( ).setValue ( "header1_size", int ( header1_size ) );
+    anEvent -> parameters ( ).setValue ( "fe_nbr", int ( fe_nbr ) );
+    anEvent -> parameters ( ).setValue ( "block_size", int ( block_size ) );
+    anEvent -> parameters ( ).setValue ( "cic_id", int ( cic_id ) );
+    anEvent -> parameters ( ).setValue ( "chip_id", int ( chip_id ) );
+    anEvent -> parameters ( ).setValue ( "data_format_ver", int ( data_format_ver ) );
+    anEvent -> parameters ( ).setValue ( "dummy_size", int ( dummy_size ) );
+    anEvent -> parameters ( ).setValue ( "trigdata_size", int ( trigdata_size ) );
+    anEvent -> parameters ( ).setValue ( "event_nbr", int ( event_nbr ) );
+    anEvent -> parameters ( ).setValue ( "bx_cnt", int ( bx_cnt ) );
+    anEvent -> parameters ( ).setValue ( "stubdata_size", int ( stubdata_size ) );
+    anEvent -> parameters ( ).setValue ( "tlu_trigger_id", int ( tlu_trigger_id ) );
+    anEvent -> parameters ( ).setValue ( "tdc", int ( tdc ) );
+
+    for ( int i = 0; i < _nFE; i++ )
+    {
+	for ( size_t k = 0; k < 3; k++ )
 	{
-
-	    // FIXME
-
-	    // the output vectors
-	    FloatVec dataoutputvec_top;
-	    FloatVec dataoutputvec_bot;
-
-	    // FIXME
-	    for ( int i = 0; i < 19; i++ )
+	    anEvent -> parameters ( ).setValue ( _feParameterNames.at ( i )[k], int ( feValues[i][k] ) );
+	}
+	for ( int j = 0; j < _nChips; j++ )
+	{
+	    for ( size_t k = 0; k < _nChipParameters; k++ )
 	    {
-		uint32_t tempint;
-		std::vector < uint32_t > inputvec;
-		infile.read ( reinterpret_cast < char * > ( &tempint ), sizeof ( uint32_t ) );
-		inputvec.push_back ( tempint );
-		streamlog_out ( DEBUG0 ) << tempint << " ";
+		anEvent -> parameters ( ).setValue ( _chipParameterNames.at ( i * _nChips + j )[k], int ( chipValues[i * _nChips + j][k] ) );
 	    }
-	    streamlog_out ( DEBUG0 ) << endl;
-
-	    // let there be output
-	    EUTelEventImpl* anEvent = new EUTelEventImpl ( );
-	    const char * dummyencode = "CBCRaw:1,";
-
-	    LCCollectionVec* rawDataCollectionTop = new LCCollectionVec ( LCIO::TRACKERDATA );
-	    CellIDEncoder < TrackerDataImpl > chipIDEncoderTop ( dummyencode, rawDataCollectionTop );
-	    TrackerDataImpl * rawtop = new TrackerDataImpl ( );
-	    rawtop -> setChargeValues ( dataoutputvec_top );
-	    chipIDEncoderTop.setCellID ( rawtop );
-	    rawDataCollectionTop -> push_back ( rawtop );
-	    anEvent -> addCollection ( rawDataCollectionTop, _rawDataCollectionNameTop );
-
-	    LCCollectionVec* rawDataCollectionBot = new LCCollectionVec ( LCIO::TRACKERDATA );
-	    CellIDEncoder < TrackerDataImpl > chipIDEncoderBot ( dummyencode, rawDataCollectionBot );
-	    TrackerDataImpl * rawbot = new TrackerDataImpl ( );
-	    rawbot -> setChargeValues ( dataoutputvec_bot );
-	    chipIDEncoderBot.setCellID ( rawbot );
-	    rawDataCollectionBot -> push_back ( rawbot );
-	    anEvent -> addCollection ( rawDataCollectionBot, _rawDataCollectionNameBottom );
+	}
+    }
 
-	    anEvent -> setRunNumber ( _runNumber );
-	    anEvent -> setEventNumber ( eventCounter );
-	    anEvent -> setDetectorName ( "CBC" );
-	    anEvent -> parameters ( ).setValue ( "EventType", 2 );
+    // FIXME this will be the TLU trigger ID
+    anEvent -> setTimeStamp ( long64 ( eventNumber * 100.0 ) );
 
-	    // FIXME this will be the TLU trigger ID
-	    anEvent -> setTimeStamp ( long64 ( eventCounter * 100.0 ) );
+    return anEvent;
+}
 
-	    ProcessorMgr::instance ( ) -> processEvent ( static_cast < LCEventImpl* > ( anEvent ) ) ;
-	    eventCounter++;
-	    delete anEvent;
 
-	} // done _dataformat if
+EUTelEventImpl * Ph2ACF2LCIOConverter::decodeSlinkEvent ( EUTelMappedFile::Cursor event, int eventNumber, bool log )
+{
+    // FIXME
 
-    } while ( !( infile.bad ( ) || infile.eof ( ) ) || maxreached == true );
+    // the output vectors
+    FloatVec dataoutputvec_top;
+    FloatVec dataoutputvec_bot;
 
-    infile.close ( );
+    // FIXME
+    while ( log && !event.atEnd ( ) )
+    {
+	streamlog_out ( DEBUG0 ) << event.read < uint32_t > ( ) << " ";
+    }
+    if ( log )
+    {
+	streamlog_out ( DEBUG0 ) << endl;
+    }
 
+    // let there be output
+    EUTelEventImpl* anEvent = new EUTelEventImpl ( );
+    const char * dummyencode = "CBCRaw:1,";
+
+    LCCollectionVec* rawDataCollectionTop = new LCCollectionVec ( LCIO::TRACKERDATA );
+    CellIDEncoder < TrackerDataImpl > chipIDEncoderTop ( dummyencode, rawDataCollectionTop );
+    TrackerDataImpl * rawtop = new TrackerDataImpl ( );
+    rawtop -> setChargeValues ( dataoutputvec_top );
+    chipIDEncoderTop.setCellID ( rawtop );
+    rawDataCollectionTop -> push_back ( rawtop );
+    anEvent -> addCollection ( rawDataCollectionTop, _rawDataCollectionNameTop );
+
+    LCCollectionVec* rawDataCollectionBot = new LCCollectionVec ( LCIO::TRACKERDATA );
+    CellIDEncoder < TrackerDataImpl > chipIDEncoderBot ( dummyencode, rawDataCollectionBot );
+    TrackerDataImpl * rawbot = new TrackerDataImpl ( );
+    rawbot -> setChargeValues ( dataoutputvec_bot );
+    chipIDEncoderBot.setCellID ( rawbot );
+    rawDataCollectionBot -> push_back ( rawbot );
+    anEvent -> addCollection ( rawDataCollectionBot, _rawDataCollectionNameBottom );
+
+    anEvent -> setRunNumber ( _runNumber );
+    anEvent -> setEventNumber ( eventNumber );
+    anEvent -> setDetectorName ( "CBC" );
+    anEvent -> parameters ( ).setValue ( "EventType", 2 );
+
+    // FIXME this will be the TLU trigger ID
+    anEvent -> setTimeStamp ( long64 ( eventNumber * 100.0 ) );
+
+    return anEvent;
 }
 
 
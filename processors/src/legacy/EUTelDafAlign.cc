@@ -98,7 +98,8 @@ using namespace marlin;
 using namespace eutelescope;
 
 EUTelDafAlign::EUTelDafAlign()
-    : EUTelDafBase("EUTelDafAlign"), _runPede(false), _pedeSteerfileName(""),
+    : EUTelDafBase("EUTelDafAlign"), _runPede(false), _batchedFit(false),
+      _pedeSteerfileName(""),
       _binaryFilename(""), _alignmentConstantLCIOFile(""),
       _alignmentConstantCollectionName(""), _translate(), _translateX(),
       _translateY(), _zRot(), _scale(), _scaleX(), _scaleY(), _resXMin(),
@@ -117,6 +118,13 @@ void EUTelDafAlign::dafParams() {
       "RunPede",
       "Build steering file, binary input file, and execute the pede program.",
       _runPede, true);
+  registerOptionalParameter(
+      "BatchedFit",
+      "Fit the track candidates of an event together in batches of eight. "
+      "The results agree with fitting them one by one within float rounding "
+      "if the planes are perpendicular to the beam and no earlier candidate "
+      "of the event failed the fit.",
+      _batchedFit, false);
   registerOptionalParameter("PedeSteerfileName",
                             "Name of the steering file for the pede program.",
                             _pedeSteerfileName, string("steer_mille.txt"));
@@ -289,11 +297,18 @@ int EUTelDafAlign::checkDutResids(daffitter::TrackCandidate<float, 4> &track) {
 }
 
 void EUTelDafAlign::dafEvent(LCEvent * /*event*/) {
+  if (_batchedFit) {
+    _system.fitPlanesInfoDafBatched();
+  }
   // Check found tracks
   for (size_t ii = 0; ii < _system.getNtracks(); ii++) {
     // run track fitter
     _nCandidates++;
-    _system.fitPlanesInfoDaf(_system.tracks.at(ii));
+    if (_batchedFit) {
+      _system.restoreMeasZ(_system.tracks.at(ii));
+    } else {
+      _system.fitPlanesInfoDaf(_system.tracks.at(ii));
+    }
     // Check resids, intime, angles
     if (not checkTrack(_system.tracks.at(ii))) {
       continue;
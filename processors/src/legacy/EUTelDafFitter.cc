@@ -121,6 +121,14 @@ void EUTelDafFitter::dafParams() {
 			    "Set this to true if you want DUTs to be included in the track fit.",
 			    _fitDuts,
 			    false);  
+
+  registerOptionalParameter("BatchedFit",
+			    "Fit the track candidates of an event together in batches of eight. "
+			    "The results agree with fitting them one by one within float rounding "
+			    "if the planes are perpendicular to the beam and no earlier candidate "
+			    "of the event failed the fit.",
+			    _batchedFit,
+			    false);
 }
 
 void EUTelDafFitter::dafInit() {
@@ -147,12 +155,19 @@ void EUTelDafFitter::dafEvent(LCEvent *event) {
     _fittrackVec->setFlag(flag.getFlag());
   }
 
+  if (_batchedFit) {
+    _system.fitPlanesInfoDafBatched();
+  }
   // Check found tracks
   for (size_t ii = 0; ii < _system.getNtracks(); ii++) {
     // run track fitte
     _nCandidates++;
     // prepare track for DAF fit
-    _system.fitPlanesInfoDaf(_system.tracks.at(ii));
+    if (_batchedFit) {
+      _system.restoreMeasZ(_system.tracks.at(ii));
+    } else {
+      _system.fitPlanesInfoDaf(_system.tracks.at(ii));
+    }
     // check resids, intime, angles
     if (not checkTrack(_system.tracks.at(ii))) {
       continue;
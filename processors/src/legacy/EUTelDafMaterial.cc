@@ -159,9 +159,20 @@ void EUTelDafMaterial::dafParams() {
                             _zRotIndex, std::vector<int>());
   registerOptionalParameter("ZPosIndex", "Plane Index for Z Pos estimator",
                             _zPosIndex, std::vector<int>());
+
+  registerOptionalParameter("NumberOfThreads",
+                            "Number of threads used to evaluate the tracks "
+                            "in the minimizer (1 == no threading)",
+                            _noOfThreads, 1);
 }
 
 void EUTelDafMaterial::dafInit() {
+  if (_noOfThreads < 1) {
+    streamlog_out(ERROR) << "The chosen NumberOfThreads: " << _noOfThreads
+                         << " is invalid, it has to be at least 1." << endl;
+    throw InvalidParameterException("NumberOfThreads");
+  }
+
   for (size_t ii = 0; ii < _dutPlanes.size(); ii++) {
     int iden = _dutPlanes.at(ii);
     int xMin = _resXMin.size() > ii ? _resXMin.at(ii) : -9999999;
@@ -386,7 +397,9 @@ void EUTelDafMaterial::dafEnd() {
   //_matest.simplexSearch(minimize, 3000, 30);
 
   FwBw *minimize = new FwBw(_matest);
+  minimize->nThreads = static_cast<size_t>(_noOfThreads);
   _matest.quasiNewtonHomeMade(minimize, 400);
+  delete minimize;
 
   // Use this for alignment only.
   // Minimizer* minimize = new Chi2(_matest); //Alignment
@@ -2,6 +2,7 @@
 #include <Eigen/Cholesky>
 #include <Eigen/LU>
 #include <TH2D.h>
+#include <algorithm>
 #include <gsl/gsl_multimin.h>
 
 //#include <thread>         // std::this_thread::sleep_for
@@ -136,30 +137,22 @@ void FakeChi2::calibrate(TrackerSystem<FITTERTYPE, 4> &system) {
   firstRun = false;
 }
 
-void FakeChi2::operator()(size_t offset, size_t stride) {
+void FakeChi2::operator()(size_t chunk, size_t begin, size_t end,
+                           TrackerSystem<FITTERTYPE, 4> &system) {
   // Get the global chi2 of the track sample
-  TrackerSystem<FITTERTYPE, 4> &system = systems.at(offset);
 
   // Track candidate is the same for all tracks
   system.index0tracker();
   TrackCandidate<FITTERTYPE, 4> candidate = system.tracks.at(0);
 
-  {
-#ifdef DOTHREAD
-    boost::mutex::scoped_lock lock(resultGurad);
-#endif
-    if (firstRun) {
-      calibrate(system);
-    }
-  }
   Eigen::Matrix<FITTERTYPE, 2, 1> resv;
 
   FITTERTYPE chi2 = 0;
-  for (int track = offset; track < mat.itMax; track += stride) {
+  for (size_t track = begin; track < end; track++) {
     // prepare system for new track: clear system from prev go around, read
     // track from memory, run track finder
     system.clear();
-    mat.readTrack(track, system);
+    mat.readTrack(static_cast<int>(track), system);
     system.fitInfoFWUnBiased(candidate);
     // Get explicit estimates
     for (size_t pl = 2; pl < system.planes.size(); pl++) {
@@ -184,38 +177,25 @@ void FakeChi2::operator()(size_t offset, size_t stride) {
     }
   }
 
-  {
-#ifdef DOTHREAD
-    boost::mutex::scoped_lock lock(resultGurad);
-#endif
-    result += chi2;
-  }
+  partialSums.at(chunk) = chi2;
 }
 
-void FakeAbsDev::operator()(size_t offset, size_t stride) {
+void FakeAbsDev::operator()(size_t chunk, size_t begin, size_t end,
+                             TrackerSystem<FITTERTYPE, 4> &system) {
   // Get the global chi2 of the track sample
-  TrackerSystem<FITTERTYPE, 4> &system = systems.at(offset);
 
   // Track candidate is the same for all tracks
   system.index0tracker();
   TrackCandidate<FITTERTYPE, 4> candidate = system.tracks.at(0);
 
-  {
-#ifdef DOTHREAD
-    boost::mutex::scoped_lock lock(resultGurad);
-#endif
-    if (firstRun) {
-      calibrate(system);
-    }
-  }
   Eigen::Matrix<FITTERTYPE, 2, 1> resv;
 
   FITTERTYPE chi2 = 0;
-  for (int track = offset; track < mat.itMax; track += stride) {
+  for (size_t track = begin; track < end; track++) {
     // prepare system for new track: clear system from prev go around, read
     // track from memory, run track finder
     system.clear();
-    mat.readTrack(track, system);
+    mat.readTrack(static_cast<int>(track), system);
     system.fitInfoFWUnBiased(candidate);
     // Get explicit estimates
     for (size_t pl = 2; pl < system.planes.size(); pl++) {
@@ -240,60 +220,51 @@ void FakeAbsDev::operator()(size_t offset, size_t stride) {
     }
   }
 
-  {
-#ifdef DOTHREAD
-    boost::mutex::scoped_lock lock(resultGurad);
-#endif
-    result += chi2;
-  }
+  partialSums.at(chunk) = chi2;
 }
 
-void Chi2::operator()(size_t offset, size_t stride) {
+void Chi2::operator()(size_t chunk, size_t begin, size_t end,
+                       TrackerSystem<FITTERTYPE, 4> &system) {
   // Get the global chi2 of the track sample
-  TrackerSystem<FITTERTYPE, 4> &system = systems.at(offset);
 
   // Track candidate is the same for all tracks
   system.index0tracker();
   TrackCandidate<FITTERTYPE, 4> candidate = system.tracks.at(0);
 
   double varchi2(0.0);
-  for (int track = offset; track < mat.itMax; track += stride) {
+  for (size_t track = begin; track < end; track++) {
     system.clear();
-    mat.readTrack(track, system);
+    mat.readTrack(static_cast<int>(track), system);
     system.fitInfoFWBiased(candidate);
     system.getChi2BiasedInfo(candidate);
     varchi2 += candidate.chi2;
   }
 
-  {
-#ifdef DOTHREAD
-    boost::mutex::scoped_lock lock(resultGurad);
-#endif
-    result += varchi2;
-  }
+  partialSums.at(chunk) = varchi2;
 }
 
-void SDR::operator()(size_t offset, size_t stride) {
+void SDR::operator()(size_t chunk, size_t begin, size_t end,
+                      TrackerSystem<FITTERTYPE, 4> &system) {
   // Get the mean^2 + (1 - variance) of the standardized residuals of chi2
   // increments and or pull distributions
-  TrackerSystem<FITTERTYPE, 4> &system = systems.at(offset);
-  std::vector<double> sqrPullXFW(system.planes.size() - 2, 0.0);
-  std::vector<double> sqrPullXBW(system.planes.size() - 2, 0.0);
-  std::vector<double> sqrPullYFW(system.planes.size() - 2, 0.0);
-  std::vector<double> sqrPullYBW(system.planes.size() - 2, 0.0);
-  std::vector<std::vector<double>> sqrParams(system.planes.size() - 3,
-                                             std::vector<double>(4, 0.0));
-  int nTracks = 0;
+  // Accumulate into the partial sums of this chunk
+  PullSums &sums = partialPulls.at(chunk);
+  std::vector<double> &sqrPullXFW = sums.sqrPullXFW;
+  std::vector<double> &sqrPullXBW = sums.sqrPullXBW;
+  std::vector<double> &sqrPullYFW = sums.sqrPullYFW;
+  std::vector<double> &sqrPullYBW = sums.sqrPullYBW;
+  std::vector<std::vector<double>> &sqrParams = sums.sqrParams;
+  int &nTracks = sums.nTracks;
 
   // Track candidate is the same for all tracks
   system.index0tracker();
   TrackCandidate<FITTERTYPE, 4> candidate = system.tracks.at(0);
 
-  for (int track = offset; track < mat.itMax; track += stride) {
+  for (size_t track = begin; track < end; track++) {
     // prepare system for new track: clear system from prev go around, read
     // track from memory, run track finder
     system.clear();
-    mat.readTrack(track, system);
+    mat.readTrack(static_cast<int>(track), system);
 
     // Only one track! Skip track finder
     // Run FW fitter, get p-values
@@ -372,59 +343,31 @@ void SDR::operator()(size_t offset, size_t stride) {
     }
     nTracks++;
   }
-
-  double varvar(0.0);
-  if (SDR2) {
-    for (size_t pl = 0; pl < system.planes.size() - 2; pl++) {
-      double resvar = 1.0f - (sqrPullXFW.at(pl) / (nTracks - 1));
-      varvar += resvar * resvar;
-      resvar = 1.0f - (sqrPullYFW.at(pl) / (nTracks - 1));
-      varvar += resvar * resvar;
-      resvar = 1.0f - (sqrPullXBW.at(pl) / (nTracks - 1));
-      varvar += resvar * resvar;
-      resvar = 1.0f - (sqrPullYBW.at(pl) / (nTracks - 1));
-      varvar += resvar * resvar;
-    }
-  }
-  if (SDR1) {
-    for (size_t pl = 1; pl < system.planes.size() - 2; pl++) {
-      for (int param = 0; param < 4; param++) {
-        double resvar = 1.0f - (sqrParams.at(pl - 1).at(param) / (nTracks - 1));
-        varvar += resvar * resvar;
-      }
-    }
-  }
-  {
-#ifdef DOTHREAD
-    boost::mutex::scoped_lock lock(resultGurad);
-#endif
-    result += varvar;
-  }
 }
 
-void FwBw::operator()(size_t offset, size_t stride) {
+void FwBw::operator()(size_t chunk, size_t begin, size_t end,
+                       TrackerSystem<FITTERTYPE, 4> &system) {
   // Get the negative log likelihood of the state difference of a forward and
   // backward running Kalman filter.
-  TrackerSystem<FITTERTYPE, 4> &system = systems.at(offset);
 
   // Track candidate is the same for all tracks
   system.index0tracker();
   TrackCandidate<FITTERTYPE, 4> candidate = system.tracks.at(0);
 
-  double logL(0.0);
-  std::vector<double> sqrPullXFW(system.planes.size() - 2, 0.0);
-  std::vector<double> sqrPullXBW(system.planes.size() - 2, 0.0);
-  std::vector<double> sqrPullYFW(system.planes.size() - 2, 0.0);
-  std::vector<double> sqrPullYBW(system.planes.size() - 2, 0.0);
-  std::vector<std::vector<double>> sqrParams(system.planes.size() - 3,
-                                             std::vector<double>(4, 0.0));
-  int nTracks = 0;
+  // Accumulate into the partial sums of this chunk
+  PullSums &sums = partialPulls.at(chunk);
+  std::vector<double> &sqrPullXFW = sums.sqrPullXFW;
+  std::vector<double> &sqrPullXBW = sums.sqrPullXBW;
+  std::vector<double> &sqrPullYFW = sums.sqrPullYFW;
+  std::vector<double> &sqrPullYBW = sums.sqrPullYBW;
+  double &logL = sums.logL;
+  int &nTracks = sums.nTracks;
 
-  for (int track = offset; track < mat.itMax; track += stride) {
+  for (size_t track = begin; track < end; track++) {
     // prepare system for new track: clear system from prev go around, read
     // track from memory, run track finder
     system.clear();
-    mat.readTrack(track, system);
+    mat.readTrack(static_cast<int>(track), system);
     nTracks++;
     // Translate candidate from DAF to KF
     system.fitInfoFWBiased(candidate);
@@ -482,33 +425,108 @@ void FwBw::operator()(size_t offset, size_t stride) {
       sqrPullYBW.at(pl) += pull2(1);
     }
   }
+}
+
+void PullSums::add(PullSums const &other) {
+  for (size_t pl = 0; pl < sqrPullXFW.size(); pl++) {
+    sqrPullXFW.at(pl) += other.sqrPullXFW.at(pl);
+    sqrPullXBW.at(pl) += other.sqrPullXBW.at(pl);
+    sqrPullYFW.at(pl) += other.sqrPullYFW.at(pl);
+    sqrPullYBW.at(pl) += other.sqrPullYBW.at(pl);
+  }
+  for (size_t pl = 0; pl < sqrParams.size(); pl++) {
+    for (size_t param = 0; param < 4; param++) {
+      sqrParams.at(pl).at(param) += other.sqrParams.at(pl).at(param);
+    }
+  }
+  logL += other.logL;
+  nTracks += other.nTracks;
+}
+
+void SDR::preparePartials(size_t noOfChunks) {
+  partialPulls.assign(noOfChunks, PullSums(mat.system.planes.size()));
+}
+
+void SDR::combinePartials() {
+  // The variances need the sums over all tracks, combine the chunks first
+  PullSums sums(mat.system.planes.size());
+  for (auto const &partial : partialPulls) {
+    sums.add(partial);
+  }
+  int nTracks = sums.nTracks;
+
+  double varvar(0.0);
+  if (SDR2) {
+    for (size_t pl = 0; pl < mat.system.planes.size() - 2; pl++) {
+      double resvar = 1.0f - (sums.sqrPullXFW.at(pl) / (nTracks - 1));
+      varvar += resvar * resvar;
+      resvar = 1.0f - (sums.sqrPullYFW.at(pl) / (nTracks - 1));
+      varvar += resvar * resvar;
+      resvar = 1.0f - (sums.sqrPullXBW.at(pl) / (nTracks - 1));
+      varvar += resvar * resvar;
+      resvar = 1.0f - (sums.sqrPullYBW.at(pl) / (nTracks - 1));
+      varvar += resvar * resvar;
+    }
+  }
+  if (SDR1) {
+    for (size_t pl = 1; pl < mat.system.planes.size() - 2; pl++) {
+      for (int param = 0; param < 4; param++) {
+        double resvar =
+            1.0f - (sums.sqrParams.at(pl - 1).at(param) / (nTracks - 1));
+        varvar += resvar * resvar;
+      }
+    }
+  }
+  result += varvar;
+}
+
+void FwBw::preparePartials(size_t noOfChunks) {
+  partialPulls.assign(noOfChunks, PullSums(mat.system.planes.size()));
+}
+
+void FwBw::combinePartials() {
+  // The variances need the sums over all tracks, combine the chunks first
+  PullSums sums(mat.system.planes.size());
+  for (auto const &partial : partialPulls) {
+    sums.add(partial);
+  }
+  int nTracks = sums.nTracks;
+
   FITTERTYPE return2 = 0.0;
-  for (size_t pl = 0; pl < system.planes.size() - 2; pl++) {
-    double resvar = 1.0 - sqrPullXFW.at(pl) / (nTracks - 1);
+  for (size_t pl = 0; pl < mat.system.planes.size() - 2; pl++) {
+    double resvar = 1.0 - sums.sqrPullXFW.at(pl) / (nTracks - 1);
     return2 += resvar * resvar;
-    resvar = 1.0 - sqrPullYFW.at(pl) / (nTracks - 1);
+    resvar = 1.0 - sums.sqrPullYFW.at(pl) / (nTracks - 1);
     return2 += resvar * resvar;
-    resvar = 1.0 - sqrPullXBW.at(pl) / (nTracks - 1);
+    resvar = 1.0 - sums.sqrPullXBW.at(pl) / (nTracks - 1);
     return2 += resvar * resvar;
-    resvar = 1.0 - sqrPullYBW.at(pl) / (nTracks - 1);
+    resvar = 1.0 - sums.sqrPullYBW.at(pl) / (nTracks - 1);
     return2 += resvar * resvar;
   }
-  {
-#ifdef DOTHREAD
-    boost::mutex::scoped_lock lock(resultGurad);
-#endif
-    result += -1.0 * logL;
-    retVal2 += return2;
+  result += -1.0 * sums.logL;
+  retVal2 += return2;
+}
+
+void FakeChi2::preparePartials(size_t noOfChunks) {
+  // The residual errors are needed by all chunks, calibrate before starting
+  if (firstRun) {
+    calibrate(systems.at(0));
   }
+  Minimizer::preparePartials(noOfChunks);
 }
 
 void Minimizer::init() {
-// Initialize nThread threads
-#ifndef DOTHREAD
-  cout << "Not using threads!" << endl;
-  nThreads = 1;
-#endif
+  // Start the thread pool, one tracker system per worker
   if (not inited) {
+    if (nThreads < 1 or chunkSize < 1) {
+      throw std::runtime_error(
+          "Minimizer needs at least one thread and one track per chunk.");
+    }
+    if (nThreads > 1) {
+      threadPool = std::make_unique<eutelescope::EUTelThreadPool>(nThreads);
+    } else {
+      cout << "Not using threads!" << endl;
+    }
     systems.assign(nThreads, mat.system);
   }
   inited = true;
@@ -529,19 +547,38 @@ void Minimizer::prepareThreads() {
   retVal2 = 0.0f;
 }
 
+void Minimizer::preparePartials(size_t noOfChunks) {
+  partialSums.assign(noOfChunks, 0.0);
+}
+
+void Minimizer::combinePartials() {
+  double sum(0.0);
+  for (double partial : partialSums) {
+    sum += partial;
+  }
+  result += sum;
+}
+
 FITTERTYPE Minimizer::operator()(void) {
-  // Start threads if DOTHREAD, run job in main thread if not.
+  // Evaluate the tracks chunk by chunk, on the thread pool if there is one
   prepareThreads();
-#ifdef DOTHREAD
-  boost::thread_group threads;
-  for (int ii = 0; ii < nThreads; ii++) {
-    threads.create_thread(
-        boost::bind(&Minimizer::operator(), this, ii, nThreads));
+  size_t nTracks = mat.itMax > 0 ? static_cast<size_t>(mat.itMax) : 0;
+  size_t noOfChunks = (nTracks + chunkSize - 1) / chunkSize;
+  preparePartials(noOfChunks);
+
+  auto evaluateChunk = [this, nTracks](size_t chunk, size_t worker) {
+    size_t begin = chunk * chunkSize;
+    (*this)(chunk, begin, std::min(begin + chunkSize, nTracks),
+            systems.at(worker));
+  };
+  if (threadPool) {
+    threadPool->run(noOfChunks, evaluateChunk);
+  } else {
+    for (size_t chunk = 0; chunk < noOfChunks; chunk++) {
+      evaluateChunk(chunk, 0);
+    }
   }
-  threads.join_all();
-#else
-  (*this)(0, 1);
-#endif
+  combinePartials();
   return (result);
 }
 
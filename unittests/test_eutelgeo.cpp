@@ -3,6 +3,9 @@
 #include <random>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <vector>
+#include <map>
 
 //Eigen
 #include <Eigen/Core>
@@ -13,6 +16,17 @@
 
 //EUTelescope
 #include "eutelgeotest.h"
+#include "EUTelExceptions.h"
+#include "EUTelSparseClusterFinder.h"
+
+//Alibava
+#include "AlibavaChipCorrection.h"
+
+//DAF
+#include "EUTelDafTrackerSystem.h"
+
+//ROOT
+#include "TGeoNode.h"
 
 #define PI 3.14159265
 
@@ -287,6 +301,73 @@ TEST_F(eutelgeotestTest, XAxisTest) {
 	}
 }
 
+/** The batch transformations must give the same points as the single point ones, which
+ *  in turn must agree with the TGeo matrix of the plane's node.
+ */ 
+TEST_F(eutelgeotestTest, BatchPointTrans) {
+
+	auto sensorIdVec = eugeo::gGeometry().sensorIDsVec();
+
+	std::uniform_real_distribution<double> distribution(-10.0,10.0);
+	
+	double const abs_err = 1e-13;
+	size_t const noOfPoints = 100;
+
+	std::vector<double> pointsInitial(3*noOfPoints);
+	std::vector<double> pointsBatch(3*noOfPoints);
+	double pointSingle [3] = {0, 0, 0};
+	double pointTGeo [3] = {0, 0, 0};
+
+	for(auto sensorID: sensorIdVec) {
+		for(auto& coord: pointsInitial) coord = distribution(generator);
+
+		eugeo::gGeometry()._geoManager->cd( eugeo::gGeometry().getPlanePath(sensorID).c_str() );
+		auto matrix = eugeo::gGeometry()._geoManager->GetCurrentNode()->GetMatrix();
+
+		eugeo::gGeometry().local2MasterBatch(sensorID, noOfPoints, pointsInitial.data(), pointsBatch.data());
+		for(size_t i = 0; i < noOfPoints; i++) {
+			eugeo::gGeometry().local2Master(sensorID, &pointsInitial[3*i], pointSingle);
+			matrix->LocalToMaster(&pointsInitial[3*i], pointTGeo);
+			for(size_t j = 0; j < 3; j++) {
+				ASSERT_EQ(pointSingle[j], pointsBatch[3*i+j]);
+				ASSERT_NEAR(pointTGeo[j], pointsBatch[3*i+j], abs_err);
+			}
+		}
+
+		eugeo::gGeometry().master2LocalBatch(sensorID, noOfPoints, pointsInitial.data(), pointsBatch.data());
+		for(size_t i = 0; i < noOfPoints; i++) {
+			eugeo::gGeometry().master2Local(sensorID, &pointsInitial[3*i], pointSingle);
+			matrix->MasterToLocal(&pointsInitial[3*i], pointTGeo);
+			for(size_t j = 0; j < 3; j++) {
+				ASSERT_EQ(pointSingle[j], pointsBatch[3*i+j]);
+				ASSERT_NEAR(pointTGeo[j], pointsBatch[3*i+j], abs_err);
+			}
+		}
+
+		//structure-of-arrays variant
+		std::vector<double> x(noOfPoints), y(noOfPoints), z(noOfPoints);
+		std::vector<double> xT(noOfPoints), yT(noOfPoints), zT(noOfPoints);
+		for(size_t i = 0; i < noOfPoints; i++) {
+			x[i] = pointsInitial[3*i];
+			y[i] = pointsInitial[3*i+1];
+			z[i] = pointsInitial[3*i+2];
+		}
+		eugeo::gGeometry().master2LocalBatch(sensorID, noOfPoints, x.data(), y.data(), z.data(), xT.data(), yT.data(), zT.data());
+		for(size_t i = 0; i < noOfPoints; i++) {
+			ASSERT_NEAR(xT[i], pointsBatch[3*i], abs_err);
+			ASSERT_NEAR(yT[i], pointsBatch[3*i+1], abs_err);
+			ASSERT_NEAR(zT[i], pointsBatch[3*i+2], abs_err);
+		}
+		eugeo::gGeometry().local2MasterBatch(sensorID, noOfPoints, x.data(), y.data(), z.data(), xT.data(), yT.data(), zT.data());
+		eugeo::gGeometry().local2MasterBatch(sensorID, noOfPoints, pointsInitial.data(), pointsBatch.data());
+		for(size_t i = 0; i < noOfPoints; i++) {
+			ASSERT_NEAR(xT[i], pointsBatch[3*i], abs_err);
+			ASSERT_NEAR(yT[i], pointsBatch[3*i+1], abs_err);
+			ASSERT_NEAR(zT[i], pointsBatch[3*i+2], abs_err);
+		}
+	}
+}
+
 TEST_F(eutelgeotestTest, radLengthTest1) {
 	Eigen::Vector3d begin = {0,0,-5};
 	Eigen::Vector3d end = {0,0,5};
@@ -301,5 +382,279 @@ TEST_F(eutelgeotestTest, radLengthTest1) {
 }
 
 
+TEST_F(eutelgeotestTest, PlaneRecordTest) {
+	for(auto sensorID: eugeo::gGeometry().sensorIDsVec()) {
+		auto const & record = eugeo::gGeometry().getPlaneRecord(sensorID);
+		ASSERT_EQ(reinterpret_cast<std::uintptr_t>(&record) % 64, 0u);
+		ASSERT_EQ(record.sensorID, sensorID);
+		ASSERT_TRUE(record.hasTransform);
+
+		//compare to the TGeo matrices
+		eugeo::gGeometry()._geoManager->cd( eugeo::gGeometry().getPlanePath(sensorID).c_str() );
+		auto matrix = eugeo::gGeometry()._geoManager->GetCurrentNode()->GetMatrix();
+		double local[3] = {0, 0, 1}, global[3];
+		matrix->LocalToMasterVect(local, global);
+		for(size_t j = 0; j < 3; j++) {
+			ASSERT_DOUBLE_EQ(record.normal(j), global[j]);
+			ASSERT_DOUBLE_EQ(record.transform[4*j+3], matrix->GetTranslation()[j]);
+		}
+		ASSERT_EQ(record.size(2), eugeo::gGeometry().getPlaneZSize(sensorID));
+		ASSERT_EQ(record.xPitch, eugeo::gGeometry().getPlaneXPitch(sensorID));
+		ASSERT_EQ(record.flip[3], eugeo::gGeometry().planeFlip4(sensorID));
+	}
+	ASSERT_THROW(eugeo::gGeometry().getPlaneRecord(-1), eutelescope::InvalidGeometryException);
+}
+
+TEST_F(eutelgeotestTest, SnapshotTest) {
+	auto sensorID = eugeo::gGeometry().sensorIDsVec().front();
+	auto before = eugeo::gGeometry().getSnapshot();
+	Eigen::Vector3d position = before->getPlaneRecord(sensorID).position;
+
+	//realigning publishes a new snapshot, the one held stays untouched
+	eugeo::gGeometry().alignGlobalPos(sensorID, position + Eigen::Vector3d(0.1, 0, 0));
+	auto after = eugeo::gGeometry().getSnapshot();
+	ASSERT_GT(after->getVersion(), before->getVersion());
+	ASSERT_EQ(before->getPlaneRecord(sensorID).position, position);
+	ASSERT_DOUBLE_EQ(after->getPlaneRecord(sensorID).position(0), position(0) + 0.1);
+	ASSERT_TRUE(after->hasMaterialBudget());
+
+	eugeo::gGeometry().alignGlobalPos(sensorID, position);
+	ASSERT_EQ(eugeo::gGeometry().getPlaneRecord(sensorID).position, position);
+
+	//the transformations are the same as the ones of the geometry
+	std::array<double,3> local {{1, 2, 0}}, global, globalSnapshot;
+	eugeo::gGeometry().local2Master(sensorID, local, global);
+	before->local2Master(sensorID, local, globalSnapshot);
+	ASSERT_EQ(global, globalSnapshot);
+	ASSERT_THROW(before->getPlaneRecord(-1), eutelescope::InvalidGeometryException);
+}
+
+TEST_F(eutelgeotestTest, MaterialBudgetTest) {
+	std::uniform_real_distribution<double> slopeDist(-0.3,0.3);
+	auto const & budget = eugeo::gGeometry().getMaterialBudget();
+	auto const & sensorIDs = eugeo::gGeometry().sensorIDsVec();
+
+	for(size_t iPlane = 0; iPlane < sensorIDs.size(); iPlane++) {
+		auto sensorID = sensorIDs[iPlane];
+		std::uniform_real_distribution<double> xDist(-0.4*eugeo::gGeometry().getPlaneXSize(sensorID), 0.4*eugeo::gGeometry().getPlaneXSize(sensorID));
+		std::uniform_real_distribution<double> yDist(-0.4*eugeo::gGeometry().getPlaneYSize(sensorID), 0.4*eugeo::gGeometry().getPlaneYSize(sensorID));
+		double const halfThickness = 0.51*eugeo::gGeometry().getPlaneZSize(sensorID);
+
+		for(size_t i = 0; i < 20; i++) {
+			Eigen::Vector3d localPos(xDist(generator), yDist(generator), 0);
+			Eigen::Vector3d localDir(slopeDist(generator), slopeDist(generator), 1);
+			localDir.normalize();
+
+			//reference: step through TGeo
+			std::array<double,3> entry, exit, dir, globalDir;
+			for(size_t j = 0; j < 3; j++) {
+				entry[j] = localPos(j) - halfThickness/localDir(2)*localDir(j);
+				exit[j] = localPos(j) + halfThickness/localDir(2)*localDir(j);
+				dir[j] = localDir(j);
+			}
+			std::array<double,3> entryGlobal, exitGlobal;
+			eugeo::gGeometry().local2Master(sensorID, entry, entryGlobal);
+			eugeo::gGeometry().local2Master(sensorID, exit, exitGlobal);
+			eugeo::gGeometry().local2MasterVec(sensorID, dir, globalDir);
+			double planeRad = eugeo::gGeometry().getRadiationLengthBetweenPoints(Eigen::Vector3d(entryGlobal.data()), Eigen::Vector3d(exitGlobal.data()));
+
+			ASSERT_NEAR(budget.planeRadLength(sensorID, localPos, localDir), planeRad, 1E-3*planeRad);
+			ASSERT_NEAR(budget.planeRadLengthGlobal(sensorID, Eigen::Vector3d(entryGlobal.data())/2.+Eigen::Vector3d(exitGlobal.data())/2., Eigen::Vector3d(globalDir.data())), planeRad, 1E-3*planeRad);
+
+			if( iPlane+1 == sensorIDs.size() ) {
+				ASSERT_EQ(budget.gapRadLength(sensorID, localPos, localDir), 0);
+				continue;
+			}
+			//reference: from leaving this plane to entering the next one, only downstream tracks
+			Eigen::Vector3d trackDir(globalDir.data());
+			if( trackDir(2) < 0 ) trackDir = -trackDir;
+			auto nextID = sensorIDs[iPlane+1];
+			Eigen::Vector3d nextNormal = eugeo::gGeometry().getPlaneNormalVector(nextID);
+			auto const & m = eugeo::gGeometry().getPlaneTransform(nextID);
+			Eigen::Vector3d nextCentre(m[3], m[7], m[11]);
+			Eigen::Vector3d start = Eigen::Vector3d(entryGlobal.data())/2.+Eigen::Vector3d(exitGlobal.data())/2. + halfThickness/std::abs(localDir(2))*trackDir;
+			double cosNext = nextNormal.dot(trackDir);
+			double length = nextNormal.dot(nextCentre-start)/cosNext - 0.51*eugeo::gGeometry().getPlaneZSize(nextID)/std::abs(cosNext);
+			double gapRad = eugeo::gGeometry().getRadiationLengthBetweenPoints(start, start + length*trackDir);
+
+			ASSERT_NEAR(budget.gapRadLengthGlobal(sensorID, Eigen::Vector3d(entryGlobal.data())/2.+Eigen::Vector3d(exitGlobal.data())/2., trackDir), gapRad, 1E-3*gapRad);
+			//a line has no direction, an upstream pointing one crosses the same gap
+			ASSERT_NEAR(budget.gapRadLengthGlobal(sensorID, Eigen::Vector3d(entryGlobal.data())/2.+Eigen::Vector3d(exitGlobal.data())/2., -trackDir), gapRad, 1E-3*gapRad);
+		}
+
+		//the centre at normal incidence is a grid node
+		Eigen::Vector3d normal = eugeo::gGeometry().getPlaneNormalVector(sensorID);
+		std::array<double,3> centre {{0,0,0}}, centreGlobal;
+		eugeo::gGeometry().local2Master(sensorID, centre, centreGlobal);
+		Eigen::Vector3d c(centreGlobal.data());
+		double normRad = eugeo::gGeometry().getRadiationLengthBetweenPoints(c-halfThickness*normal, c+halfThickness*normal);
+		ASSERT_NEAR(eugeo::gGeometry().planeRadLengthGlobalIncidence(sensorID, normal), normRad, 1E-9*normRad);
+	}
+}
+
+//The one pass correction of AlibavaFusedReconstruction on a chip with a purely linear
+//common mode, a cluster and two masked channels, all exactly representable as floats
+TEST(AlibavaChipCorrectionTest, RemovesLinearCommonMode) {
+	int const nchannels = 128;
+	int const iterations = 3;
+	float const noiseDeviation = 2.5;
+	double const offset = 12.5, tilt = -0.0625;
+
+	std::vector<float> raw(nchannels), pedestal(nchannels);
+	bool masked[nchannels];
+	for(int ichan = 0; ichan < nchannels; ichan++) {
+		pedestal[ichan] = 500.f + 0.25f*ichan;
+		raw[ichan] = static_cast<float>(pedestal[ichan] + offset + tilt*ichan);
+		masked[ichan] = (ichan == 5 || ichan == 77);
+	}
+	std::map<int, float> cluster = { {40, 300.f}, {41, 500.f}, {42, 200.f} };
+	for(auto const & entry : cluster) raw[entry.first] += entry.second;
+
+	//the cluster is rejected after the first iteration, the common mode comes from the
+	//123 remaining channels: 0..127 without 5, 77, 40, 41, 42, their sum is 8128 - 205
+	double const meanChannel = 7923./123.;
+
+	for(bool slope : {false, true}) {
+		std::vector<float> signal(nchannels);
+		alibava::ChipCommonMode cm = alibava::correctChipData(nchannels, raw.data(), pedestal.data(), masked, iterations, noiseDeviation, slope, signal.data());
+		ASSERT_NEAR(cm.a, offset, 1E-9);
+		ASSERT_NEAR(cm.b, tilt, 1E-9);
+		ASSERT_NEAR(cm.mean, offset + tilt*meanChannel, 1E-9);
+
+		for(int ichan = 0; ichan < nchannels; ichan++) {
+			//the constant common mode leaves the tilt around the mean channel
+			double expected = slope ? 0 : tilt*(ichan - meanChannel);
+			if(cluster.count(ichan)) expected += cluster[ichan];
+			if(masked[ichan]) {
+				ASSERT_EQ(signal[ichan], 0.f) << "channel " << ichan;
+			} else {
+				ASSERT_NEAR(signal[ichan], expected, 1E-4) << "channel " << ichan << (slope ? ", slope" : ", constant");
+			}
+		}
+	}
+}
+
+//The batched DAF fit against the fit of one candidate at a time by EigenFitter,
+//same candidates and results within float rounding for planes perpendicular to the beam
+TEST(DafBatchFitterTest, SameAsEigenFitter) {
+	typedef daffitter::TrackerSystem<float,4> System;
+	System single, batched;
+	for(System * system : {&single, &batched}) {
+		for(int i = 0; i < 6; i++) system->addPlane(i, 150.f*static_cast<float>(i) + (i > 2 ? 300.f : 0.f), 4.3f, 4.3f, 1E-7f, false);
+		system->setClusterRadius(300);
+		system->setDAFChi2Cut(1000);
+		system->setMaxCandidates(1000);
+		system->init(true);
+	}
+
+	std::mt19937 gen(17);
+	std::normal_distribution<float> gauss(0, 1);
+	std::uniform_real_distribution<float> pos(-10000, 10000);
+	size_t candidates = 0;
+	for(int event = 0; event < 100; event++) {
+		single.clear();
+		batched.clear();
+		//straight tracks with missing hits, and noise hits
+		for(int track = 0; track < 1 + event%20; track++) {
+			float x0 = pos(gen), y0 = pos(gen), dx = 1E-3f*gauss(gen), dy = 1E-3f*gauss(gen);
+			for(int i = 0; i < 6; i++) {
+				if(gen()%10 == 0) continue;
+				float z = single.planes.at(i).getZpos();
+				float x = x0 + dx*z + 4.3f*gauss(gen), y = y0 + dy*z + 4.3f*gauss(gen);
+				single.addMeasurement(i, x, y, z, true, i);
+				batched.addMeasurement(i, x, y, z, true, i);
+			}
+		}
+		for(int noise = 0; noise < 5; noise++) {
+			for(int i = 0; i < 6; i++) {
+				float x = pos(gen), y = pos(gen);
+				single.addMeasurement(i, x, y, 0, true, i);
+				batched.addMeasurement(i, x, y, 0, true, i);
+			}
+		}
+		single.clusterTracker();
+		batched.clusterTracker();
+		for(size_t i = 0; i < single.getNtracks(); i++) single.fitPlanesInfoDaf(single.tracks.at(i));
+		batched.fitPlanesInfoDafBatched();
+
+		ASSERT_EQ(single.getNtracks(), batched.getNtracks());
+		for(size_t i = 0; i < single.getNtracks(); i++) {
+			auto const & a = single.tracks.at(i);
+			auto const & b = batched.tracks.at(i);
+			//a candidate the DAF can not fit fails in both, it leaves the plane z positions
+			//undefined for the following candidates of the sequential fit only
+			if(!(a.ndof > -1.9f)) {
+				ASSERT_FALSE(b.ndof > -1.9f);
+				break;
+			}
+			ASSERT_EQ(a.indexes, b.indexes);
+			ASSERT_NEAR(a.ndof, b.ndof, 1E-3);
+			ASSERT_NEAR(a.chi2, b.chi2, 1E-3*(1 + a.chi2));
+			for(size_t p = 0; p < 6; p++) {
+				for(int k = 0; k < 4; k++) {
+					ASSERT_NEAR(a.estimates.at(p).params(k), b.estimates.at(p).params(k), 1E-4*(1 + std::abs(a.estimates.at(p).params(k))));
+				}
+			}
+			candidates++;
+		}
+	}
+	ASSERT_GT(candidates, 1000u);
+}
+
+//The column index cluster finder against the iterative neighbour search of EUTelSparseClustering,
+//both give the clusters as pixel numbers in input order of the pixels
+TEST(SparseClusterFinderTest, SameAsIterativeSearch) {
+	std::mt19937 gen(23);
+	eutelescope::EUTelSparseClusterFinder finder;
+
+	for(int event = 0; event < 400; event++) {
+		//sparse hits on a small sensor so clusters form, duplicates included
+		std::uniform_int_distribution<int> xDist(0, 20 + event%80), yDist(0, 20 + event%50);
+		std::vector<int> xCoord, yCoord;
+		size_t noOfPixels = gen()%300;
+		for(size_t i = 0; i < noOfPixels; i++) {
+			xCoord.push_back(xDist(gen));
+			yCoord.push_back(yDist(gen));
+		}
+
+		for(int cut : {-1, 0, 1, 2, 4, 5, 8}) {
+			//reference: the iterative search
+			std::vector<std::vector<size_t>> expected;
+			std::vector<size_t> hitPixelVec(noOfPixels);
+			for(size_t i = 0; i < noOfPixels; i++) hitPixelVec[i] = i;
+			std::vector<size_t> newlyAdded;
+			while(!hitPixelVec.empty()) {
+				std::vector<size_t> cluster;
+				newlyAdded.push_back(hitPixelVec.front());
+				cluster.push_back(hitPixelVec.front());
+				hitPixelVec.erase(hitPixelVec.begin());
+				while(!newlyAdded.empty()) {
+					bool newlyDone = true;
+					for(auto hitVec = hitPixelVec.begin(); hitVec != hitPixelVec.end(); ++hitVec) {
+						int dX = xCoord[newlyAdded.front()] - xCoord[*hitVec];
+						int dY = yCoord[newlyAdded.front()] - yCoord[*hitVec];
+						if(dX*dX + dY*dY <= cut) {
+							newlyAdded.push_back(*hitVec);
+							cluster.push_back(*hitVec);
+							hitPixelVec.erase(hitVec);
+							newlyDone = false;
+							break;
+						}
+					}
+					if(newlyDone) newlyAdded.erase(newlyAdded.begin());
+				}
+				expected.push_back(cluster);
+			}
+
+			finder.clear();
+			for(size_t i = 0; i < noOfPixels; i++) finder.addPixel(xCoord[i], yCoord[i]);
+			ASSERT_EQ(finder.findClusters(cut), expected.size()) << "cut " << cut;
+			for(size_t iCluster = 0; iCluster < expected.size(); iCluster++) {
+				std::vector<size_t> cluster(finder.clusterBegin(iCluster), finder.clusterEnd(iCluster));
+				ASSERT_EQ(cluster, expected[iCluster]) << "cut " << cut << ", cluster " << iCluster;
+			}
+		}
+	}
+}
 
 // }  // namespace - could surround eutelgeotestTest in a namespace